@@ -18,6 +18,7 @@
 **/
 
 #include "ActivityMonitor.h"
+#include "MemoryInfo.h"
 
 #include "utils.h"
 
@@ -30,12 +31,6 @@
 #define ACTIVITY_MONITOR_EVT_ON_MEMORY_THRESHOLD "onMemoryThreshold"
 #define ACTIVITY_MONITOR_EVT_ON_CPU_THRESHOLD "onCPUThreshold"
 
-#define VERSION_TXT_FILE "/version.txt"
-
-#define REGISTRY_FILENAME "/home/root/waylandregistryreceiver.conf"
-#define REGISTRY_FILENAME_RNE "/home/root/waylandregistryrne.conf"
-#define REGISTRY_FILENAME_DEV "/opt/waylandregistry.conf"
-
 namespace WPEFramework
 {
     namespace Plugin
@@ -85,29 +80,6 @@ namespace WPEFramework
             std::chrono::system_clock::time_point lastCpuCheck;
         };
 
-        class MemoryInfo
-        {
-        public:
-            static bool isDevOrVBNImage();
-            static void initRegistry();
-
-            static long long unsigned int getTotalCpuUsage();
-
-            static unsigned int parseLine(const char *line);
-
-            static unsigned int getFreeMemory();
-            static void readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut);
-
-            static void getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks);
-            static void getProcInfo(bool calcMem, bool calcCpu, std::vector<unsigned int> &pidsOut, std::vector <std::string> &cmdsOut, std::vector <unsigned int> &memUsageOut, std::vector <long long unsigned int> &cpuUsageOut);
-
-        private:
-            static std::map <std::string, std::string> registry;
-        };
-
-        std::map <std::string, std::string> MemoryInfo::registry;
-
-
         ActivityMonitor::ActivityMonitor()
         : AbstractPlugin()
         , m_monitorParams(NULL)
@@ -130,6 +102,8 @@ namespace WPEFramework
             if (m_monitor.joinable())
                 m_monitor.join();
 
+            MemoryInfo::stopProcConnector();
+
             delete m_monitorParams;
         }
 
@@ -251,6 +225,18 @@ namespace WPEFramework
             m_monitorParams->memoryIntervalSeconds = memoryIntervalSeconds;
             m_monitorParams->cpuIntervalSeconds = cpuIntervalSeconds;
 
+            bool procConnector = false;
+            if (parameters.HasLabel("procConnector"))
+                getBoolParameter("procConnector", procConnector);
+
+            if (procConnector)
+            {
+                if (!MemoryInfo::startProcConnector())
+                    LOGWARN("Proc connector is not available, falling back to scanning /proc");
+            }
+            else
+                MemoryInfo::stopProcConnector();
+
             JsonArray::Iterator index(configArray.Elements());
 
             while (index.Next() == true)
@@ -300,433 +286,14 @@ namespace WPEFramework
             else
                 LOGWARN("Monitoring is already disabled");
 
+            MemoryInfo::stopProcConnector();
+
             delete m_monitorParams;
             m_monitorParams = NULL;
 
             returnResponse(true);
         }
 
-        bool MemoryInfo::isDevOrVBNImage()
-        {
-            std::vector <char> buf;
-            buf.resize(1024);
-
-            FILE *f = fopen(VERSION_TXT_FILE, "r");
-            if (!f)
-            {
-                LOGERR("Failed to open %s: %s", VERSION_TXT_FILE, strerror(errno));
-                return false;
-            }
-
-            if (!fgets(buf.data(), buf.size(), f))
-            {
-                LOGERR("Failed to read from %s: %s", VERSION_TXT_FILE, strerror(errno));
-                fclose(f);
-                return false;
-            }
-
-            fclose(f);
-
-            std::string s(buf.data());
-
-            size_t pos = s.find("imagename:");
-            if (pos != std::string::npos)
-            {
-                s = s.substr(pos + strlen("imagename:"));
-                s = s.substr(0, s.find_first_of("\r\n"));
-            }
-            else
-                s = "";
-
-            return s.find("PROD") == std::string::npos && (s.find("DEV") != std::string::npos || s.find("VBN") != std::string::npos);
-        }
-
-        void MemoryInfo::initRegistry()
-        {
-            const char *registryFilename = REGISTRY_FILENAME;
-
-            if (0 == access(REGISTRY_FILENAME_DEV, R_OK) && isDevOrVBNImage())
-                registryFilename = REGISTRY_FILENAME_DEV;
-            else if (0 == access(REGISTRY_FILENAME_RNE, R_OK))
-                registryFilename = REGISTRY_FILENAME_RNE;
-
-            JsonObject regObj;
-
-            Core::File file;
-            file = registryFilename;
-
-            LOGINFO("Loading registry from %s", registryFilename);
-
-            file.Open();
-            regObj.IElement::FromFile(file);
-
-            file.Close();
-
-            if (regObj.HasLabel("waylandapps") && Core::JSON::Variant::type::ARRAY == regObj["waylandapps"].Content())
-            {
-                JsonArray apps = regObj["waylandapps"].Array();
-                JsonArray::Iterator index(apps.Elements());
-
-                int cnt = 0;
-                while (index.Next() == true)
-                {
-                    if (Core::JSON::Variant::type::OBJECT == index.Current().Content())
-                    {
-                        JsonObject appEntry = index.Current().Object();
-
-                        std::string binary = appEntry["binary"].String();
-
-                        if (binary.size() > 0 && binary[binary.size() - 1] == '%')
-                            binary = binary.substr(0, binary.size() - 1);
-
-                        size_t li = binary.find_last_of('/');
-                        if (std::string::npos != li)
-                            binary = binary.substr(li + 1, binary.size() - li - 1);
-
-                        registry[binary.c_str()] = appEntry["name"].String();
-                        cnt++;
-                    }
-                    else
-                        LOGWARN("Unexpected variant type");
-                }
-
-                LOGINFO("Loaded registry, %d entries", registry.size());
-            }
-            else
-                LOGERR("Didn't find registry data");
-        }
-
-        long long unsigned int MemoryInfo::getTotalCpuUsage()
-        {
-            FILE *f = fopen("/proc/stat", "r");
-
-            std::vector <char> buf;
-            buf.resize(1024);
-
-            if (NULL == fgets(buf.data(), buf.size(), f))
-            {
-                LOGERR("Failed to read stat, buffer is too small");
-                return 0;
-            }
-
-            fclose(f);
-
-            long long unsigned int user = 0, nice = 0, system = 0, idle = 0;
-
-            int vc = sscanf(buf.data(), "%*s %llu %llu %llu %llu", &user, &nice, &system, &idle);
-            if (4 != vc)
-                LOGERR("Failed to parse /proc/stat, number of items matched: %d", vc);
-
-            return user +  nice + system + idle;
-        }
-
-        unsigned int MemoryInfo::parseLine(const char *line)
-        {
-            std::string s(line);
-
-            unsigned int val;
-
-            size_t begin = s.find_first_of("0123456789");
-            size_t end = std::string::npos;
-            if (std::string::npos != begin)
-                end = s.find_first_not_of("0123456789", begin);
-
-            if (std::string::npos != begin && std::string::npos != end)
-            {
-                s = s.substr(begin, end);
-                val = strtoul(s.c_str(), NULL, 10);
-                return val;
-            }
-            else
-                LOGERR("Failed to parse value from %s", line);
-
-            return 0;
-        }
-
-        unsigned int MemoryInfo::getFreeMemory()
-        {
-            FILE *f = fopen("/proc/meminfo", "r");
-            if (NULL == f)
-            {
-                LOGERR("Failed to open /proc/meminfo:%s", strerror(errno));
-                return 0;
-            }
-
-            std::vector <char> buf;
-            buf.resize(1024);
-
-            unsigned int total = 0;
-
-            while (fgets(buf.data(), buf.size(), f))
-            {
-                if (strstr(buf.data(), "MemFree:") == buf.data() || strstr(buf.data(), "Buffers:") == buf.data() || strstr(buf.data(), "Cached:") == buf.data())
-                    total += parseLine(buf.data());
-            }
-
-            fclose(f);
-
-            return total / 1024; // From KB to MB
-        }
-
-        void MemoryInfo::readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut)
-        {
-            std::string smapsName = "/proc/";
-            smapsName += pid;
-            smapsName += "/smaps";
-
-            FILE *f = fopen(smapsName.c_str(), "r");
-            if (NULL == f)
-            {
-                pvtOut = sharedOut = 0;
-                return;
-            }
-
-            std::vector <char> buf;
-            buf.resize(1024);
-
-            size_t shared = 0;
-            size_t pvt = 0;
-            size_t pss = 0;
-            bool withPss = false;
-
-            while (fgets(buf.data(), buf.size(), f))
-            {
-                if (strstr(buf.data(), "Shared") == buf.data())
-                {
-                    shared += parseLine(buf.data());
-                }
-                else if (strstr(buf.data(), "Private") == buf.data())
-                {
-                    pvt += parseLine(buf.data());
-                }
-                else if (strstr(buf.data(), "Pss") == buf.data())
-                {
-                    withPss = true;
-                    pss += parseLine(buf.data());
-                }
-            }
-
-            fclose(f);
-
-            if (withPss)
-                shared = pss - pvt;
-
-            pvtOut = pvt;
-            sharedOut = shared;
-        }
-
-        void MemoryInfo::getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks)
-        {
-            std::string statName = "/proc/";
-            statName += dirName;
-            statName += "/stat";
-
-            std::vector <char> buf;
-            buf.resize(1024);
-
-            size_t r = 0;
-            FILE *f = fopen(statName.c_str(), "r");
-            if (f)
-            {
-                r = fread(buf.data(), 1, buf.size(), f);
-                if (buf.size() == r)
-                {
-                    LOGERR("Failed to read stat, buffer is too small");
-                }
-                fclose(f);
-            }
-
-            std::string stat(buf.data(), r);
-
-            std::size_t p1 = stat.find_first_of("(");
-            std::size_t p2 = stat.find_first_of(")");
-            if (std::string::npos == p1 || std::string::npos == p2)
-            {
-                //LOGINFO("Failed to parse command name from stat file '%s', '%s'", statName.c_str(), stat.c_str());
-                return;
-            }
-
-            cmdName = stat.substr(p1 + 1, p2 - p1 - 1);
-
-            size_t pos = p2, cnt = 0;
-
-            while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
-            {
-                cnt++;
-                if (2 == cnt)
-                    break;
-            }
-
-            ppid = 0;
-
-            int vc = sscanf(buf.data() + pos, "%d", &ppid);
-            if (1 != vc)
-                LOGERR("Failed to parse parent pid from '%s'", stat.c_str());
-
-            if (calcCpu)
-            {
-                while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
-                {
-                    cnt++;
-                    if (12 == cnt)
-                        break;
-                }
-
-                long long unsigned int utime = 0, stime = 0, cutime = 0, cstime = 0;
-
-                vc = sscanf(buf.data() + pos,
-                                "%llu %llu " //utime, stime
-                                "%llu %llu ", //cutime, cstime
-                                &utime, &stime, &cutime, &cstime);
-                if (4 != vc)
-                {
-                    LOGERR("Failed to parse parent cpu ticks from '%s', number of items matched: %d", stat.c_str(), vc);
-                }
-
-                cpuTicks = utime + stime + cutime + cstime;
-            }
-
-        }
-
-        void MemoryInfo::getProcInfo(bool calcMem, bool calcCpu, std::vector<unsigned int> &pidsOut, std::vector <std::string> &cmdsOut, std::vector <unsigned int> &memUsageOut, std::vector <long long unsigned int> &cpuUsageOut)
-        {
-            if (0 == registry.size())
-                MemoryInfo::initRegistry();
-
-            if (!calcMem && !calcCpu)
-            {
-                LOGERR("Nothing to do");
-                return;
-            }
-
-            std::vector<std::string> cmds;
-            std::vector<unsigned int> pids;
-            std::vector<unsigned int> ppids;
-            std::vector<long long unsigned int> cpuUsage;
-
-            DIR *d = opendir("/proc");
-
-            struct dirent *de;
-
-            while ((de = readdir(d)))
-            {
-                if (0 == de->d_name[0])
-                    continue;
-
-                char *end;
-                pid_t pid = strtoul(de->d_name, &end, 10);
-                if (0 != *end)
-                    continue;
-
-                std::string cmdName;
-                unsigned int ppid = 0;
-                long long unsigned int cpuTicks = 0;
-
-                MemoryInfo::getProcStat(de->d_name, cmdName, ppid, calcCpu, cpuTicks);
-
-                cmds.push_back(cmdName);
-                pids.push_back(pid);
-                ppids.push_back(ppid);
-                cpuUsage.push_back(cpuTicks);
-            }
-
-            std::map <unsigned int, unsigned int> pidMap;
-            for (unsigned int n = 0; n < pids.size(); n++)
-                pidMap[pids[n]] = n;
-
-            std::map <unsigned int, std::vector <unsigned int>> cmdMap;
-
-            for (unsigned int n = 0; n < cmds.size(); n++)
-            {
-                unsigned int lastIdx = cmds.size();
-
-                for (unsigned int pid = pids[n],idx,cnt = 0; pid != 0; pid = ppids[idx],cnt++)
-                {
-                    idx = pidMap[pid];
-                    std::string cmd = cmds[idx];
-
-                    if (registry.find(cmd) != registry.end())
-                    {
-                        lastIdx = idx;
-                    }
-
-                    if (cnt >= 100)
-                    {
-                        LOGERR("Too many iterations for process tree");
-                        lastIdx = cmds.size();
-                        break;
-                    }
-                }
-
-                if (lastIdx < cmds.size())
-                    cmdMap[lastIdx].push_back(n);
-            }
-
-            std::map <std::string, unsigned int> cmdCount;
-            if (calcMem)
-            {
-                for (unsigned int n = 0; n < cmds.size(); n++)
-                    cmdCount[cmds[n]]++;
-            }
-
-            for (std::map <unsigned int, std::vector <unsigned int>>::const_iterator it = cmdMap.cbegin(); it != cmdMap.cend(); it++)
-            {
-                unsigned int memUsage = 0;
-                if (calcMem)
-                {
-                    for (unsigned int n = 0; n < it->second.size(); n++)
-                    {
-                        char s[256];
-                        snprintf(s, sizeof(s), "%u", pids[it->second[n]]);
-
-                        unsigned int pvt, shared;
-
-                        readSmaps(s, pvt, shared);
-                        unsigned int cnt = cmdCount[cmds[it->second[n]]];
-                        if (0 == cnt)
-                        {
-                            LOGERR("Commnd count for %s was 0", cmds[n].c_str());
-                            cnt = 1;
-                        }
-                        unsigned int usage = (pvt + shared / cnt) / 1024;
-
-                        if (it->first != it->second[n])
-                        {
-                            pidsOut.push_back(pids[it->second[n]]);
-                            cmdsOut.push_back(cmds[it->second[n]]);
-                            memUsageOut.push_back(usage);
-                        }
-
-                        memUsage += usage;
-                    }
-                }
-
-                long long unsigned int cpu_usage = 0;
-                if (calcCpu)
-                {
-                    for (unsigned int n = 0; n < it->second.size(); n++)
-                    {
-                        if (it->first != it->second[n])
-                        {
-                            if (!calcMem) // If calcMem was disabled, pid and cmd should be added here.
-                            {
-                                pidsOut.push_back(pids[it->second[n]]);
-                                cmdsOut.push_back(cmds[it->second[n]]);
-                            }
-
-                            cpuUsageOut.push_back(cpuUsage[it->second[n]]);
-                        }
-                        cpu_usage += cpuUsage[it->second[n]];
-                    }
-                }
-
-                pidsOut.push_back(pids[it->first]);
-                cmdsOut.push_back(cmds[it->first]);
-                memUsageOut.push_back(memUsage);
-                cpuUsageOut.push_back(cpu_usage);
-            }
-        }
-
         void ActivityMonitor::threadRun(ActivityMonitor *am)
         {
             am->monitoring();
@@ -0,0 +1,903 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "MemoryInfo.h"
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+
+#include <algorithm>
+
+#include "Module.h"
+#include "utils.h"
+
+#define VERSION_TXT_FILE "/version.txt"
+
+#define REGISTRY_FILENAME "/home/root/waylandregistryreceiver.conf"
+#define REGISTRY_FILENAME_RNE "/home/root/waylandregistryrne.conf"
+#define REGISTRY_FILENAME_DEV "/opt/waylandregistry.conf"
+
+// Number of scans a new process is read again, to pick up the name after an exec
+#define PROC_SETTLE_SCANS 2
+
+// Settled entries are read again every this many scans, spread over the pids, to pick up a late exec
+#define PROC_REVALIDATE_SCANS 16
+
+// How long to wait for the kernel to acknowledge the proc connector subscription
+#define PROC_CONNECTOR_ACK_TIMEOUT_MS 1000
+
+// Older kernel headers declare the event types inside struct proc_event, newer ones (with
+// PROC_EVENT_ALL) at file scope
+#ifdef PROC_EVENT_ALL
+#define PROC_EVENT_TYPE(type) type
+#else
+#define PROC_EVENT_TYPE(type) proc_event::type
+#endif
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        std::map <std::string, std::string> MemoryInfo::registry;
+
+        std::mutex MemoryInfo::procMutex;
+        std::unordered_map <unsigned int, MemoryInfo::ProcEntry> MemoryInfo::procCache;
+        unsigned int MemoryInfo::procGeneration = 0;
+        bool MemoryInfo::procCacheEnabled = true;
+        bool MemoryInfo::smapsRollupEnabled = true;
+        int MemoryInfo::smapsRollupSupported = -1;
+
+        std::mutex MemoryInfo::procConnectorMutex;
+        std::thread MemoryInfo::procConnectorThread;
+        std::atomic<bool> MemoryInfo::procConnectorRunning(false);
+        int MemoryInfo::procConnectorSocket = -1;
+        bool MemoryInfo::procConnectorActive = false;
+        bool MemoryInfo::procRescan = true;
+
+        static bool sendProcConnectorOp(int fd, enum proc_cn_mcast_op op)
+        {
+            const size_t size = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+            struct nlmsghdr request[(size + sizeof(struct nlmsghdr) - 1) / sizeof(struct nlmsghdr)];
+
+            memset(request, 0, sizeof(request));
+
+            struct nlmsghdr *header = request;
+            header->nlmsg_len = size;
+            header->nlmsg_type = NLMSG_DONE;
+
+            struct cn_msg *message = reinterpret_cast<struct cn_msg *>(NLMSG_DATA(header));
+            message->id.idx = CN_IDX_PROC;
+            message->id.val = CN_VAL_PROC;
+            message->len = sizeof(op);
+            memcpy(message->data, &op, sizeof(op));
+
+            return static_cast<ssize_t>(size) == send(fd, request, size, 0);
+        }
+
+        // Calls the handler for every proc connector event in a datagram that came from the kernel
+        template <typename HANDLER>
+        static void forEachProcEvent(const char *buf, ssize_t len, const struct sockaddr_nl &from, HANDLER handler)
+        {
+            if (0 != from.nl_pid)
+                return;
+
+            for (const struct nlmsghdr *header = reinterpret_cast<const struct nlmsghdr *>(buf); NLMSG_OK(header, len); header = NLMSG_NEXT(header, len))
+            {
+                if (NLMSG_ERROR == header->nlmsg_type || NLMSG_NOOP == header->nlmsg_type)
+                    continue;
+
+                const struct cn_msg *message = reinterpret_cast<const struct cn_msg *>(NLMSG_DATA(header));
+                if (CN_IDX_PROC != message->id.idx || CN_VAL_PROC != message->id.val)
+                    continue;
+
+                handler(reinterpret_cast<const struct proc_event *>(message->data));
+            }
+        }
+
+        bool MemoryInfo::startProcConnector()
+        {
+            std::lock_guard<std::mutex> lock(procConnectorMutex);
+
+            if (procConnectorRunning)
+                return true;
+
+            // The previous thread stopped on an error
+            if (procConnectorThread.joinable())
+            {
+                procConnectorThread.join();
+
+                std::lock_guard<std::mutex> procLock(procMutex);
+
+                close(procConnectorSocket);
+                procConnectorSocket = -1;
+            }
+
+            int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+            if (fd < 0)
+            {
+                LOGWARN("Proc connector not available: %s", strerror(errno));
+                return false;
+            }
+
+            struct sockaddr_nl addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.nl_family = AF_NETLINK;
+            addr.nl_groups = CN_IDX_PROC;
+
+            if (0 != bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) || !sendProcConnectorOp(fd, PROC_CN_MCAST_LISTEN))
+            {
+                LOGWARN("Failed to subscribe to the proc connector: %s", strerror(errno));
+                close(fd);
+                return false;
+            }
+
+            // The kernel acknowledges the subscription, unless we are not allowed to listen (another pid or user namespace)
+            bool acknowledged = false;
+            int error = 0;
+            std::vector <char> buf(4096);
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(PROC_CONNECTOR_ACK_TIMEOUT_MS);
+
+            while (!acknowledged && std::chrono::steady_clock::now() < deadline)
+            {
+                struct pollfd pfd = { fd, POLLIN, 0 };
+                int remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+                if (poll(&pfd, 1, std::max(remaining, 1)) <= 0)
+                    continue;
+
+                struct sockaddr_nl from;
+                socklen_t fromLen = sizeof(from);
+                ssize_t len = recvfrom(fd, buf.data(), buf.size(), 0, reinterpret_cast<struct sockaddr *>(&from), &fromLen);
+
+                forEachProcEvent(buf.data(), len, from, [&](const struct proc_event *event) {
+                    if (PROC_EVENT_TYPE(PROC_EVENT_NONE) == event->what)
+                    {
+                        acknowledged = true;
+                        error = event->event_data.ack.err;
+                    }
+                });
+            }
+
+            if (!acknowledged || 0 != error)
+            {
+                LOGWARN("Proc connector subscription was not acknowledged (%d), scanning /proc instead", error);
+                close(fd);
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> procLock(procMutex);
+
+                // Events from before now are not needed, the table is built once from /proc first
+                procConnectorSocket = fd;
+                procConnectorActive = true;
+                procRescan = true;
+            }
+
+            procConnectorRunning = true;
+            procConnectorThread = std::thread(procConnectorRun);
+
+            LOGINFO("Following processes through the proc connector");
+
+            return true;
+        }
+
+        void MemoryInfo::stopProcConnector()
+        {
+            std::lock_guard<std::mutex> lock(procConnectorMutex);
+
+            if (!procConnectorThread.joinable())
+                return;
+
+            bool subscribed = procConnectorRunning;
+
+            procConnectorRunning = false;
+            procConnectorThread.join();
+
+            std::lock_guard<std::mutex> procLock(procMutex);
+
+            if (subscribed)
+                sendProcConnectorOp(procConnectorSocket, PROC_CN_MCAST_IGNORE);
+            close(procConnectorSocket);
+            procConnectorSocket = -1;
+            procConnectorActive = false;
+        }
+
+        void MemoryInfo::procConnectorRun()
+        {
+            std::vector <char> buf(16384);
+
+            while (procConnectorRunning)
+            {
+                struct pollfd pfd = { procConnectorSocket, POLLIN, 0 };
+
+                if (poll(&pfd, 1, 500) <= 0)
+                    continue;
+
+                struct sockaddr_nl from;
+                socklen_t fromLen = sizeof(from);
+                ssize_t len = recvfrom(procConnectorSocket, buf.data(), buf.size(), 0, reinterpret_cast<struct sockaddr *>(&from), &fromLen);
+
+                std::lock_guard<std::mutex> lock(procMutex);
+
+                if (len < 0)
+                {
+                    if (ENOBUFS == errno)
+                    {
+                        // Events were lost, the table can not be trusted anymore
+                        LOGWARN("Proc connector overrun, rescanning /proc");
+                        procCache.clear();
+                        procRescan = true;
+                    }
+                    else if (EINTR != errno && EAGAIN != errno)
+                    {
+                        LOGERR("Proc connector failed: %s, scanning /proc instead", strerror(errno));
+                        procConnectorActive = false;
+                        // Lets startProcConnector() subscribe again
+                        procConnectorRunning = false;
+                        break;
+                    }
+                    continue;
+                }
+
+                forEachProcEvent(buf.data(), len, from, [](const struct proc_event *event) {
+                    handleProcEvent(event);
+                });
+            }
+        }
+
+        // Called with procMutex held
+        void MemoryInfo::handleProcEvent(const void *data)
+        {
+            const struct proc_event *event = reinterpret_cast<const struct proc_event *>(data);
+            char s[32];
+
+            switch (event->what)
+            {
+                case PROC_EVENT_TYPE(PROC_EVENT_FORK):
+                    // Only processes are tracked, not threads
+                    if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid)
+                    {
+                        unsigned int parent = event->event_data.fork.parent_tgid;
+                        ProcEntry &entry = procCache[event->event_data.fork.child_tgid];
+                        std::unordered_map <unsigned int, ProcEntry>::const_iterator found = procCache.find(parent);
+
+                        entry.ppid = parent;
+                        entry.cpuTicks = 0;
+                        entry.scans = PROC_SETTLE_SCANS;
+                        entry.exited = false;
+
+                        // A child starts with the name of its parent, until it execs
+                        if (found != procCache.end())
+                            entry.cmdName = found->second.cmdName;
+                        else
+                        {
+                            snprintf(s, sizeof(s), "%u", event->event_data.fork.child_tgid);
+                            getProcStat(s, entry.cmdName, entry.ppid, false, entry.cpuTicks, &entry.startTime);
+                        }
+                    }
+                    break;
+
+                case PROC_EVENT_TYPE(PROC_EVENT_EXEC):
+                    {
+                        ProcEntry &entry = procCache[event->event_data.exec.process_tgid];
+
+                        snprintf(s, sizeof(s), "%u", event->event_data.exec.process_tgid);
+                        getProcStat(s, entry.cmdName, entry.ppid, false, entry.cpuTicks, &entry.startTime);
+                        entry.scans = PROC_SETTLE_SCANS;
+                        entry.exited = false;
+                    }
+                    break;
+
+                case PROC_EVENT_TYPE(PROC_EVENT_COMM):
+                    if (event->event_data.comm.process_pid == event->event_data.comm.process_tgid)
+                    {
+                        std::unordered_map <unsigned int, ProcEntry>::iterator found = procCache.find(event->event_data.comm.process_tgid);
+
+                        if (found != procCache.end())
+                            found->second.cmdName.assign(event->event_data.comm.comm, strnlen(event->event_data.comm.comm, sizeof(event->event_data.comm.comm)));
+                    }
+                    break;
+
+                case PROC_EVENT_TYPE(PROC_EVENT_EXIT):
+                    // Kept until the next report, so a short-lived process still shows up once
+                    if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                    {
+                        std::unordered_map <unsigned int, ProcEntry>::iterator found = procCache.find(event->event_data.exit.process_tgid);
+
+                        if (found != procCache.end())
+                            found->second.exited = true;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        void MemoryInfo::setProcCache(bool enabled)
+        {
+            std::lock_guard<std::mutex> lock(procMutex);
+
+            procCacheEnabled = enabled;
+            procCache.clear();
+        }
+
+        void MemoryInfo::setSmapsRollup(bool enabled)
+        {
+            smapsRollupEnabled = enabled;
+        }
+
+        bool MemoryInfo::isDevOrVBNImage()
+        {
+            std::vector <char> buf;
+            buf.resize(1024);
+
+            FILE *f = fopen(VERSION_TXT_FILE, "r");
+            if (!f)
+            {
+                LOGERR("Failed to open %s: %s", VERSION_TXT_FILE, strerror(errno));
+                return false;
+            }
+
+            if (!fgets(buf.data(), buf.size(), f))
+            {
+                LOGERR("Failed to read from %s: %s", VERSION_TXT_FILE, strerror(errno));
+                fclose(f);
+                return false;
+            }
+
+            fclose(f);
+
+            std::string s(buf.data());
+
+            size_t pos = s.find("imagename:");
+            if (pos != std::string::npos)
+            {
+                s = s.substr(pos + strlen("imagename:"));
+                s = s.substr(0, s.find_first_of("\r\n"));
+            }
+            else
+                s = "";
+
+            return s.find("PROD") == std::string::npos && (s.find("DEV") != std::string::npos || s.find("VBN") != std::string::npos);
+        }
+
+        void MemoryInfo::initRegistry()
+        {
+            const char *registryFilename = REGISTRY_FILENAME;
+
+            if (0 == access(REGISTRY_FILENAME_DEV, R_OK) && isDevOrVBNImage())
+                registryFilename = REGISTRY_FILENAME_DEV;
+            else if (0 == access(REGISTRY_FILENAME_RNE, R_OK))
+                registryFilename = REGISTRY_FILENAME_RNE;
+
+            JsonObject regObj;
+
+            Core::File file;
+            file = registryFilename;
+
+            LOGINFO("Loading registry from %s", registryFilename);
+
+            file.Open();
+            regObj.IElement::FromFile(file);
+
+            file.Close();
+
+            if (regObj.HasLabel("waylandapps") && Core::JSON::Variant::type::ARRAY == regObj["waylandapps"].Content())
+            {
+                JsonArray apps = regObj["waylandapps"].Array();
+                JsonArray::Iterator index(apps.Elements());
+
+                int cnt = 0;
+                while (index.Next() == true)
+                {
+                    if (Core::JSON::Variant::type::OBJECT == index.Current().Content())
+                    {
+                        JsonObject appEntry = index.Current().Object();
+
+                        std::string binary = appEntry["binary"].String();
+
+                        if (binary.size() > 0 && binary[binary.size() - 1] == '%')
+                            binary = binary.substr(0, binary.size() - 1);
+
+                        size_t li = binary.find_last_of('/');
+                        if (std::string::npos != li)
+                            binary = binary.substr(li + 1, binary.size() - li - 1);
+
+                        registry[binary.c_str()] = appEntry["name"].String();
+                        cnt++;
+                    }
+                    else
+                        LOGWARN("Unexpected variant type");
+                }
+
+                LOGINFO("Loaded registry, %d entries", registry.size());
+            }
+            else
+                LOGERR("Didn't find registry data");
+        }
+
+        void MemoryInfo::addRegistryEntry(const std::string &binary, const std::string &name)
+        {
+            registry[binary] = name;
+        }
+
+        long long unsigned int MemoryInfo::getTotalCpuUsage()
+        {
+            FILE *f = fopen("/proc/stat", "r");
+
+            std::vector <char> buf;
+            buf.resize(1024);
+
+            if (NULL == fgets(buf.data(), buf.size(), f))
+            {
+                LOGERR("Failed to read stat, buffer is too small");
+                return 0;
+            }
+
+            fclose(f);
+
+            long long unsigned int user = 0, nice = 0, system = 0, idle = 0;
+
+            int vc = sscanf(buf.data(), "%*s %llu %llu %llu %llu", &user, &nice, &system, &idle);
+            if (4 != vc)
+                LOGERR("Failed to parse /proc/stat, number of items matched: %d", vc);
+
+            return user +  nice + system + idle;
+        }
+
+        unsigned int MemoryInfo::parseLine(const char *line)
+        {
+            std::string s(line);
+
+            unsigned int val;
+
+            size_t begin = s.find_first_of("0123456789");
+            size_t end = std::string::npos;
+            if (std::string::npos != begin)
+                end = s.find_first_not_of("0123456789", begin);
+
+            if (std::string::npos != begin && std::string::npos != end)
+            {
+                s = s.substr(begin, end);
+                val = strtoul(s.c_str(), NULL, 10);
+                return val;
+            }
+            else
+                LOGERR("Failed to parse value from %s", line);
+
+            return 0;
+        }
+
+        unsigned int MemoryInfo::getFreeMemory()
+        {
+            FILE *f = fopen("/proc/meminfo", "r");
+            if (NULL == f)
+            {
+                LOGERR("Failed to open /proc/meminfo:%s", strerror(errno));
+                return 0;
+            }
+
+            std::vector <char> buf;
+            buf.resize(1024);
+
+            unsigned int total = 0;
+
+            while (fgets(buf.data(), buf.size(), f))
+            {
+                if (strstr(buf.data(), "MemFree:") == buf.data() || strstr(buf.data(), "Buffers:") == buf.data() || strstr(buf.data(), "Cached:") == buf.data())
+                    total += parseLine(buf.data());
+            }
+
+            fclose(f);
+
+            return total / 1024; // From KB to MB
+        }
+
+        void MemoryInfo::readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut)
+        {
+            std::string smapsName = "/proc/";
+            smapsName += pid;
+            smapsName += "/smaps";
+
+            if (smapsRollupSupported < 0)
+                smapsRollupSupported = (0 == access("/proc/self/smaps_rollup", R_OK)) ? 1 : 0;
+
+            FILE *f = NULL;
+
+            // The rollup has the same fields as smaps, already summed over all mappings
+            if (smapsRollupEnabled && 1 == smapsRollupSupported)
+                f = fopen((smapsName + "_rollup").c_str(), "r");
+
+            if (NULL == f)
+                f = fopen(smapsName.c_str(), "r");
+
+            if (NULL == f)
+            {
+                pvtOut = sharedOut = 0;
+                return;
+            }
+
+            std::vector <char> buf;
+            buf.resize(1024);
+
+            size_t shared = 0;
+            size_t pvt = 0;
+            size_t pss = 0;
+            bool withPss = false;
+
+            while (fgets(buf.data(), buf.size(), f))
+            {
+                if (strstr(buf.data(), "Shared") == buf.data())
+                {
+                    shared += parseLine(buf.data());
+                }
+                else if (strstr(buf.data(), "Private") == buf.data())
+                {
+                    pvt += parseLine(buf.data());
+                }
+                else if (strstr(buf.data(), "Pss:") == buf.data())
+                {
+                    withPss = true;
+                    pss += parseLine(buf.data());
+                }
+            }
+
+            fclose(f);
+
+            if (withPss)
+                shared = pss - pvt;
+
+            pvtOut = pvt;
+            sharedOut = shared;
+        }
+
+        void MemoryInfo::getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks, long long unsigned int *startTime)
+        {
+            std::string statName = "/proc/";
+            statName += dirName;
+            statName += "/stat";
+
+            std::vector <char> buf;
+            buf.resize(1024);
+
+            size_t r = 0;
+            FILE *f = fopen(statName.c_str(), "r");
+            if (f)
+            {
+                r = fread(buf.data(), 1, buf.size(), f);
+                if (buf.size() == r)
+                {
+                    LOGERR("Failed to read stat, buffer is too small");
+                }
+                fclose(f);
+            }
+
+            std::string stat(buf.data(), r);
+
+            std::size_t p1 = stat.find_first_of("(");
+            std::size_t p2 = stat.find_first_of(")");
+            if (std::string::npos == p1 || std::string::npos == p2)
+            {
+                //LOGINFO("Failed to parse command name from stat file '%s', '%s'", statName.c_str(), stat.c_str());
+                return;
+            }
+
+            cmdName = stat.substr(p1 + 1, p2 - p1 - 1);
+
+            size_t pos = p2, cnt = 0;
+
+            while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
+            {
+                cnt++;
+                if (2 == cnt)
+                    break;
+            }
+
+            ppid = 0;
+
+            int vc = sscanf(buf.data() + pos, "%d", &ppid);
+            if (1 != vc)
+                LOGERR("Failed to parse parent pid from '%s'", stat.c_str());
+
+            if (calcCpu)
+            {
+                while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
+                {
+                    cnt++;
+                    if (12 == cnt)
+                        break;
+                }
+
+                long long unsigned int utime = 0, stime = 0, cutime = 0, cstime = 0;
+
+                vc = sscanf(buf.data() + pos,
+                                "%llu %llu " //utime, stime
+                                "%llu %llu ", //cutime, cstime
+                                &utime, &stime, &cutime, &cstime);
+                if (4 != vc)
+                {
+                    LOGERR("Failed to parse parent cpu ticks from '%s', number of items matched: %d", stat.c_str(), vc);
+                }
+
+                cpuTicks = utime + stime + cutime + cstime;
+            }
+
+            if (startTime)
+            {
+                while ((pos = stat.find_first_of(" ", pos + 1)) != std::string::npos)
+                {
+                    cnt++;
+                    if (20 == cnt)
+                        break;
+                }
+
+                *startTime = 0;
+                if (std::string::npos == pos || 1 != sscanf(buf.data() + pos, "%llu", startTime))
+                    LOGERR("Failed to parse start time from '%s'", stat.c_str());
+            }
+        }
+
+        // Reads the process table from /proc, called with procMutex held
+        bool MemoryInfo::scanProc(bool calcCpu)
+        {
+            DIR *d = opendir("/proc");
+            if (NULL == d)
+            {
+                LOGERR("Failed to open /proc: %s", strerror(errno));
+                return false;
+            }
+
+            procGeneration++;
+
+            struct dirent *de;
+
+            while ((de = readdir(d)))
+            {
+                if (0 == de->d_name[0])
+                    continue;
+
+                char *end;
+                pid_t pid = strtoul(de->d_name, &end, 10);
+                if (0 != *end)
+                    continue;
+
+                ProcEntry &entry = procCache[pid];
+
+                // A new directory inode may be another process with the same pid
+                bool revalidate = entry.inode != de->d_ino || 0 == (pid + procGeneration) % PROC_REVALIDATE_SCANS;
+
+                // Without the cache everything is read, including cpu ticks, as before
+                if (!procCacheEnabled || entry.scans < PROC_SETTLE_SCANS || revalidate)
+                {
+                    long long unsigned int startTime = 0;
+                    MemoryInfo::getProcStat(de->d_name, entry.cmdName, entry.ppid, calcCpu && !procCacheEnabled, entry.cpuTicks, &startTime);
+
+                    // Another process, it settles again
+                    if (startTime != entry.startTime)
+                    {
+                        entry.startTime = startTime;
+                        entry.scans = 0;
+                    }
+                }
+
+                entry.inode = de->d_ino;
+                entry.scans++;
+                entry.generation = procGeneration;
+            }
+
+            closedir(d);
+
+            for (std::unordered_map <unsigned int, ProcEntry>::iterator it = procCache.begin(); it != procCache.end(); )
+            {
+                if (it->second.generation != procGeneration)
+                    it = procCache.erase(it);
+                else
+                    it++;
+            }
+
+            return true;
+        }
+
+        void MemoryInfo::getProcInfo(bool calcMem, bool calcCpu, std::vector<unsigned int> &pidsOut, std::vector <std::string> &cmdsOut, std::vector <unsigned int> &memUsageOut, std::vector <long long unsigned int> &cpuUsageOut)
+        {
+            std::lock_guard<std::mutex> lock(procMutex);
+
+            if (0 == registry.size())
+                MemoryInfo::initRegistry();
+
+            if (!calcMem && !calcCpu)
+            {
+                LOGERR("Nothing to do");
+                return;
+            }
+
+            std::vector<std::string> cmds;
+            std::vector<unsigned int> pids;
+            std::vector<unsigned int> ppids;
+            std::vector<long long unsigned int> cpuUsage;
+
+            // With the proc connector the table is already up to date
+            if (!procConnectorActive || procRescan || !procCacheEnabled)
+            {
+                if (!scanProc(calcCpu))
+                    return;
+
+                procRescan = false;
+            }
+
+            pids.reserve(procCache.size());
+            for (std::unordered_map <unsigned int, ProcEntry>::const_iterator it = procCache.begin(); it != procCache.end(); it++)
+                pids.push_back(it->first);
+
+            std::sort(pids.begin(), pids.end());
+
+            std::unordered_map <unsigned int, unsigned int> pidMap;
+            pidMap.reserve(pids.size());
+
+            for (unsigned int n = 0; n < pids.size(); n++)
+            {
+                ProcEntry &entry = procCache[pids[n]];
+
+                if (!entry.exited && 0 != entry.ppid && procCache.find(entry.ppid) == procCache.end())
+                {
+                    char s[32];
+                    snprintf(s, sizeof(s), "%u", pids[n]);
+
+                    // The parent is gone, this process has been reparented
+                    MemoryInfo::getProcStat(s, entry.cmdName, entry.ppid, false, entry.cpuTicks);
+                }
+
+                cmds.push_back(entry.cmdName);
+                ppids.push_back(entry.ppid);
+                cpuUsage.push_back(entry.cpuTicks);
+                pidMap[pids[n]] = n;
+            }
+
+            std::map <unsigned int, std::vector <unsigned int>> cmdMap;
+
+            for (unsigned int n = 0; n < cmds.size(); n++)
+            {
+                unsigned int lastIdx = cmds.size();
+
+                for (unsigned int pid = pids[n],idx,cnt = 0; pid != 0; pid = ppids[idx],cnt++)
+                {
+                    std::unordered_map <unsigned int, unsigned int>::const_iterator found = pidMap.find(pid);
+                    if (found == pidMap.end())
+                        break;
+
+                    idx = found->second;
+                    std::string cmd = cmds[idx];
+
+                    if (registry.find(cmd) != registry.end())
+                    {
+                        lastIdx = idx;
+                    }
+
+                    if (cnt >= 100)
+                    {
+                        LOGERR("Too many iterations for process tree");
+                        lastIdx = cmds.size();
+                        break;
+                    }
+                }
+
+                if (lastIdx < cmds.size())
+                    cmdMap[lastIdx].push_back(n);
+            }
+
+            if (calcCpu && procCacheEnabled)
+            {
+                // Cpu ticks are only needed for the processes of the applications
+                for (std::map <unsigned int, std::vector <unsigned int>>::const_iterator it = cmdMap.cbegin(); it != cmdMap.cend(); it++)
+                {
+                    for (unsigned int n = 0; n < it->second.size(); n++)
+                    {
+                        unsigned int idx = it->second[n];
+                        char s[32];
+                        snprintf(s, sizeof(s), "%u", pids[idx]);
+
+                        ProcEntry &entry = procCache[pids[idx]];
+                        MemoryInfo::getProcStat(s, entry.cmdName, entry.ppid, true, entry.cpuTicks);
+                        cpuUsage[idx] = entry.cpuTicks;
+                    }
+                }
+            }
+
+            std::map <std::string, unsigned int> cmdCount;
+            if (calcMem)
+            {
+                for (unsigned int n = 0; n < cmds.size(); n++)
+                    cmdCount[cmds[n]]++;
+            }
+
+            for (std::map <unsigned int, std::vector <unsigned int>>::const_iterator it = cmdMap.cbegin(); it != cmdMap.cend(); it++)
+            {
+                unsigned int memUsage = 0;
+                if (calcMem)
+                {
+                    for (unsigned int n = 0; n < it->second.size(); n++)
+                    {
+                        char s[256];
+                        snprintf(s, sizeof(s), "%u", pids[it->second[n]]);
+
+                        unsigned int pvt, shared;
+
+                        readSmaps(s, pvt, shared);
+                        unsigned int cnt = cmdCount[cmds[it->second[n]]];
+                        if (0 == cnt)
+                        {
+                            LOGERR("Commnd count for %s was 0", cmds[n].c_str());
+                            cnt = 1;
+                        }
+                        unsigned int usage = (pvt + shared / cnt) / 1024;
+
+                        if (it->first != it->second[n])
+                        {
+                            pidsOut.push_back(pids[it->second[n]]);
+                            cmdsOut.push_back(cmds[it->second[n]]);
+                            memUsageOut.push_back(usage);
+                        }
+
+                        memUsage += usage;
+                    }
+                }
+
+                long long unsigned int cpu_usage = 0;
+                if (calcCpu)
+                {
+                    for (unsigned int n = 0; n < it->second.size(); n++)
+                    {
+                        if (it->first != it->second[n])
+                        {
+                            if (!calcMem) // If calcMem was disabled, pid and cmd should be added here.
+                            {
+                                pidsOut.push_back(pids[it->second[n]]);
+                                cmdsOut.push_back(cmds[it->second[n]]);
+                            }
+
+                            cpuUsageOut.push_back(cpuUsage[it->second[n]]);
+                        }
+                        cpu_usage += cpuUsage[it->second[n]];
+                    }
+                }
+
+                pidsOut.push_back(pids[it->first]);
+                cmdsOut.push_back(cmds[it->first]);
+                memUsageOut.push_back(memUsage);
+                cpuUsageOut.push_back(cpu_usage);
+            }
+
+            // Exited processes have been in this report, that was all they were kept for
+            for (std::unordered_map <unsigned int, ProcEntry>::iterator it = procCache.begin(); it != procCache.end(); )
+            {
+                if (it->second.exited)
+                    it = procCache.erase(it);
+                else
+                    it++;
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,117 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Collects memory and cpu usage of the applications in the wayland registry from /proc.
+        //
+        // The process table (command name and parent of every pid) is cached between calls, only
+        // new processes are read from /proc/<pid>/stat. Entries are read again during their first
+        // scans (a fork is usually followed by an exec that changes the name), when their parent
+        // went away (the process is reparented), when the inode of their /proc directory changed
+        // (the pid may have been reused) and every few scans (a late exec). A different start time
+        // means a different process with the same pid, its entry starts over. Cpu ticks are only read for the processes that are
+        // part of an application. Memory is read from /proc/<pid>/smaps_rollup when the kernel has
+        // it, which is a single summary instead of one entry per mapping.
+        //
+        // Optionally the process table is kept up to date from the fork/exec/exit events of the
+        // kernel proc connector (netlink), so /proc is only scanned once instead of every sample.
+        // Processes that exit in between stay in the table until the next report has listed them.
+        class MemoryInfo
+        {
+        public:
+            static bool isDevOrVBNImage();
+            static void initRegistry();
+            static void addRegistryEntry(const std::string &binary, const std::string &name);
+
+            static long long unsigned int getTotalCpuUsage();
+
+            static unsigned int parseLine(const char *line);
+
+            static unsigned int getFreeMemory();
+            static void readSmaps(const char *pid, unsigned int &pvtOut, unsigned int &sharedOut);
+
+            static void getProcStat(const char *dirName, std::string &cmdName, unsigned int &ppid, bool calcCpu, long long unsigned int &cpuTicks, long long unsigned int *startTime = NULL);
+            static void getProcInfo(bool calcMem, bool calcCpu, std::vector<unsigned int> &pidsOut, std::vector <std::string> &cmdsOut, std::vector <unsigned int> &memUsageOut, std::vector <long long unsigned int> &cpuUsageOut);
+
+            // Both are enabled by default, disabling them gives the behaviour of a full scan for comparison.
+            static void setProcCache(bool enabled);
+            static void setSmapsRollup(bool enabled);
+
+            // Follows processes through the netlink proc connector instead of scanning /proc on every
+            // call. Returns false when the connector is not available, /proc is scanned as before then.
+            static bool startProcConnector();
+            static void stopProcConnector();
+
+        private:
+            struct ProcEntry
+            {
+                ProcEntry()
+                {
+                    ppid = scans = generation = 0;
+                    cpuTicks = startTime = 0;
+                    inode = 0;
+                    exited = false;
+                }
+
+                std::string cmdName;
+                unsigned int ppid;
+                long long unsigned int cpuTicks;
+                long long unsigned int startTime; // in clock ticks since boot, field 22 of /proc/<pid>/stat
+                unsigned long inode;              // of /proc/<pid>
+                bool exited;                      // reported by the proc connector, dropped after the next report
+                unsigned int scans;
+                unsigned int generation;
+            };
+
+            static bool scanProc(bool calcCpu);
+            static void procConnectorRun();
+            static void handleProcEvent(const void *event);
+
+            static std::map <std::string, std::string> registry;
+
+            static std::mutex procMutex;
+            static std::unordered_map <unsigned int, ProcEntry> procCache;
+            static unsigned int procGeneration;
+            static bool procCacheEnabled;
+            static bool smapsRollupEnabled;
+            static int smapsRollupSupported;
+
+            static std::mutex procConnectorMutex;
+            static std::thread procConnectorThread;
+            static std::atomic<bool> procConnectorRunning;
+            static int procConnectorSocket;
+            static bool procConnectorActive;
+            static bool procRescan;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,169 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+// Compares the cpu cost of one ActivityMonitor sample (MemoryInfo::getProcInfo) with the process
+// table cache and smaps_rollup against a full scan of /proc, as done before the cache existed.
+//
+// Usage: activityMonitorBenchmark [-n <samples>] [-a] [-c] [-p]
+//   -n  number of samples per mode (default 20)
+//   -a  measure every process instead of only the applications of the wayland registry
+//   -c  include cpu usage, as the monitoring thread does when cpuIntervalSeconds is set
+//   -p  also measure with the process table maintained by the netlink proc connector
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "MemoryInfo.h"
+
+using namespace WPEFramework::Plugin;
+
+static double cpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static double wallTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Adds the command name of every running process to the registry, so every process tree is measured.
+static void registerAll()
+{
+    DIR *d = opendir("/proc");
+    struct dirent *de;
+
+    while (d && (de = readdir(d)))
+    {
+        char *end;
+        strtoul(de->d_name, &end, 10);
+        if (0 == de->d_name[0] || 0 != *end)
+            continue;
+
+        std::string commName = std::string("/proc/") + de->d_name + "/comm";
+        char buf[64] = {0};
+        FILE *f = fopen(commName.c_str(), "r");
+
+        if (f)
+        {
+            if (fgets(buf, sizeof(buf), f))
+            {
+                buf[strcspn(buf, "\n")] = 0;
+                MemoryInfo::addRegistryEntry(buf, buf);
+            }
+            fclose(f);
+        }
+    }
+
+    if (d)
+        closedir(d);
+}
+
+static void run(const char *name, bool cached, unsigned int samples, bool calcCpu)
+{
+    MemoryInfo::setProcCache(cached);
+    MemoryInfo::setSmapsRollup(cached);
+
+    std::vector<unsigned int> pids;
+    std::vector <std::string> cmds;
+    std::vector <unsigned int> memUsage;
+    std::vector <long long unsigned int> cpuUsage;
+
+    // First sample fills the cache, as it would at the first interval.
+    MemoryInfo::getProcInfo(true, calcCpu, pids, cmds, memUsage, cpuUsage);
+
+    size_t processes = pids.size();
+    unsigned int total = 0;
+    for (unsigned int n = 0; n < memUsage.size(); n++)
+        total += memUsage[n];
+
+    double cpuStart = cpuTime();
+    double wallStart = wallTime();
+
+    for (unsigned int i = 0; i < samples; i++)
+    {
+        pids.clear();
+        cmds.clear();
+        memUsage.clear();
+        cpuUsage.clear();
+
+        MemoryInfo::getProcInfo(true, calcCpu, pids, cmds, memUsage, cpuUsage);
+    }
+
+    double cpu = (cpuTime() - cpuStart) / samples;
+    double wall = (wallTime() - wallStart) / samples;
+
+    printf("%-8s %4zu entries %8u MB  cpu %8.2f ms/sample  wall %8.2f ms/sample\n", name, processes, total, cpu, wall);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int samples = 20;
+    bool all = false;
+    bool calcCpu = false;
+    bool procConnector = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:acp")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': samples = atoi(optarg); break;
+            case 'a': all = true; break;
+            case 'c': calcCpu = true; break;
+            case 'p': procConnector = true; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n <samples>] [-a] [-c] [-p]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (0 == samples)
+        samples = 1;
+
+    if (all)
+        registerAll();
+
+    run("full", false, samples, calcCpu);
+    run("cached", true, samples, calcCpu);
+
+    if (procConnector)
+    {
+        if (MemoryInfo::startProcConnector())
+        {
+            run("events", true, samples, calcCpu);
+            MemoryInfo::stopProcConnector();
+        }
+        else
+            printf("events   proc connector not available\n");
+    }
+
+    return 0;
+}
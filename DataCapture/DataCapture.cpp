@@ -19,6 +19,7 @@
 
 
 #include <algorithm>
+#include <climits>
 #include <regex>
 #include "audiocapturemgr_iarm.h"
 #undef LOG // we don't need LOG from audiocapturemgr_iarm as we are defining our own LOG
@@ -32,9 +33,110 @@ const string WPEFramework::Plugin::DataCapture::METHOD_GET_AUDIO_CLIP = "getAudi
 const string WPEFramework::Plugin::DataCapture::EVT_ON_AUDIO_CLIP_READY = "onAudioClipReady";
 pthread_mutex_t WPEFramework::Plugin::DataCapture::_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Clips are only spooled for the retries of a running worker and the spool is emptied when it
+// starts and stops, so it stays on tmpfs rather than wearing the flash
+#ifndef DATA_CAPTURE_SPOOL_PATH
+#define DATA_CAPTURE_SPOOL_PATH "/tmp/datacapture/"
+#endif
+
+static const size_t UPLOAD_QUEUE_SIZE = 8;
+static const unsigned int UPLOAD_MAX_ATTEMPTS = 5;
+static const unsigned int UPLOAD_RETRY_DELAY_SEC = 2; // doubled after every failed attempt
+static const long UPLOAD_CONNECT_TIMEOUT_SEC = 10;
+static const size_t UPLOAD_SPOOL_MAX_SIZE = 16 * 1024 * 1024; // all spooled clips together
+
 using namespace std;
 using namespace audiocapturemgr;
 
+// Hands the clip to cURL straight from the socket. Only the first chunk is held here (it is read
+// before the upload starts to tell an empty socket apart); everything else is read into cURL's own
+// upload buffer, so memory stays bounded whatever the clip duration. Nothing is written to disk
+// while streaming; see spool_to() for what a failed upload can keep.
+struct clip_stream
+{
+    explicit clip_stream(socket_adaptor *adaptor)
+        : adaptor(adaptor), pending_size(0), pending_offset(0), total_size(0), failed(false)
+    {
+    }
+
+    int prime()
+    {
+        int ret = adaptor->read_data(pending, sizeof(pending));
+        pending_size = (ret > 0 ? ret : 0);
+        pending_offset = 0;
+        total_size = pending_size;
+        return ret;
+    }
+
+    static size_t read_callback(char *buffer, size_t size, size_t nitems, void *userdata)
+    {
+        clip_stream *stream = static_cast<clip_stream *>(userdata);
+        size_t room = size * nitems;
+
+        if(stream->pending_offset < stream->pending_size)
+        {
+            size_t count = std::min(room, stream->pending_size - stream->pending_offset);
+            memcpy(buffer, stream->pending + stream->pending_offset, count);
+            stream->pending_offset += count;
+            return count;
+        }
+
+        int ret = stream->adaptor->read_data(buffer, (unsigned int)std::min(room, (size_t)UINT_MAX));
+        if(0 > ret)
+        {
+            stream->failed = true;
+            return CURL_READFUNC_ABORT;
+        }
+        stream->total_size += ret;
+        return (size_t)ret; // 0 ends the chunked body
+    }
+
+    // True as long as cURL has taken nothing past the first chunk, i.e. the whole clip can still be
+    // read from here. This is the case for connect errors and for servers rejecting the request early.
+    bool replayable() const
+    {
+        return total_size == pending_size;
+    }
+
+    // Writes the whole clip (first chunk and the rest of the socket) to spool, only valid while
+    // replayable(). Returns false if the socket or the file fails or the clip exceeds limit bytes.
+    bool spool_to(FILE *spool, size_t limit)
+    {
+        if(pending_size > limit || fwrite(pending, 1, pending_size, spool) != pending_size)
+        {
+            return false;
+        }
+
+        char chunk[socket_adaptor::CHUNK_SIZE];
+        int ret;
+        while(0 < (ret = adaptor->read_data(chunk, sizeof(chunk))))
+        {
+            total_size += ret;
+            if(total_size > limit || fwrite(chunk, 1, ret, spool) != (size_t)ret)
+            {
+                return false;
+            }
+        }
+        if(0 > ret)
+        {
+            failed = true;
+        }
+        return !failed;
+    }
+
+    socket_adaptor *adaptor;
+    char pending[socket_adaptor::CHUNK_SIZE];
+    size_t pending_size;
+    size_t pending_offset;
+    size_t total_size;
+    bool failed;
+};
+
+static size_t spool_read_callback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    return fread(buffer, size, nitems, static_cast<FILE *>(userdata));
+}
+
 namespace WPEFramework {
 
     namespace Plugin {
@@ -63,6 +165,50 @@ namespace WPEFramework {
             while (dir.Next()) Core::File(AUDIOCAPTUREMGR_FILE_PATH + dir.Name()).Destroy();
         }
 
+        static void cleanup_spool()
+        {
+            string path(DATA_CAPTURE_SPOOL_PATH "*");
+            LOGINFO("by path %s", C_STR(path));
+
+            Core::Directory dir(C_STR(path));
+            while (dir.Next()) Core::File(DATA_CAPTURE_SPOOL_PATH + dir.Name()).Destroy();
+        }
+
+        // retryable is set for failures a later attempt may get past: network errors and 5xx/408/429 responses
+        static bool perform_upload(CURL *curl, std::string &error_str, bool &retryable)
+        {
+            bool call_succeeded = true;
+            retryable = false;
+
+            CURLcode res = curl_easy_perform(curl);
+
+            //output success / failure log
+            if(CURLE_OK == res)
+            {
+                long response_code;
+
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+                if(600 > response_code && response_code >= 400)
+                {
+                    LOGERR("uploading failed with response code %ld\n", response_code);
+                    error_str = std::string("response code:") + std::to_string(response_code);
+                    call_succeeded = false;
+                    retryable = (response_code >= 500 || response_code == 408 || response_code == 429);
+                }
+                else
+                    LOGWARN("upload done");
+            }
+            else
+            {
+                LOGERR("upload failed with error %d:'%s'", res, curl_easy_strerror(res));
+                error_str = std::to_string(res) + std::string(":'") + std::string(curl_easy_strerror(res)) + std::string("'");
+                call_succeeded = false;
+                retryable = (CURLE_ABORTED_BY_CALLBACK != res && CURLE_URL_MALFORMAT != res && CURLE_UNSUPPORTED_PROTOCOL != res);
+            }
+            return call_succeeded;
+        }
+
         SERVICE_REGISTRATION(DataCapture, 1, 0);
 
         DataCapture* DataCapture::_instance = nullptr;
@@ -72,7 +218,11 @@ namespace WPEFramework {
             , _session_id(-1)
             , _max_supported_duration(0)
             , _is_precapture(false)
+            , _stream_upload(true)
             , _duration(0)
+            , _curl(nullptr)
+            , _upload_stop(false)
+            , _spool_size(0)
         {
             LOGINFO("ctor");
 
@@ -95,6 +245,7 @@ namespace WPEFramework {
         const string DataCapture::Initialize(PluginHost::IShell* /* service */)
         {
             LOGINFO();
+            startUploadWorker();
             InitializeIARM();
             return "";
         }
@@ -103,6 +254,7 @@ namespace WPEFramework {
         {
             LOGINFO();
             DeinitializeIARM();
+            stopUploadWorker();
         }
 
         string DataCapture::Information() const
@@ -308,8 +460,19 @@ namespace WPEFramework {
             const string& captureMode = clipRequest["captureMode"].String();
             _is_precapture = (captureMode == "preCapture");
 
-            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, session id = %d",
-                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), _session_id);
+            // Optional: "streaming": false falls back to reading the whole clip before posting it,
+            // for servers that do not accept a chunked request body.
+            _stream_upload = true;
+            if (clipRequest.HasLabel("streaming"))
+            {
+                if (Core::JSON::Variant::type::BOOLEAN == clipRequest["streaming"].Content())
+                    _stream_upload = clipRequest["streaming"].Boolean();
+                else
+                    _stream_upload = !(clipRequest["streaming"].String() == "false" || clipRequest["streaming"].String() == "0");
+            }
+
+            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, streaming = %d, session id = %d",
+                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), _stream_upload, _session_id);
 
             if(0 > _session_id)
             {
@@ -407,129 +570,430 @@ namespace WPEFramework {
                 string fileName;
                 pos = dataLocator.rfind(delimiter);
                 fileName = dataLocator.substr(pos + delimiter.length(), dataLocator.length());
+
+                // Reading the socket and uploading can take seconds, so it is left to the upload
+                // worker and the IARM callback returns right away.
+                upload_job job;
+                job.data_locator = dataLocator;
+                job.file_name = fileName;
+                job.url = _destination_url;
+                job.stream = _stream_upload;
+                job.attempts = 0;
+                job.spool_size = 0;
+                job.next_attempt = std::chrono::steady_clock::now();
+
+                bool queued = false;
+                {
+                    std::lock_guard<std::mutex> lock(_upload_mutex);
+                    if (_upload_queue.size() < UPLOAD_QUEUE_SIZE)
+                    {
+                        _upload_queue.push_back(job);
+                        queued = true;
+                    }
+                }
+
+                if (queued)
+                {
+                    _upload_signal.notify_one();
+                }
+                else
+                {
+                    LOGERR("Upload queue is full, dropping %s", C_STR(dataLocator));
+                    notifyClipReady(fileName, false, "Upload queue is full");
+                }
+            }
+        }
+
+        void DataCapture::notifyClipReady(const string &fileName, bool status, const string &message)
+        {
+            JsonObject params;
+            params["fileName"] = fileName;
+            params["status"] = status;
+            params["message"] = message;
+
+            string message_json;
+            params.ToString(message_json);
+            LOGINFO("Sending notification %s: %s", C_STR(EVT_ON_AUDIO_CLIP_READY), C_STR(message_json));
+            sendNotify(C_STR(EVT_ON_AUDIO_CLIP_READY), params);
+        }
+
+        void DataCapture::startUploadWorker()
+        {
+            // Never paired with curl_global_cleanup(): other plugins in this process may be using cURL
+            static std::once_flag curl_once;
+            std::call_once(curl_once, [] { curl_global_init(CURL_GLOBAL_ALL); });
+
+            _curl = curl_easy_init();
+            if (!_curl)
+            {
+                LOGERR("could not init curl");
+            }
+
+            Core::Directory(DATA_CAPTURE_SPOOL_PATH).CreatePath();
+            cleanup_spool();
+            _spool_size = 0;
+
+            _upload_stop = false;
+            _upload_thread = std::thread(&DataCapture::uploadWorker, this);
+        }
+
+        void DataCapture::stopUploadWorker()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_upload_mutex);
+                _upload_stop = true;
+            }
+            _upload_signal.notify_all();
+
+            if (_upload_thread.joinable())
+            {
+                _upload_thread.join();
+            }
+
+            if (!_upload_queue.empty())
+            {
+                LOGWARN("Dropping %u pending uploads", (unsigned int)_upload_queue.size());
+                _upload_queue.clear();
+            }
+            cleanup_spool();
+            _spool_size = 0;
+
+            if (_curl)
+            {
+                curl_easy_cleanup(_curl);
+                _curl = nullptr;
+            }
+        }
+
+        void DataCapture::uploadWorker()
+        {
+            std::unique_lock<std::mutex> lock(_upload_mutex);
+
+            while (!_upload_stop)
+            {
+                if (_upload_queue.empty())
+                {
+                    _upload_signal.wait(lock);
+                    continue;
+                }
+
+                // New clips are due immediately, retries only once their back-off has expired
+                auto next = std::min_element(_upload_queue.begin(), _upload_queue.end(),
+                    [](const upload_job &a, const upload_job &b) { return a.next_attempt < b.next_attempt; });
+
+                if (next->next_attempt > std::chrono::steady_clock::now())
+                {
+                    _upload_signal.wait_until(lock, next->next_attempt);
+                    continue;
+                }
+
+                upload_job job = *next;
+                _upload_queue.erase(next);
+
+                lock.unlock();
+                bool retry = processUploadJob(job);
+                lock.lock();
+
+                if (retry && !_upload_stop)
+                {
+                    // Retries keep their place even if new clips have filled the queue meanwhile
+                    _upload_queue.push_back(job);
+                }
+            }
+        }
+
+        bool DataCapture::processUploadJob(upload_job &job)
+        {
+            bool received = false;
+            bool uploaded = false;
+            bool retryable = false;
+            std::string error_str;
+
+            if (job.spool_path.empty())
+            {
                 int attemptsLeft = 2;
-                vector<unsigned char> data;
                 int time_wait_sec = 1;
+                string spool_path = DATA_CAPTURE_SPOOL_PATH + job.file_name;
 
-                JsonObject params;
-                params["fileName"] = fileName;
+                if (job.stream)
+                {
+                    // Chunks go from the socket straight into cURL, so memory use does not depend on
+                    // the clip duration. The first chunk is read up front so an empty socket is retried
+                    // the same way as in the buffered path below.
+                    clip_stream stream(_sock_adaptor);
+
+                    while (attemptsLeft && !_upload_stop) {
+                        if(0 == _sock_adaptor->connect_socket(job.data_locator) && stream.prime() > 0)
+                        {
+                            LOGINFO("Streaming a clip, first chunk %u bytes", (unsigned int)stream.pending_size);
+                            received = true;
+                            break;
+                        }
+                        _sock_adaptor->disconnect_socket();
+                        LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
+                        usleep(1000 * 1000 * time_wait_sec);
+                        --attemptsLeft;
+                    }
 
-                while (attemptsLeft) {
-                    if(0 == _sock_adaptor->connect_socket(payload->dataLocator))
+                    if (received)
                     {
-                        _sock_adaptor->get_data(data); // closes the socket
-                        if (data.size() > 0) {
-                            LOGINFO("Got a clip: %u bytes", data.size());
-                            break;
-                        } else {
-                            LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
-                            usleep(1000 * 1000 * time_wait_sec);
-                            --attemptsLeft;
-                            continue;
+                        uploaded = streamDataToUrl(stream, C_STR(job.url), error_str, retryable);
+
+                        if (!uploaded && retryable)
+                        {
+                            // What cURL has sent is gone from the socket, so only a clip that did not get
+                            // past its first chunk can be spooled for a retry.
+                            FILE *spool = stream.replayable() ? fopen(C_STR(spool_path), "wb") : nullptr;
+                            if (spool && stream.spool_to(spool, UPLOAD_SPOOL_MAX_SIZE - _spool_size))
+                            {
+                                job.spool_path = spool_path;
+                                job.spool_size = stream.total_size;
+                                _spool_size += job.spool_size;
+                            }
+                            else
+                            {
+                                LOGWARN("Unable to spool %s, the clip will not be retried", C_STR(job.file_name));
+                                retryable = false;
+                            }
+                            if (spool)
+                            {
+                                fclose(spool);
+                            }
+                            if (job.spool_path.empty())
+                            {
+                                Core::File(spool_path).Destroy();
+                            }
                         }
+                        _sock_adaptor->disconnect_socket();
                     }
                 }
-
-                if(data.size() > 0)
+                else
                 {
-                    std::string error_str;
-                    if (uploadDataToUrl(data, _destination_url.c_str(), error_str))
-                    {
-                        params["status"] = true;
-                        params["message"] = "Success";
-
-                    } else {
-                        LOGERR("Upload failed: %s (cURL error)", C_STR(error_str));
-                        params["status"] = false;
-                        params["message"] = std::string("Upload Failed: ") + error_str;
+                    vector<unsigned char> data;
+
+                    while (attemptsLeft && !_upload_stop) {
+                        if(0 == _sock_adaptor->connect_socket(job.data_locator))
+                        {
+                            _sock_adaptor->get_data(data); // closes the socket
+                            if (data.size() > 0) {
+                                LOGINFO("Got a clip: %u bytes", data.size());
+                                break;
+                            }
+                        }
+                        LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
+                        usleep(1000 * 1000 * time_wait_sec);
+                        --attemptsLeft;
                     }
 
-                    // Optionally, we can save a file
-//                    FILE * pFile;
-//                    const char* path = strcat(payload->dataLocator, ".received.pcm");
-//                    pFile = fopen (path, "wb");
-//                    fwrite (&data[0] , sizeof(unsigned char), data.size(), pFile);
-//                    fclose (pFile);
-                    // now, upload it, then remove:
-//                    if (remove(path) != 0)
-//                    {
-//                        LOGERR("Unable to delete %s", path);
-//                    }
-                } else {
-                    LOGERR("Unable to read data from %s (connection error)", payload->dataLocator);
-                    params["status"] = false;
-                    params["message"] = std::string("Unable to read data from  ") + string(payload->dataLocator);
+                    if(data.size() > 0)
+                    {
+                        received = true;
+                        uploaded = uploadDataToUrl(data, C_STR(job.url), error_str, retryable);
+
+                        if (!uploaded && retryable)
+                        {
+                            FILE *spool = (data.size() <= UPLOAD_SPOOL_MAX_SIZE - _spool_size) ? fopen(C_STR(spool_path), "wb") : nullptr;
+                            if (spool && fwrite(&data[0], 1, data.size(), spool) == data.size())
+                            {
+                                job.spool_path = spool_path;
+                                job.spool_size = data.size();
+                                _spool_size += job.spool_size;
+                            }
+                            else
+                            {
+                                LOGWARN("Unable to spool %s, the clip will not be retried", C_STR(job.file_name));
+                                retryable = false;
+                            }
+                            if (spool)
+                            {
+                                fclose(spool);
+                            }
+                            if (job.spool_path.empty())
+                            {
+                                Core::File(spool_path).Destroy();
+                            }
+                        }
+                    }
                 }
+            }
+            else
+            {
+                received = true;
+                uploaded = uploadFileToUrl(job.spool_path, C_STR(job.url), error_str, retryable);
+            }
+
+            if (!received)
+            {
+                LOGERR("Unable to read data from %s (connection error)", C_STR(job.data_locator));
+                notifyClipReady(job.file_name, false, std::string("Unable to read data from  ") + job.data_locator);
+                return false;
+            }
+
+            if (uploaded)
+            {
+                notifyClipReady(job.file_name, true, "Success");
+            }
+            else if (retryable && ++job.attempts < UPLOAD_MAX_ATTEMPTS)
+            {
+                unsigned int delay = UPLOAD_RETRY_DELAY_SEC << (job.attempts - 1);
+                LOGWARN("Upload of %s failed: %s, retry %u in %u sec", C_STR(job.file_name), C_STR(error_str), job.attempts, delay);
+                job.next_attempt = std::chrono::steady_clock::now() + std::chrono::seconds(delay);
+                return true;
+            }
+            else
+            {
+                LOGERR("Upload failed: %s (cURL error)", C_STR(error_str));
+                notifyClipReady(job.file_name, false, std::string("Upload Failed: ") + error_str);
+            }
 
-                string message;
-                params.ToString(message);
-                LOGINFO("Sending notification %s: %s", C_STR(EVT_ON_AUDIO_CLIP_READY), C_STR(message));
-                sendNotify(C_STR(EVT_ON_AUDIO_CLIP_READY), params);
+            if (!job.spool_path.empty())
+            {
+                Core::File(job.spool_path).Destroy();
+                _spool_size -= job.spool_size;
             }
+            return false;
         }
 
-        bool DataCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        int DataCapture::upload_progress(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
         {
-            CURL *curl;
-            CURLcode res;
-            bool call_succeeded = true;
+            // A non-zero return aborts the transfer, so Deinitialize does not wait for a slow server
+            return static_cast<DataCapture *>(clientp)->_upload_stop ? 1 : 0;
+        }
 
+        bool DataCapture::prepareUpload(const char *url, struct curl_slist *headers)
+        {
             if(!url || !strlen(url))
             {
                 LOGERR("no url given");
                 return false;
             }
 
-            LOGWARN("uploading pcm data of size %u to '%s'", data.size(), url);
-
-            //init curl
-            curl_global_init(CURL_GLOBAL_ALL);
-            curl = curl_easy_init();
-
-            if(!curl)
+            if(!_curl)
             {
                 LOGERR("could not init curl\n");
                 return false;
             }
 
+            // Reset drops the options of the previous clip but keeps its connection and DNS cache,
+            // so back-to-back clips to the same server reuse the connection.
+            curl_easy_reset(_curl);
+            curl_easy_setopt(_curl, CURLOPT_URL, url);
+            curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, headers);
+            curl_easy_setopt(_curl, CURLOPT_CONNECTTIMEOUT, UPLOAD_CONNECT_TIMEOUT_SEC);
+            curl_easy_setopt(_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(_curl, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(_curl, CURLOPT_XFERINFOFUNCTION, upload_progress);
+            curl_easy_setopt(_curl, CURLOPT_XFERINFODATA, this);
+            return true;
+        }
+
+        bool DataCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str, bool &retryable)
+        {
+            bool call_succeeded = true;
+
             //create header
             struct curl_slist *chunk = NULL;
             chunk = curl_slist_append(chunk, "Content-Type: audio/x-wav");
 
-            //set url and data
-            curl_easy_setopt(curl, CURLOPT_URL, url);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            if(!prepareUpload(url, chunk))
+            {
+                curl_slist_free_all(chunk);
+                return false;
+            }
+
+            LOGWARN("uploading pcm data of size %u to '%s'", data.size(), url);
+
+            //set data
+            curl_easy_setopt(_curl, CURLOPT_POSTFIELDSIZE, data.size());
+            curl_easy_setopt(_curl, CURLOPT_POSTFIELDS, &data[0]);
 
             //perform blocking upload call
-            res = curl_easy_perform(curl);
+            call_succeeded = perform_upload(_curl, error_str, retryable);
 
-            //output success / failure log
-            if(CURLE_OK == res)
-            {
-                long response_code;
+            curl_slist_free_all(chunk);
 
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+            return call_succeeded;
+        }
 
-                if(600 > response_code && response_code >= 400)
-                {
-                    LOGERR("uploading failed with response code %ld\n", response_code);
-                    error_str = std::string("response code:") + std::to_string(response_code);
-                    call_succeeded = false;
-                }
-                else
-                    LOGWARN("upload done");
+        bool DataCapture::streamDataToUrl(clip_stream &stream, const char *url, std::string &error_str, bool &retryable)
+        {
+            bool call_succeeded = true;
+
+            //create header; the clip length is unknown until the socket hits EOS
+            struct curl_slist *chunk = NULL;
+            chunk = curl_slist_append(chunk, "Content-Type: audio/x-wav");
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
+
+            if(!prepareUpload(url, chunk))
+            {
+                curl_slist_free_all(chunk);
+                return false;
             }
-            else
+
+            LOGWARN("streaming pcm data to '%s'", url);
+
+            //set data source
+            curl_easy_setopt(_curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(_curl, CURLOPT_READFUNCTION, clip_stream::read_callback);
+            curl_easy_setopt(_curl, CURLOPT_READDATA, &stream);
+
+            //perform blocking upload call, pulling chunks from the socket as cURL needs them
+            call_succeeded = perform_upload(_curl, error_str, retryable);
+
+            if(stream.failed)
             {
-                LOGERR("upload failed with error %d:'%s'", res, curl_easy_strerror(res));
-                error_str = std::to_string(res) + std::string(":'") + std::string(curl_easy_strerror(res)) + std::string("'");
+                error_str = std::string("socket read error after ") + std::to_string(stream.total_size) + std::string(" bytes");
                 call_succeeded = false;
+                retryable = false;
             }
-            //clean up curl object
-            curl_easy_cleanup(curl);
+            else if(call_succeeded)
+            {
+                LOGWARN("streamed %u bytes", (unsigned int)stream.total_size);
+            }
+
+            curl_slist_free_all(chunk);
+
+            return call_succeeded;
+        }
+
+        bool DataCapture::uploadFileToUrl(const string &path, const char *url, std::string &error_str, bool &retryable)
+        {
+            bool call_succeeded = true;
+
+            Core::File file(path);
+            FILE *source = fopen(C_STR(path), "rb");
+            if(!source)
+            {
+                LOGERR("Unable to open %s", C_STR(path));
+                error_str = std::string("spool file lost");
+                retryable = false;
+                return false;
+            }
+
+            //create header
+            struct curl_slist *chunk = NULL;
+            chunk = curl_slist_append(chunk, "Content-Type: audio/x-wav");
+
+            if(!prepareUpload(url, chunk))
+            {
+                curl_slist_free_all(chunk);
+                fclose(source);
+                return false;
+            }
+
+            LOGWARN("uploading pcm data of size %llu from '%s' to '%s'", (unsigned long long)file.Size(), C_STR(path), url);
+
+            //set data source
+            curl_easy_setopt(_curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(_curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)file.Size());
+            curl_easy_setopt(_curl, CURLOPT_READFUNCTION, spool_read_callback);
+            curl_easy_setopt(_curl, CURLOPT_READDATA, source);
+
+            //perform blocking upload call
+            call_succeeded = perform_upload(_curl, error_str, retryable);
+
             curl_slist_free_all(chunk);
+            fclose(source);
 
             return call_succeeded;
         }
@@ -23,9 +23,17 @@
 #include "utils.h"
 #include "AbstractPlugin.h"
 #include "libIBus.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <curl/curl.h>
 //#include "irMgr.h"
 
 class socket_adaptor;
+struct clip_stream;
 
 namespace WPEFramework {
     namespace Plugin {
@@ -52,6 +60,19 @@ namespace WPEFramework {
             uint32_t enableAudioCaptureWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getAudioClipWrapper(const JsonObject& parameters, JsonObject& response);
 
+        private/*types*/:
+            struct upload_job
+            {
+                string data_locator;
+                string file_name;
+                string url;
+                bool stream;
+                unsigned int attempts;
+                std::chrono::steady_clock::time_point next_attempt;
+                string spool_path; // set once a failed upload has been written to disk
+                size_t spool_size;
+            };
+
         private/*internal methods*/:
             DataCapture(const DataCapture&) = delete;
             DataCapture& operator=(const DataCapture&) = delete;
@@ -63,7 +84,17 @@ namespace WPEFramework {
             int enableAudioCapture(unsigned int bufferMaxDuration);
             int getAudioClip(const JsonObject& clipRequest);
             void constructFormatString();
-            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str);
+            void notifyClipReady(const string &fileName, bool status, const string &message);
+
+            void startUploadWorker();
+            void stopUploadWorker();
+            void uploadWorker();
+            bool processUploadJob(upload_job &job);
+            static int upload_progress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+            bool prepareUpload(const char *url, struct curl_slist *headers);
+            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str, bool &retryable);
+            bool streamDataToUrl(clip_stream &stream, const char *url, std::string &error_str, bool &retryable);
+            bool uploadFileToUrl(const string &path, const char *url, std::string &error_str, bool &retryable);
         private/*members*/:
             audiocapturemgr::session_id_t _session_id;
             unsigned int _max_supported_duration;
@@ -72,7 +103,15 @@ namespace WPEFramework {
             string _audio_format_string;
             string _destination_url;
             bool _is_precapture;
+            bool _stream_upload;
             unsigned int _duration;
+            CURL *_curl; // used by the upload worker only
+            std::thread _upload_thread;
+            std::mutex _upload_mutex;
+            std::condition_variable _upload_signal;
+            std::deque<upload_job> _upload_queue;
+            std::atomic<bool> _upload_stop;
+            size_t _spool_size; // bytes in the spool directory, used by the upload worker only
             static pthread_mutex_t _mutex;
         };
     } // namespace Plugin
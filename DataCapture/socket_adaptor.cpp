@@ -38,6 +38,8 @@ static const unsigned int MAX_CONNECTIONS = 1;
 
 static bool g_one_time_init_complete = false;
 
+const unsigned int socket_adaptor::CHUNK_SIZE;
+
 socket_adaptor::socket_adaptor() : m_listen_fd(-1), m_write_fd(-1), m_read_fd(-1), m_num_connections(0), m_callback(nullptr)
 {
 	SA_INFO("Enter\n");
@@ -81,6 +83,7 @@ int socket_adaptor::connect_socket(const std::string &path)
         } else {
             SA_ERR("connect() failed\n");
             close(m_read_fd);
+            m_read_fd = -1;
             ret = -1;
             return ret;
 
@@ -121,7 +124,6 @@ int socket_adaptor::write_data(const char * buffer, const unsigned int size)
 unsigned int socket_adaptor::fetch_data()
 {
     unsigned int size_recv , total_size = 0, n = 0;
-    unsigned short int CHUNK_SIZE = 4096;
     char chunk[CHUNK_SIZE];
 
     if(m_read_fd < 0) {
@@ -146,6 +148,47 @@ unsigned int socket_adaptor::fetch_data()
     }
     SA_WARN("%d bytes received in %u reads!\n", total_size, n);
 
+    close_read_socket();
+
+    return total_size;
+}
+
+int socket_adaptor::read_data(char * buffer, const unsigned int size)
+{
+    if(m_read_fd < 0) {
+        SA_ERR("Unable to read data. Did you connect?");
+        return -1;
+    }
+
+    ssize_t size_recv;
+    do
+    {
+        size_recv = read(m_read_fd, buffer, size);
+    } while((0 > size_recv) && (EINTR == errno));
+
+    if(0 > size_recv)
+    {
+        SA_ERR("read() failed. errno: 0x%x\n", errno);
+        close_read_socket();
+        return -1;
+    }
+    if(0 == size_recv)
+    {
+        close_read_socket();
+    }
+    return (int)size_recv;
+}
+
+void socket_adaptor::disconnect_socket()
+{
+    if(0 <= m_read_fd)
+    {
+        close_read_socket();
+    }
+}
+
+void socket_adaptor::close_read_socket()
+{
     close(m_read_fd);
     lock();
     if(0 < m_read_fd)
@@ -153,8 +196,6 @@ unsigned int socket_adaptor::fetch_data()
         m_read_fd = -1;
     }
     unlock();
-
-    return total_size;
 }
 
 void socket_adaptor::get_data(std::vector<unsigned char>& data)
@@ -49,6 +49,8 @@ class socket_adaptor
 		CODE_MAX
 	} control_code_t;
 
+	static const unsigned int CHUNK_SIZE = 4096;
+
 	private:
 	std::string m_path;
 	int m_listen_fd;
@@ -62,6 +64,7 @@ class socket_adaptor
 	socket_adaptor_cb_t m_callback;
 	void * m_callback_data;
 
+	void close_read_socket();
 	void process_new_connection();
 	void process_control_message(control_code_t message);
 	int stop_listening();
@@ -133,6 +136,24 @@ class socket_adaptor
      */
     unsigned int get_data(char * buffer, const unsigned int size);
 
+    /**
+     *  @brief This api invokes unix read() once to pull the next piece of data straight from the connected socket
+     *
+     *  Nothing is kept in the internal buffer, so callers can forward a clip of any length while holding only
+     *  a single chunk in memory. The socket is closed once the other end signals EOS or an error occurs.
+     *
+     *  @param[in] buffer Destination buffer.
+     *  @param[in] size   Size of the buffer
+     *
+     *  @return Returns number of bytes read, 0 at the end of the stream or -1 in case of an error
+     */
+    int read_data(char * buffer, const unsigned int size);
+
+    /**
+     *  @brief This api closes the socket opened by connect_socket() without reading the rest of the data.
+     */
+    void disconnect_socket();
+
     /**
      *  @brief This api invokes  close() to terminate the current connection.
      */
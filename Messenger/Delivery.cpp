@@ -0,0 +1,351 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "Delivery.h"
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    namespace {
+
+        // Events handed to one user before a worker moves on to the next one, so a user with a
+        // backlog cannot starve the others.
+        const uint32_t DeliveryBatch = 16;
+        const std::chrono::milliseconds DeliverySlice(2);
+
+        const uint8_t DefaultWorkers = 2;
+        const uint16_t DefaultQueueDepth = 256;
+    }
+
+    Mailbox::Mailbox(DeliveryPool& pool, const string& userId, Exchange::IRoomAdministrator::IRoom::IMsgNotification* messageSink)
+        : _pool(pool)
+        , _userId(userId)
+        , _messageSink(messageSink)
+        , _callback(nullptr)
+        , _queue()
+        , _scheduled(false)
+        , _running(false)
+        , _closed(false)
+        , _slow(false)
+        , _runner()
+        , _lock()
+        , _idle()
+    {
+        if (_messageSink != nullptr) {
+            _messageSink->AddRef();
+        }
+    }
+
+    Mailbox::~Mailbox()
+    {
+        ASSERT(_running == false);
+
+        if (_callback != nullptr) {
+            _callback->Release();
+        }
+
+        if (_messageSink != nullptr) {
+            _messageSink->Release();
+        }
+    }
+
+    bool Mailbox::Post(const Event& event)
+    {
+        bool result = true;
+        bool schedule = false;
+
+        std::unique_lock<std::mutex> lock(_lock);
+
+        // Nobody would see it anyway.
+        if ((_closed == true) || ((event.Kind == MESSAGE) ? (_messageSink == nullptr) : (_callback == nullptr))) {
+            return (result);
+        }
+
+        if (_queue.size() >= _pool.QueueDepth()) {
+            _pool._dropped++;
+
+            if (_slow == false) {
+                _slow = true;
+                _pool._slowConsumers++;
+
+                TRACE(Trace::Warning, (_T("Room user '%s' is not keeping up, dropping events"), _userId.c_str()));
+            }
+
+            result = false;
+        }
+        else {
+            _queue.push_back(event);
+
+            uint32_t depth = static_cast<uint32_t>(_queue.size());
+            uint32_t maxDepth = _pool._maxDepth.load();
+            while ((depth > maxDepth) && (_pool._maxDepth.compare_exchange_weak(maxDepth, depth) == false)) {
+            }
+
+            if (_scheduled == false) {
+                _scheduled = true;
+                schedule = true;
+            }
+        }
+
+        lock.unlock();
+
+        if (schedule == true) {
+            _pool.Schedule(shared_from_this());
+        }
+
+        return (result);
+    }
+
+    void Mailbox::SetCallback(Exchange::IRoomAdministrator::IRoom::ICallback* callback)
+    {
+        if (callback != nullptr) {
+            callback->AddRef();
+        }
+
+        _lock.lock();
+
+        // Once closed, the new callback is released straight away.
+        if (_closed == false) {
+            std::swap(callback, _callback);
+        }
+
+        _lock.unlock();
+
+        if (callback != nullptr) {
+            callback->Release();
+        }
+    }
+
+    void Mailbox::Close()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+
+        _closed = true;
+        _queue.clear();
+
+        if (_runner != std::this_thread::get_id()) {
+            _idle.wait(lock, [this]() { return (_running == false); });
+        }
+
+        Exchange::IRoomAdministrator::IRoom::IMsgNotification* messageSink = _messageSink;
+        Exchange::IRoomAdministrator::IRoom::ICallback* callback = _callback;
+        _messageSink = nullptr;
+        _callback = nullptr;
+
+        lock.unlock();
+
+        // The delivering thread holds its own references if this is called from a callback.
+        if (callback != nullptr) {
+            callback->Release();
+        }
+
+        if (messageSink != nullptr) {
+            messageSink->Release();
+        }
+    }
+
+    bool Mailbox::Deliver(uint32_t maxEvents)
+    {
+        Exchange::IRoomAdministrator::IRoom::IMsgNotification* messageSink;
+        Exchange::IRoomAdministrator::IRoom::ICallback* callback;
+
+        std::unique_lock<std::mutex> lock(_lock);
+
+        if (_closed == true) {
+            _scheduled = false;
+            return (false);
+        }
+
+        // SetCallback() may replace the callback while it is being invoked.
+        messageSink = _messageSink;
+        callback = _callback;
+        if (messageSink != nullptr) {
+            messageSink->AddRef();
+        }
+        if (callback != nullptr) {
+            callback->AddRef();
+        }
+
+        _running = true;
+        _runner = std::this_thread::get_id();
+
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + DeliverySlice;
+        uint64_t delivered = 0;
+
+        // One event at a time, so Close() takes effect between two callbacks and a user whose
+        // callbacks block gives up the thread after the first one that exceeds the slice.
+        for (uint32_t count = 0; (count < maxEvents) && (_queue.empty() == false); count++) {
+            Event event(std::move(_queue.front()));
+            _queue.pop_front();
+
+            lock.unlock();
+
+            if (event.Kind == MESSAGE) {
+                if (messageSink != nullptr) {
+                    messageSink->Message(event.Data->User, event.Data->Text);
+                    delivered++;
+                }
+            }
+            else if (callback != nullptr) {
+                if (event.Kind == JOINED) {
+                    callback->Joined(event.Data->User);
+                }
+                else {
+                    callback->Left(event.Data->User);
+                }
+                delivered++;
+            }
+
+            lock.lock();
+
+            if (std::chrono::steady_clock::now() >= end) {
+                break;
+            }
+        }
+
+        lock.unlock();
+
+        _pool._delivered += delivered;
+
+        if (callback != nullptr) {
+            callback->Release();
+        }
+        if (messageSink != nullptr) {
+            messageSink->Release();
+        }
+
+        lock.lock();
+
+        _running = false;
+        _runner = std::thread::id();
+
+        bool more = ((_closed == false) && (_queue.empty() == false));
+
+        if (more == false) {
+            _scheduled = false;
+            _slow = false;
+        }
+
+        _idle.notify_all();
+
+        return (more);
+    }
+
+    DeliveryPool::DeliveryPool()
+        : _workers(DefaultWorkers)
+        , _queueDepth(DefaultQueueDepth)
+        , _ready()
+        , _threads()
+        , _stop(false)
+        , _lock()
+        , _signal()
+        , _delivered(0)
+        , _dropped(0)
+        , _slowConsumers(0)
+        , _maxDepth(0)
+    {
+    }
+
+    DeliveryPool::~DeliveryPool()
+    {
+        _lock.lock();
+        _stop = true;
+        _lock.unlock();
+
+        _signal.notify_all();
+
+        for (std::thread& thread : _threads) {
+            thread.join();
+        }
+
+        _ready.clear();
+    }
+
+    void DeliveryPool::Configure(uint8_t workers, uint16_t queueDepth)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        if (_threads.empty() == true) {
+            _workers = std::max(workers, static_cast<uint8_t>(1));
+            _queueDepth = std::max(queueDepth, static_cast<uint16_t>(1));
+        }
+    }
+
+    void DeliveryPool::Schedule(const std::shared_ptr<Mailbox>& mailbox)
+    {
+        _lock.lock();
+
+        if (_stop == false) {
+            // Started with the first event, so Configure() can still take effect after construction.
+            while (_threads.size() < _workers) {
+                _threads.emplace_back(&DeliveryPool::Worker, this);
+            }
+
+            _ready.push_back(mailbox);
+        }
+
+        _lock.unlock();
+
+        _signal.notify_one();
+    }
+
+    DeliveryPool::Statistics DeliveryPool::Stats() const
+    {
+        Statistics result;
+
+        result.Delivered = _delivered.load();
+        result.Dropped = _dropped.load();
+        result.SlowConsumers = _slowConsumers.load();
+        result.MaxDepth = _maxDepth.load();
+
+        return (result);
+    }
+
+    void DeliveryPool::Worker()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+
+        while (true) {
+            _signal.wait(lock, [this]() { return ((_stop == true) || (_ready.empty() == false)); });
+
+            if (_stop == true) {
+                break;
+            }
+
+            std::shared_ptr<Mailbox> mailbox(std::move(_ready.front()));
+            _ready.pop_front();
+
+            lock.unlock();
+
+            bool more = mailbox->Deliver(DeliveryBatch);
+
+            lock.lock();
+
+            if (more == true) {
+                // Back of the line, behind the users that have been waiting meanwhile.
+                _ready.push_back(std::move(mailbox));
+            }
+        }
+    }
+
+} // namespace Plugin
+
+} // namespace WPEFramework
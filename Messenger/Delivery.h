@@ -0,0 +1,143 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include <interfaces/IMessenger.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    class DeliveryPool;
+
+    // Events pending for one room user. Senders only append to the (bounded) queue; the callbacks
+    // of the user are invoked by a DeliveryPool thread, in the order the events were posted.
+    class Mailbox : public std::enable_shared_from_this<Mailbox> {
+    public:
+        enum kind : uint8_t {
+            MESSAGE,
+            JOINED,
+            LEFT
+        };
+
+        // Shared by all recipients of one fan-out.
+        struct Payload {
+            Payload(const string& user, const string& text)
+                : User(user)
+                , Text(text)
+            { /* empty */ }
+
+            const string User;
+            const string Text;
+        };
+
+        struct Event {
+            kind Kind;
+            std::shared_ptr<const Payload> Data;
+        };
+
+        Mailbox() = delete;
+        Mailbox(const Mailbox&) = delete;
+        Mailbox& operator=(const Mailbox&) = delete;
+
+        Mailbox(DeliveryPool& pool, const string& userId, Exchange::IRoomAdministrator::IRoom::IMsgNotification* messageSink);
+        ~Mailbox();
+
+        // False if the event was dropped because the user is not consuming fast enough.
+        bool Post(const Event& event);
+        void SetCallback(Exchange::IRoomAdministrator::IRoom::ICallback* callback);
+
+        // Discards pending events and waits for a delivery in progress, so no callback of this
+        // user runs once it returns (unless called from within such a callback).
+        void Close();
+
+        // Called by the pool; returns true if more events are pending.
+        bool Deliver(uint32_t maxEvents);
+
+        const string& UserId() const { return _userId; }
+
+    private:
+        DeliveryPool& _pool;
+        const string _userId;
+        Exchange::IRoomAdministrator::IRoom::IMsgNotification* _messageSink;
+        Exchange::IRoomAdministrator::IRoom::ICallback* _callback;
+        std::deque<Event> _queue;
+        bool _scheduled;
+        bool _running;
+        bool _closed;
+        bool _slow;
+        std::thread::id _runner;
+        std::mutex _lock;
+        std::condition_variable _idle;
+    };
+
+    class DeliveryPool {
+    public:
+        struct Statistics {
+            uint64_t Delivered; // events handed to a callback
+            uint64_t Dropped; // events discarded because a queue was full
+            uint64_t SlowConsumers; // times a user's queue overflowed
+            uint32_t MaxDepth; // deepest queue seen
+        };
+
+        DeliveryPool(const DeliveryPool&) = delete;
+        DeliveryPool& operator=(const DeliveryPool&) = delete;
+
+        DeliveryPool();
+        ~DeliveryPool();
+
+        // Only effective before the first event is posted.
+        void Configure(uint8_t workers, uint16_t queueDepth);
+
+        void Schedule(const std::shared_ptr<Mailbox>& mailbox);
+        Statistics Stats() const;
+
+        uint16_t QueueDepth() const { return _queueDepth; }
+
+    private:
+        friend class Mailbox;
+
+        void Worker();
+
+        uint8_t _workers;
+        uint16_t _queueDepth;
+        std::deque<std::shared_ptr<Mailbox>> _ready;
+        std::vector<std::thread> _threads;
+        bool _stop;
+        std::mutex _lock;
+        std::condition_variable _signal;
+        std::atomic<uint64_t> _delivered;
+        std::atomic<uint64_t> _dropped;
+        std::atomic<uint64_t> _slowConsumers;
+        std::atomic<uint32_t> _maxDepth;
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
@@ -0,0 +1,136 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "MessageHistory.h"
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    MessageHistory::MessageHistory(uint16_t depth, uint32_t size)
+        : _depth((size == 0) ? 0 : depth)
+        , _size((depth == 0) ? 0 : size)
+        , _entries()
+        , _arena()
+        , _first(0)
+        , _count(0)
+        , _head(0)
+        , _sequence(0)
+    {
+    }
+
+    void MessageHistory::Add(const string& sender, const string& text)
+    {
+        const uint64_t sequence = _sequence++;
+        const uint64_t length = static_cast<uint64_t>(sender.size()) + text.size();
+
+        if ((_depth == 0) || (length > _size)) {
+            return;
+        }
+
+        if (_arena.empty() == true) {
+            _entries.resize(_depth);
+            _arena.resize(_size);
+        }
+
+        if (_count == _depth) {
+            Evict();
+        }
+
+        uint32_t offset;
+        while (Reserve(static_cast<uint32_t>(length), offset) == false) {
+            Evict();
+        }
+
+        ::memcpy(&_arena[offset], sender.data(), sender.size());
+        ::memcpy(&_arena[offset + sender.size()], text.data(), text.size());
+
+        Entry& entry(_entries[(_first + _count) % _depth]);
+        entry.Sequence = sequence;
+        entry.Offset = offset;
+        entry.SenderLength = static_cast<uint32_t>(sender.size());
+        entry.TextLength = static_cast<uint32_t>(text.size());
+
+        _count++;
+        _head = offset + static_cast<uint32_t>(length);
+    }
+
+    void MessageHistory::Replay(uint64_t before, const std::function<void(const string& sender, const string& text)>& handler) const
+    {
+        for (uint16_t index = 0; index < _count; index++) {
+            const Entry& entry(_entries[(_first + index) % _depth]);
+
+            if (entry.Sequence >= before) {
+                break;
+            }
+
+            const char* data = &_arena[entry.Offset];
+            handler(string(data, entry.SenderLength), string(data + entry.SenderLength, entry.TextLength));
+        }
+    }
+
+    bool MessageHistory::Reserve(uint32_t length, uint32_t& offset) const
+    {
+        bool result = false;
+
+        if (_count == 0) {
+            offset = 0;
+            result = true;
+        }
+        else {
+            const uint32_t tail = _entries[_first].Offset;
+
+            if (_head > tail) {
+                // Used: [tail, _head); try behind it first, then wrap around to the start.
+                if ((_size - _head) >= length) {
+                    offset = _head;
+                    result = true;
+                }
+                else if (tail >= length) {
+                    offset = 0;
+                    result = true;
+                }
+            }
+            else if ((tail - _head) >= length) {
+                // Wrapped, used: [tail, end) and [0, _head). Equal positions mean a full arena.
+                offset = _head;
+                result = ((length == 0) || (tail != _head));
+            }
+        }
+
+        return (result);
+    }
+
+    void MessageHistory::Evict()
+    {
+        ASSERT(_count > 0);
+
+        _first = (_first + 1) % _depth;
+        _count--;
+
+        if (_count == 0) {
+            _first = 0;
+            _head = 0;
+        }
+    }
+
+} // namespace Plugin
+
+} // namespace WPEFramework
@@ -0,0 +1,77 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+
+#include <functional>
+#include <vector>
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // The most recent messages of a room, replayed to users that joined after they were sent.
+    // Sender and text are stored back to back in one circular byte arena of a fixed size; the
+    // oldest messages are evicted when either the number of messages or the arena runs out.
+    class MessageHistory {
+    public:
+        MessageHistory(const MessageHistory&) = delete;
+        MessageHistory& operator=(const MessageHistory&) = delete;
+
+        // A depth or size of 0 disables the history.
+        MessageHistory(uint16_t depth, uint32_t size);
+        ~MessageHistory() = default;
+
+        // Messages that do not fit in the arena at all are not kept.
+        void Add(const string& sender, const string& text);
+
+        // Sequence number the next message will get.
+        uint64_t Sequence() const { return _sequence; }
+
+        // Calls handler for the kept messages with a sequence number below 'before', oldest first.
+        void Replay(uint64_t before, const std::function<void(const string& sender, const string& text)>& handler) const;
+
+        uint16_t Count() const { return _count; }
+
+    private:
+        struct Entry {
+            uint64_t Sequence;
+            uint32_t Offset;
+            uint32_t SenderLength;
+            uint32_t TextLength;
+        };
+
+        bool Reserve(uint32_t length, uint32_t& offset) const;
+        void Evict();
+
+        const uint16_t _depth;
+        const uint32_t _size;
+        std::vector<Entry> _entries; // ring of _depth entries, allocated with the first message
+        std::vector<char> _arena; // _size bytes, allocated with the first message
+        uint16_t _first;
+        uint16_t _count;
+        uint32_t _head; // where the next message is written
+        uint64_t _sequence;
+    };
+
+} // namespace Plugin
+
+} // namespace WPEFramework
@@ -19,6 +19,7 @@
  
 #include "Module.h"
 #include "Messenger.h"
+#include "RoomMaintainer.h"
 #include "cryptalgo/Hash.h"
 
 namespace WPEFramework {
@@ -40,9 +41,18 @@ namespace Plugin {
         _service = service;
         _service->AddRef();
 
+        Config config;
+        config.FromString(service->ConfigLine());
+
         _roomAdmin = service->Root<Exchange::IRoomAdministrator>(_connectionId, 2000, _T("RoomMaintainer"));
         ASSERT(_roomAdmin != nullptr);
 
+        // Only a maintainer running in this process can be configured.
+        RoomMaintainer* maintainer = dynamic_cast<RoomMaintainer*>(_roomAdmin);
+        if (maintainer != nullptr) {
+            maintainer->Configure(config.Workers.Value(), config.QueueDepth.Value(), config.HistoryDepth.Value(), config.HistorySize.Value());
+        }
+
         _roomAdmin->Register(this);
 
         return { };
@@ -69,6 +79,26 @@ namespace Plugin {
         _service = nullptr;
     }
 
+    /* virtual */ string Messenger::Information() const
+    {
+        string result;
+
+        const RoomMaintainer* maintainer = dynamic_cast<const RoomMaintainer*>(_roomAdmin);
+
+        if (maintainer != nullptr) {
+            DeliveryPool::Statistics stats(maintainer->Statistics());
+
+            JsonObject info;
+            info["delivered"] = stats.Delivered;
+            info["dropped"] = stats.Dropped;
+            info["slowconsumers"] = stats.SlowConsumers;
+            info["maxqueuedepth"] = stats.MaxDepth;
+            info.ToString(result);
+        }
+
+        return (result);
+    }
+
     // Web request handlers
 
     string Messenger::JoinRoom(const string& roomName, const string& userName)
@@ -33,6 +33,36 @@ namespace Plugin {
     class Messenger : public PluginHost::IPlugin
                     , public Exchange::IRoomAdministrator::INotification
                     , public PluginHost::JSONRPCSupportsEventStatus {
+    private:
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&) = delete;
+            Config& operator=(const Config&) = delete;
+
+        public:
+            Config()
+                : Core::JSON::Container()
+                , Workers(2)
+                , QueueDepth(256)
+                , HistoryDepth(0)
+                , HistorySize(16384)
+            {
+                Add(_T("workers"), &Workers);
+                Add(_T("queuedepth"), &QueueDepth);
+                Add(_T("historydepth"), &HistoryDepth);
+                Add(_T("historysize"), &HistorySize);
+            }
+            ~Config()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt8 Workers; // threads delivering messages and room updates
+            Core::JSON::DecUInt16 QueueDepth; // events pending per user before new ones are dropped
+            Core::JSON::DecUInt16 HistoryDepth; // messages per room replayed to users joining later, 0 disables it
+            Core::JSON::DecUInt32 HistorySize; // bytes per room for the sender names and texts of those messages
+        };
+
     public:
         Messenger(const Messenger&) = delete;
         Messenger& operator=(const Messenger&) = delete;
@@ -55,7 +85,7 @@ namespace Plugin {
         // IPlugin methods
         virtual const string Initialize(PluginHost::IShell* service) override;
         virtual void Deinitialize(PluginHost::IShell* service) override;
-        virtual string Information() const override  { return { }; }
+        virtual string Information() const override;
 
         // Notification handling
         class MsgNotification : public Exchange::IRoomAdministrator::IRoom::IMsgNotification {
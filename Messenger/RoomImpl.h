@@ -33,22 +33,19 @@ namespace Plugin {
         RoomImpl(const RoomImpl&) = delete;
         RoomImpl& operator=(const RoomImpl&) = delete;
 
-        RoomImpl(RoomMaintainer* admin, const string& roomId, const string& userId, IMsgNotification* messageSink)
+        RoomImpl(RoomMaintainer* admin, const std::shared_ptr<RoomMaintainer::Room>& room, const string& roomId, const string& userId, IMsgNotification* messageSink)
             : _roomId(roomId)
             , _userId(userId)
             , _roomAdmin(admin)
-            , _callback(nullptr)
-            , _messageSink(messageSink)
-            , _adminLock()
+            , _room(room)
+            , _mailbox(std::make_shared<Mailbox>(admin->Pool(), userId, messageSink))
+            , _joinedAt(room->History.Sequence())
+            , _replayed(false)
         {
             ASSERT(admin != nullptr);
 
             _roomAdmin->AddRef();
 
-            if (_messageSink) {
-                _messageSink->AddRef();
-            }
-
             if (userId.size() == 0) {
                 TRACE(Trace::Warning, (_T("Created a user with empty userId")));
             }
@@ -60,12 +57,8 @@ namespace Plugin {
 
             _roomAdmin->Exit(this);
 
-            // Release the callback if necessary.
-            SetCallback(nullptr);
-
-            if (_messageSink) {
-                _messageSink->Release();
-            }
+            // No more events are posted now; drop the pending ones and release the callbacks.
+            _mailbox->Close();
 
             _roomAdmin->Release();
         }
@@ -83,19 +76,7 @@ namespace Plugin {
         {
             ASSERT(_roomAdmin != nullptr);
 
-            if (callback != nullptr) {
-                callback->AddRef();
-            }
-
-            _adminLock.Lock();
-
-            if (_callback != nullptr) {
-                _callback->Release();
-            }
-
-            _callback = callback;
-
-            _adminLock.Unlock();
+            _mailbox->SetCallback(callback);
 
             TRACE(Trace::Information, (_T("User '%s': %s the callback"),
                     UserId().c_str(), (callback != nullptr? _T("Registered") : _T("Unregistered"))));
@@ -107,43 +88,22 @@ namespace Plugin {
         }
 
         // RoomImpl methods
-        void UserJoined(const string& userId)
-        {
-            TRACE(Trace::Information, (_T("User '%s': Notified that '%s' joined room '%s'"),
-                    UserId().c_str(), userId.c_str(), RoomId().c_str()));
-
-            _adminLock.Lock();
 
-            if (_callback != nullptr) {
-                _callback->Joined(userId);
-            }
-
-            _adminLock.Unlock();
-        }
-
-        void UserLeft(const string& userId)
+        // Queues a message or room update for this user; the callbacks are invoked by the delivery pool.
+        bool Post(const Mailbox::Event& event)
         {
-            TRACE(Trace::Information, (_T("User '%s': Notified that '%s' left room '%s'"),
-                    UserId().c_str(), userId.c_str(), RoomId().c_str()));
-
-            _adminLock.Lock();
-
-            if (_callback != nullptr) {
-                _callback->Left(userId);
-            }
-
-            _adminLock.Unlock();
-        }
-
-        void MessageReceived(const string& userId, const string& message)
-        {
-            if (_messageSink != nullptr) {
-                _messageSink->Message(userId, message);
-            }
+            return (_mailbox->Post(event));
         }
 
         const string& UserId() const { return _userId; }
         const string& RoomId() const { return _roomId; }
+        const std::shared_ptr<RoomMaintainer::Room>& Room() const { return _room; }
+
+        // Sequence number of the first room message sent after the user joined; the earlier ones
+        // are replayed once, when a callback is registered. Both guarded by the room lock.
+        uint64_t JoinedAt() const { return _joinedAt; }
+        bool Replayed() const { return _replayed; }
+        void Replayed(bool replayed) { _replayed = replayed; }
 
         // QueryInterface implementation
         BEGIN_INTERFACE_MAP(RoomImpl)
@@ -154,9 +114,10 @@ namespace Plugin {
         string _roomId;
         string _userId;
         RoomMaintainer* _roomAdmin;
-        Exchange::IRoomAdministrator::IRoom::ICallback* _callback;
-        Exchange::IRoomAdministrator::IRoom::IMsgNotification* _messageSink;
-        mutable Core::CriticalSection _adminLock;
+        std::shared_ptr<RoomMaintainer::Room> _room;
+        std::shared_ptr<Mailbox> _mailbox;
+        uint64_t _joinedAt;
+        bool _replayed;
     };
 
 } // namespace Plugin
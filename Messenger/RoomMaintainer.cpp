@@ -39,9 +39,8 @@ namespace Plugin {
         auto  it(_roomMap.find(roomId));
 
         if (it == _roomMap.end()) {
-            // Room not found, so create one, already emplacing the first user.
-            newRoomUser = Core::Service<RoomImpl>::Create<RoomImpl>(this, roomId, userId, messageSink);
-            it = _roomMap.emplace(roomId, std::list<RoomImpl*>({newRoomUser})).first;
+            // Room not found, so create one.
+            it = _roomMap.emplace(roomId, std::make_shared<Room>(_historyDepth, _historySize)).first;
 
             TRACE(Trace::Information, (_T("Room Maintainer: Room '%s' created"), roomId.c_str()));
             if (roomId.size() == 0) {
@@ -53,33 +52,36 @@ namespace Plugin {
                 observer->Created(roomId);
             }
         }
-        else {
-            // Room already created; try to add another user.
-            std::list<RoomImpl*>& users = (*it).second;
 
-            if (std::find_if(users.begin(), users.end(), [&userId](const RoomImpl* user) { return (user->UserId() == userId);}) == users.end()) {
-                newRoomUser = Core::Service<RoomImpl>::Create<RoomImpl>(this, roomId, userId, messageSink);
+        std::shared_ptr<Room> room((*it).second);
 
-                // Notify the room about a joining user.
-                // No point in sending the notification to the joining user as it cannot have its callback registered yet.
-                for (auto& user : users) {
-                    user->UserJoined(userId);
-                }
+        // Taken before the map is released, so Exit() cannot remove the room in between.
+        room->Lock.Lock();
 
-                users.push_back(newRoomUser);
-            }
-            else {
-                TRACE(Trace::Error, (_T("Room Maintainer: User '%s' has already joined room '%s'"),
-                        userId.c_str(), roomId.c_str()));
+        _adminLock.Unlock();
+
+        if (room->Users.find(userId) == room->Users.end()) {
+            newRoomUser = Core::Service<RoomImpl>::Create<RoomImpl>(this, room, roomId, userId, messageSink);
+
+            // Notify the room about a joining user.
+            // No point in sending the notification to the joining user as it cannot have its callback registered yet.
+            const Mailbox::Event event { Mailbox::JOINED, std::make_shared<const Mailbox::Payload>(userId, string()) };
+
+            for (auto& user : room->Users) {
+                user.second->Post(event);
             }
-        }
 
-        if (newRoomUser) {
+            room->Users.emplace(userId, newRoomUser);
+
             TRACE(Trace::Information, (_T("Room Maintainer: User '%s' has joined room '%s'"),
                     userId.c_str(), roomId.c_str()));
         }
+        else {
+            TRACE(Trace::Error, (_T("Room Maintainer: User '%s' has already joined room '%s'"),
+                    userId.c_str(), roomId.c_str()));
+        }
 
-        _adminLock.Unlock();
+        room->Lock.Unlock();
 
         // May be nullptr if the user has already joined the room earlier.
         return newRoomUser;
@@ -89,79 +91,99 @@ namespace Plugin {
     {
         ASSERT(roomUser != nullptr);
 
+        const std::shared_ptr<Room>& room(roomUser->Room());
+
+        bool roomsLocked = true;
+
         _adminLock.Lock();
+        room->Lock.Lock();
 
-        auto it(_roomMap.find(roomUser->RoomId()));
-        ASSERT(it != _roomMap.end());
+        auto uit(room->Users.find(roomUser->UserId()));
+        ASSERT((uit != room->Users.end()) && ((*uit).second == roomUser));
 
-        if (it != _roomMap.end()) {
-            std::list<RoomImpl*>& users = (*it).second;
+        if ((uit != room->Users.end()) && ((*uit).second == roomUser)) {
+            TRACE(Trace::Information, (_T("Room Maintainer: User '%s' is leaving room '%s'"),
+                    roomUser->UserId().c_str(), roomUser->RoomId().c_str()));
 
-            auto uit(std::find(users.begin(), users.end(), roomUser));
-            ASSERT(uit != users.end());
+            room->Users.erase(uit);
 
-            if (uit != users.end()) {
-                TRACE(Trace::Information, (_T("Room Maintainer: User '%s' is leaving room '%s'"),
-                        roomUser->UserId().c_str(), roomUser->RoomId().c_str()));
+            // Was it the last user?
+            if (room->Users.size() == 0) {
+                auto it(_roomMap.find(roomUser->RoomId()));
+                ASSERT((it != _roomMap.end()) && ((*it).second == room));
 
-                // Notify the room members about a leaving user.
-                for (auto& user : users) {
-                    user->UserLeft(roomUser->UserId());
-                }
+                _roomMap.erase(it);
 
-                users.erase(uit);
+                TRACE(Trace::Information, (_T("Room Maintainer: Room '%s' has been destroyed"), roomUser->RoomId().c_str()));
 
-                // Was it the last user?
-                if (users.size() == 0) {
-                    _roomMap.erase(it);
+                // Notify the observers about the destruction of this room.
+                for (auto& observer : _observers) {
+                    observer->Destroyed(roomUser->RoomId());
+                }
+            }
+            else {
+                // The room stays, the other rooms need not wait for the notifications below.
+                _adminLock.Unlock();
+                roomsLocked = false;
 
-                    TRACE(Trace::Information, (_T("Room Maintainer: Room '%s' has been destroyed"), roomUser->RoomId().c_str()));
+                // Notify the room members about a leaving user.
+                const Mailbox::Event event { Mailbox::LEFT, std::make_shared<const Mailbox::Payload>(roomUser->UserId(), string()) };
 
-                    // Notify the observers about the destruction of this room.
-                    for (auto& observer : _observers) {
-                        observer->Destroyed(roomUser->RoomId());
-                    }
+                for (auto& user : room->Users) {
+                    user.second->Post(event);
                 }
             }
         }
 
-        _adminLock.Unlock();
+        room->Lock.Unlock();
+
+        if (roomsLocked == true) {
+            _adminLock.Unlock();
+        }
     }
 
     void RoomMaintainer::Notify(RoomImpl* roomUser)
     {
         ASSERT(roomUser != nullptr);
 
-        _adminLock.Lock();
+        const std::shared_ptr<Room>& room(roomUser->Room());
 
-        auto it = _roomMap.find(roomUser->RoomId());
-        ASSERT(it != _roomMap.end());
+        room->Lock.Lock();
 
-        if (it != _roomMap.end()) {
-            for (auto& user : (*it).second) {
-                roomUser->UserJoined(user->UserId());
-            }
+        for (auto& user : room->Users) {
+            roomUser->Post(Mailbox::Event { Mailbox::JOINED, std::make_shared<const Mailbox::Payload>(user.first, string()) });
         }
 
-        _adminLock.Unlock();
+        // Catch up on the messages sent before the user joined, once. Later ones were delivered already.
+        if (roomUser->Replayed() == false) {
+            roomUser->Replayed(true);
+
+            room->History.Replay(roomUser->JoinedAt(), [roomUser](const string& sender, const string& text) {
+                roomUser->Post(Mailbox::Event { Mailbox::MESSAGE, std::make_shared<const Mailbox::Payload>(sender, text) });
+            });
+        }
+
+        room->Lock.Unlock();
     }
 
     void RoomMaintainer::Send(const string& message, RoomImpl* roomUser)
     {
         ASSERT(roomUser != nullptr);
 
-        _adminLock.Lock();
+        const std::shared_ptr<Room>& room(roomUser->Room());
 
-        auto it(_roomMap.find(roomUser->RoomId()));
-        ASSERT(it != _roomMap.end());
+        // One copy of the message is shared by all recipients.
+        const Mailbox::Event event { Mailbox::MESSAGE, std::make_shared<const Mailbox::Payload>(roomUser->UserId(), message) };
 
-        if (it != _roomMap.end()) {
-            for (RoomImpl* user : (*it).second) {
-                user->MessageReceived(roomUser->UserId(), message);
-            }
+        room->Lock.Lock();
+
+        room->History.Add(roomUser->UserId(), message);
+
+        for (auto& user : room->Users) {
+            user.second->Post(event);
         }
 
-        _adminLock.Unlock();
+        room->Lock.Unlock();
     }
 
     /* virtual */ void RoomMaintainer::Register(INotification* sink)
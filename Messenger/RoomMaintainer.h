@@ -21,6 +21,11 @@
 
 #include "Module.h"
 #include <interfaces/IMessenger.h>
+#include "Delivery.h"
+#include "MessageHistory.h"
+
+#include <memory>
+#include <unordered_map>
 
 namespace WPEFramework {
 
@@ -33,10 +38,27 @@ namespace Plugin {
         RoomMaintainer(const RoomMaintainer&) = delete;
         RoomMaintainer& operator=(const RoomMaintainer&) = delete;
 
+        // Users of one room. Each room has its own lock, so traffic in one room does not hold up
+        // the others; _adminLock only guards the map of rooms and is taken before a room lock.
+        struct Room {
+            Room(uint16_t historyDepth, uint32_t historySize)
+                : Users()
+                , History(historyDepth, historySize)
+                , Lock()
+            { /* empty */ }
+
+            std::unordered_map<string, RoomImpl*> Users;
+            MessageHistory History;
+            Core::CriticalSection Lock;
+        };
+
         RoomMaintainer()
             : _observers()
             , _roomMap()
             , _adminLock()
+            , _historyDepth(0)
+            , _historySize(0)
+            , _pool()
         { /* empty */}
 
         // IRoomAdministrator methods
@@ -49,6 +71,21 @@ namespace Plugin {
         void Send(const string& message, RoomImpl* roomUser);
         void Notify(RoomImpl* roomUser);
 
+        // Delivery settings, only effective before the first user joins. The history settings
+        // apply to rooms created afterwards; a depth of 0 keeps no history.
+        void Configure(uint8_t workers, uint16_t queueDepth, uint16_t historyDepth, uint32_t historySize)
+        {
+            _pool.Configure(workers, queueDepth);
+
+            _adminLock.Lock();
+            _historyDepth = historyDepth;
+            _historySize = historySize;
+            _adminLock.Unlock();
+        }
+
+        DeliveryPool::Statistics Statistics() const { return _pool.Stats(); }
+        DeliveryPool& Pool() { return _pool; }
+
         // QueryInterface implementation
         BEGIN_INTERFACE_MAP(RoomMaintainer)
             INTERFACE_ENTRY(Exchange::IRoomAdministrator)
@@ -56,8 +93,11 @@ namespace Plugin {
 
     private:
         std::list<INotification*> _observers;
-        std::map<string, std::list<RoomImpl*>> _roomMap;
+        std::unordered_map<string, std::shared_ptr<Room>> _roomMap;
         mutable Core::CriticalSection _adminLock;
+        uint16_t _historyDepth;
+        uint32_t _historySize;
+        DeliveryPool _pool;
     };
 
 } // namespace Plugin
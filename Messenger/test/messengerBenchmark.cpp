@@ -0,0 +1,232 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures message fan-out through the RoomMaintainer: a few threads keep sending to rooms with
+// hundreds of users, some of which consume slowly, and the time until every fast user has
+// received every message is reported together with the drop and slow consumer counters.
+//
+// Usage: messengerBenchmark [-u <users>] [-r <rooms>] [-m <messages>] [-t <senders>]
+//                           [-s <slow users>] [-d <slow delay us>] [-w <workers>] [-q <queue depth>]
+//                           [-h <history depth>]
+//   -u  users in total, spread over the rooms (default 500)
+//   -r  number of rooms (default 1)
+//   -m  messages sent per sender thread (default 200)
+//   -t  sender threads (default 4)
+//   -s  users that take -d microseconds per message (default 5)
+//   -d  delay of a slow user (default 10000)
+//   -w  delivery threads (default 2)
+//   -q  events queued per user before dropping (default 256)
+//   -h  messages kept per room for users joining later (default 0)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Module.h"
+#include "RoomMaintainer.h"
+
+using namespace WPEFramework;
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    class Sink : public Exchange::IRoomAdministrator::IRoom::IMsgNotification {
+    public:
+        Sink(const Sink&) = delete;
+        Sink& operator=(const Sink&) = delete;
+
+        Sink(std::atomic<uint64_t>& received, uint32_t delayUs)
+            : _received(received)
+            , _delayUs(delayUs)
+        { /* empty */ }
+
+        virtual void Message(const string& senderName, const string& message) override
+        {
+            if (_delayUs != 0) {
+                usleep(_delayUs);
+            }
+            _received++;
+        }
+
+        BEGIN_INTERFACE_MAP(Sink)
+            INTERFACE_ENTRY(Exchange::IRoomAdministrator::IRoom::IMsgNotification)
+        END_INTERFACE_MAP
+
+    private:
+        std::atomic<uint64_t>& _received;
+        uint32_t _delayUs;
+    };
+
+    double Milliseconds(const Clock::duration& duration)
+    {
+        return (std::chrono::duration<double, std::milli>(duration).count());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t users = 500;
+    uint32_t rooms = 1;
+    uint32_t messages = 200;
+    uint32_t senders = 4;
+    uint32_t slowUsers = 5;
+    uint32_t slowDelay = 10000;
+    uint32_t workers = 2;
+    uint32_t queueDepth = 256;
+    uint32_t historyDepth = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "u:r:m:t:s:d:w:q:h:")) != -1) {
+        switch (opt) {
+        case 'u': users = atoi(optarg); break;
+        case 'r': rooms = atoi(optarg); break;
+        case 'm': messages = atoi(optarg); break;
+        case 't': senders = atoi(optarg); break;
+        case 's': slowUsers = atoi(optarg); break;
+        case 'd': slowDelay = atoi(optarg); break;
+        case 'w': workers = atoi(optarg); break;
+        case 'q': queueDepth = atoi(optarg); break;
+        case 'h': historyDepth = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-u <users>] [-r <rooms>] [-m <messages>] [-t <senders>] [-s <slow users>] [-d <slow delay us>] [-w <workers>] [-q <queue depth>] [-h <history depth>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    rooms = std::max(rooms, 1u);
+    users = std::max(users, rooms);
+    senders = std::max(senders, 1u);
+    messages = std::max(messages, 1u);
+    slowUsers = std::min(slowUsers, users);
+
+    std::atomic<uint64_t> fastReceived(0);
+    std::atomic<uint64_t> slowReceived(0);
+
+    Plugin::RoomMaintainer* admin = Core::Service<Plugin::RoomMaintainer>::Create<Plugin::RoomMaintainer>();
+    admin->Configure(workers, queueDepth, historyDepth, 16384);
+
+    // Users are dealt out over the rooms; the slow ones come first, so each room gets its share.
+    std::vector<Exchange::IRoomAdministrator::IRoom*> members;
+    std::vector<uint32_t> fastPerRoom(rooms, 0);
+
+    for (uint32_t i = 0; i < users; i++) {
+        const uint32_t room = i % rooms;
+        const bool slow = (i < slowUsers);
+
+        Sink* sink = Core::Service<Sink>::Create<Sink>(slow ? slowReceived : fastReceived, slow ? slowDelay : 0);
+        members.push_back(admin->Join("room" + std::to_string(room), "user" + std::to_string(i), sink));
+        sink->Release();
+
+        if (slow == false) {
+            fastPerRoom[room]++;
+        }
+    }
+
+    // Every sender thread writes to all rooms in turn, through a different user each time.
+    uint64_t expected = 0;
+    for (uint32_t t = 0; t < senders; t++) {
+        for (uint32_t n = 0; n < messages; n++) {
+            expected += fastPerRoom[(t + n) % rooms];
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(senders);
+    std::vector<std::thread> threads;
+    const string message(64, 'x');
+
+    Clock::time_point start = Clock::now();
+
+    for (uint32_t t = 0; t < senders; t++) {
+        threads.emplace_back([&, t]() {
+            latencies[t].reserve(messages);
+            for (uint32_t n = 0; n < messages; n++) {
+                const uint32_t room = (t + n) % rooms;
+                const uint32_t inRoom = (users - room + rooms - 1) / rooms;
+                Exchange::IRoomAdministrator::IRoom* member = members[room + ((t * messages + n) % inRoom) * rooms];
+
+                Clock::time_point sent = Clock::now();
+                member->SendMessage(message);
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    Clock::time_point sent = Clock::now();
+
+    // Wait until the fast users have everything, or nothing has arrived for a second (their
+    // queues overflowed during the burst).
+    Clock::time_point delivered = Clock::now();
+    for (uint64_t last = 0; fastReceived.load() < expected; ) {
+        usleep(1000);
+        if (fastReceived.load() != last) {
+            last = fastReceived.load();
+            delivered = Clock::now();
+        }
+        else if ((Clock::now() - delivered) > std::chrono::seconds(1)) {
+            break;
+        }
+    }
+    if (fastReceived.load() == expected) {
+        delivered = Clock::now();
+    }
+
+    std::vector<double> all;
+    for (const auto& list : latencies) {
+        all.insert(all.end(), list.begin(), list.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    auto percentile = [&all](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+
+    Plugin::DeliveryPool::Statistics stats(admin->Statistics());
+
+    printf("users %u, rooms %u, slow users %u (%u us), workers %u, queue depth %u, history %u\n", users, rooms, slowUsers, slowDelay, workers, queueDepth, historyDepth);
+    printf("sent     %u messages in %8.2f ms, SendMessage us p50=%.1f p99=%.1f max=%.1f\n",
+        senders * messages, Milliseconds(sent - start), percentile(0.50), percentile(0.99), all.back());
+    printf("fanout   %llu/%llu deliveries to fast users in %8.2f ms, %.0f deliveries/s\n",
+        static_cast<unsigned long long>(fastReceived.load()), static_cast<unsigned long long>(expected),
+        Milliseconds(delivered - start), fastReceived.load() / (Milliseconds(delivered - start) / 1000.0));
+    printf("slow     %llu received, %llu dropped, %llu slow consumer episodes, max queue depth %u\n",
+        static_cast<unsigned long long>(slowReceived.load()), static_cast<unsigned long long>(stats.Dropped),
+        static_cast<unsigned long long>(stats.SlowConsumers), stats.MaxDepth);
+
+    for (Exchange::IRoomAdministrator::IRoom* member : members) {
+        if (member != nullptr) {
+            member->Release();
+        }
+    }
+
+    admin->Release();
+
+    Core::Singleton::Dispose();
+
+    return (fastReceived.load() == expected ? 0 : 1);
+}
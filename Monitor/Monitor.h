@@ -23,8 +23,11 @@
 #include "Module.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_Monitor.h>
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <time.h>
+#include <vector>
 
 static uint32_t gcd(uint32_t a, uint32_t b)
 {
@@ -61,6 +64,44 @@ namespace Plugin {
             Core::JSON::DecUInt8 Limit;
         };
 
+        class PredictionInfo : public Core::JSON::Container {
+        public:
+            PredictionInfo& operator=(const PredictionInfo&) = delete;
+
+            PredictionInfo()
+                : Core::JSON::Container()
+                , Horizon(0)
+                , Samples(12)
+                , IdleStart(0)
+                , IdleDuration(0)
+            {
+                Add(_T("horizon"), &Horizon);
+                Add(_T("samples"), &Samples);
+                Add(_T("idlestart"), &IdleStart);
+                Add(_T("idleduration"), &IdleDuration);
+            }
+            PredictionInfo(const PredictionInfo& copy)
+                : Core::JSON::Container()
+                , Horizon(copy.Horizon)
+                , Samples(copy.Samples)
+                , IdleStart(copy.IdleStart)
+                , IdleDuration(copy.IdleDuration)
+            {
+                Add(_T("horizon"), &Horizon);
+                Add(_T("samples"), &Samples);
+                Add(_T("idlestart"), &IdleStart);
+                Add(_T("idleduration"), &IdleDuration);
+            }
+            virtual ~PredictionInfo()
+            {
+            }
+
+            Core::JSON::DecUInt32 Horizon; // Restart if the memory limit is projected to be reached within this many seconds, 0 disables
+            Core::JSON::DecUInt16 Samples; // Minimum number of memory samples before a projection is made
+            Core::JSON::DecUInt16 IdleStart; // Start of the daily idle window, in minutes after local midnight
+            Core::JSON::DecUInt16 IdleDuration; // Length of the idle window in minutes, 0 allows a restart at any time
+        };
+
     public:
         class MetaData {
         public:
@@ -70,6 +111,9 @@ namespace Plugin {
                 , _shared()
                 , _process()
                 , _operational(false)
+                , _slope(0)
+                , _timeToLimit(0)
+                , _scheduled(false)
             {
             }
             MetaData(const MetaData& copy)
@@ -78,6 +122,9 @@ namespace Plugin {
                 , _shared(copy._shared)
                 , _process(copy._process)
                 , _operational(copy._operational)
+                , _slope(copy._slope)
+                , _timeToLimit(copy._timeToLimit)
+                , _scheduled(copy._scheduled)
             {
             }
             ~MetaData()
@@ -96,6 +143,12 @@ namespace Plugin {
             {
                 _operational = operational;
             }
+            void Prediction(const int64_t slope, const uint32_t timeToLimit, const bool scheduled)
+            {
+                _slope = slope;
+                _timeToLimit = timeToLimit;
+                _scheduled = scheduled;
+            }
             void Reset()
             {
                 _resident.Reset();
@@ -125,6 +178,21 @@ namespace Plugin {
             {
                 return (_operational);
             }
+            // Growth of the resident memory in bytes per second.
+            inline int64_t Slope() const
+            {
+                return (_slope);
+            }
+            // Seconds until the resident memory is projected to reach the limit, 0 if it is not growing.
+            inline uint32_t TimeToLimit() const
+            {
+                return (_timeToLimit);
+            }
+            // A restart is pending for the next idle window.
+            inline bool Scheduled() const
+            {
+                return (_scheduled);
+            }
 
         private:
             Core::MeasurementType<uint64_t> _resident;
@@ -132,6 +200,126 @@ namespace Plugin {
             Core::MeasurementType<uint64_t> _shared;
             Core::MeasurementType<uint8_t> _process;
             bool _operational;
+            int64_t _slope;
+            uint32_t _timeToLimit;
+            bool _scheduled;
+        };
+
+        // Fixed size ring of timestamped memory samples, the oldest sample is overwritten
+        // once it is full. Allows the growth of an observable to be inspected afterwards.
+        class History {
+        public:
+            struct Sample {
+                uint64_t Time;
+                uint64_t Resident;
+                uint64_t Allocated;
+                uint64_t Shared;
+            };
+
+        public:
+            History() = delete;
+            History& operator=(const History&) = delete;
+
+            History(const uint16_t size)
+                : _samples(size)
+                , _head(0)
+                , _count(0)
+            {
+            }
+            History(const History& copy)
+                : _samples(copy._samples)
+                , _head(copy._head)
+                , _count(copy._count)
+            {
+            }
+            ~History()
+            {
+            }
+
+        public:
+            void Add(const uint64_t time, const MetaData& measurement)
+            {
+                if (_samples.size() > 0) {
+                    Sample& entry(_samples[_head]);
+
+                    entry.Time = time;
+                    entry.Resident = measurement.Resident().Last();
+                    entry.Allocated = measurement.Allocated().Last();
+                    entry.Shared = measurement.Shared().Last();
+
+                    _head = static_cast<uint16_t>((_head + 1) % _samples.size());
+
+                    if (_count < _samples.size()) {
+                        _count++;
+                    }
+                }
+            }
+            void Reset()
+            {
+                _head = 0;
+                _count = 0;
+            }
+            inline uint16_t Count() const
+            {
+                return (_count);
+            }
+            // Index 0 is the oldest sample.
+            inline const Sample& operator[](const uint16_t index) const
+            {
+                ASSERT(index < _count);
+
+                return (_samples[(_head + _samples.size() - _count + index) % _samples.size()]);
+            }
+            // Least squares fit of the resident memory against time over the samples taken at or
+            // after "since". Returns the slope (bytes per second) and the fitted value at the last sample.
+            bool Fit(const uint64_t since, const uint16_t minimum, double& slope, double& level) const
+            {
+                uint16_t first = 0;
+
+                while ((first < _count) && ((*this)[first].Time < since)) {
+                    first++;
+                }
+
+                uint16_t count = _count - first;
+
+                if ((count < 2) || (count < minimum)) {
+                    return (false);
+                }
+
+                // Center both axes on their mean to keep the sums small.
+                const uint64_t base = (*this)[first].Time;
+                double meanTime = 0, meanResident = 0;
+
+                for (uint16_t index = first; index < _count; index++) {
+                    meanTime += static_cast<double>((*this)[index].Time - base) / 1000000.0;
+                    meanResident += static_cast<double>((*this)[index].Resident);
+                }
+                meanTime /= count;
+                meanResident /= count;
+
+                double covariance = 0, variance = 0;
+
+                for (uint16_t index = first; index < _count; index++) {
+                    double time = (static_cast<double>((*this)[index].Time - base) / 1000000.0) - meanTime;
+
+                    covariance += time * (static_cast<double>((*this)[index].Resident) - meanResident);
+                    variance += time * time;
+                }
+
+                if (variance <= 0) {
+                    return (false);
+                }
+
+                slope = covariance / variance;
+                level = meanResident + (slope * ((static_cast<double>((*this)[_count - 1].Time - base) / 1000000.0) - meanTime));
+
+                return (true);
+            }
+
+        private:
+            std::vector<Sample> _samples;
+            uint16_t _head;
+            uint16_t _count;
         };
 
         class Data : public Core::JSON::Container {
@@ -230,6 +418,53 @@ namespace Plugin {
                     Core::JSON::DecUInt64 Last;
                 };
 
+                class Prediction : public Core::JSON::Container {
+                public:
+                    Prediction()
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("slope"), &Slope);
+                        Add(_T("timetolimit"), &TimeToLimit);
+                        Add(_T("scheduled"), &Scheduled);
+                    }
+                    Prediction(const Prediction& copy)
+                        : Core::JSON::Container()
+                        , Slope(copy.Slope)
+                        , TimeToLimit(copy.TimeToLimit)
+                        , Scheduled(copy.Scheduled)
+                    {
+                        Add(_T("slope"), &Slope);
+                        Add(_T("timetolimit"), &TimeToLimit);
+                        Add(_T("scheduled"), &Scheduled);
+                    }
+                    ~Prediction()
+                    {
+                    }
+
+                public:
+                    Prediction& operator=(const Prediction& RHS)
+                    {
+                        Slope = RHS.Slope;
+                        TimeToLimit = RHS.TimeToLimit;
+                        Scheduled = RHS.Scheduled;
+
+                        return (*this);
+                    }
+                    Prediction& operator=(const Monitor::MetaData& RHS)
+                    {
+                        Slope = RHS.Slope();
+                        TimeToLimit = RHS.TimeToLimit();
+                        Scheduled = RHS.Scheduled();
+
+                        return (*this);
+                    }
+
+                public:
+                    Core::JSON::DecSInt64 Slope; // Resident memory growth in bytes per second
+                    Core::JSON::DecUInt32 TimeToLimit; // Seconds until the memory limit is reached, 0 if not growing
+                    Core::JSON::Boolean Scheduled; // A restart is pending for the next idle window
+                };
+
             public:
                 MetaData()
                     : Core::JSON::Container()
@@ -239,6 +474,7 @@ namespace Plugin {
                     , Process()
                     , Operational()
                     , Count()
+                    , Forecast()
                 {
                     Add(_T("allocated"), &Allocated);
                     Add(_T("resident"), &Resident);
@@ -246,6 +482,7 @@ namespace Plugin {
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
+                    Add(_T("prediction"), &Forecast);
                 }
                 MetaData(const Monitor::MetaData& input)
                     : Core::JSON::Container()
@@ -256,6 +493,7 @@ namespace Plugin {
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
+                    Add(_T("prediction"), &Forecast);
 
                     Allocated = input.Allocated();
                     Resident = input.Resident();
@@ -263,6 +501,7 @@ namespace Plugin {
                     Process = input.Process();
                     Operational = input.Operational();
                     Count = input.Allocated().Measurements();
+                    Forecast = input;
                 }
                 MetaData(const MetaData& copy)
                     : Core::JSON::Container()
@@ -272,6 +511,7 @@ namespace Plugin {
                     , Process(copy.Process)
                     , Operational(copy.Operational)
                     , Count(copy.Count)
+                    , Forecast(copy.Forecast)
                 {
                     Add(_T("allocated"), &Allocated);
                     Add(_T("resident"), &Resident);
@@ -279,6 +519,7 @@ namespace Plugin {
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
+                    Add(_T("prediction"), &Forecast);
                 }
                 ~MetaData()
                 {
@@ -292,6 +533,7 @@ namespace Plugin {
                     Process = RHS.Process;
                     Operational = RHS.Operational;
                     Count = RHS.Count;
+                    Forecast = RHS.Forecast;
 
                     return (*this);
                 }
@@ -303,6 +545,7 @@ namespace Plugin {
                     Process = RHS.Process();
                     Operational = RHS.Operational();
                     Count = RHS.Allocated().Measurements();
+                    Forecast = RHS;
 
                     return (*this);
                 }
@@ -314,6 +557,7 @@ namespace Plugin {
                 Measurement Process;
                 Core::JSON::Boolean Operational;
                 Core::JSON::DecUInt32 Count;
+                Prediction Forecast;
             };
 
         private:
@@ -370,6 +614,157 @@ namespace Plugin {
             RestartInfo Restart;
         };
 
+        class HistoryParams : public Core::JSON::Container {
+        public:
+            HistoryParams(const HistoryParams&) = delete;
+            HistoryParams& operator=(const HistoryParams&) = delete;
+
+            HistoryParams()
+                : Core::JSON::Container()
+                , Callsign()
+                , Points(60)
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("points"), &Points);
+            }
+            ~HistoryParams()
+            {
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt16 Points; // Maximum number of samples returned, 0 returns all of them
+        };
+
+        class HistoryData : public Core::JSON::Container {
+        public:
+            class Sample : public Core::JSON::Container {
+            public:
+                Sample& operator=(const Sample&) = delete;
+
+                Sample()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("timestamp"), &Timestamp);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                }
+                Sample(const Sample& copy)
+                    : Core::JSON::Container()
+                    , Timestamp(copy.Timestamp)
+                    , Resident(copy.Resident)
+                    , Allocated(copy.Allocated)
+                    , Shared(copy.Shared)
+                {
+                    Add(_T("timestamp"), &Timestamp);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                }
+                ~Sample()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt64 Timestamp; // Milliseconds since the epoch
+                Core::JSON::DecUInt64 Resident;
+                Core::JSON::DecUInt64 Allocated;
+                Core::JSON::DecUInt64 Shared;
+            };
+
+            class Percentiles : public Core::JSON::Container {
+            public:
+                Percentiles& operator=(const Percentiles&) = delete;
+
+                Percentiles()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                }
+                Percentiles(const Percentiles& copy)
+                    : Core::JSON::Container()
+                    , P50(copy.P50)
+                    , P95(copy.P95)
+                    , P99(copy.P99)
+                {
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                }
+                ~Percentiles()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt64 P50;
+                Core::JSON::DecUInt64 P95;
+                Core::JSON::DecUInt64 P99;
+            };
+
+        public:
+            HistoryData(const HistoryData&) = delete;
+            HistoryData& operator=(const HistoryData&) = delete;
+
+            HistoryData()
+                : Core::JSON::Container()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("count"), &Count);
+                Add(_T("samples"), &Samples);
+                Add(_T("resident"), &Resident);
+                Add(_T("allocated"), &Allocated);
+                Add(_T("shared"), &Shared);
+                Add(_T("prediction"), &Forecast);
+            }
+            ~HistoryData()
+            {
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt16 Count; // Number of samples recorded, before downsampling
+            Core::JSON::ArrayType<Sample> Samples;
+            Percentiles Resident;
+            Percentiles Allocated;
+            Percentiles Shared;
+            Data::MetaData::Prediction Forecast;
+        };
+
+        // Result of status and resetstats: the generated InfoInfo plus the prediction, which is not
+        // part of the generated interface
+        class StatusData : public JsonData::Monitor::InfoInfo {
+        public:
+            StatusData()
+                : JsonData::Monitor::InfoInfo()
+                , Forecast()
+            {
+                Add(_T("prediction"), &Forecast);
+            }
+            StatusData(const StatusData& copy)
+                : JsonData::Monitor::InfoInfo(copy)
+                , Forecast(copy.Forecast)
+            {
+                Add(_T("prediction"), &Forecast);
+            }
+            ~StatusData()
+            {
+            }
+
+            StatusData& operator=(const StatusData& RHS)
+            {
+                JsonData::Monitor::InfoInfo::operator=(RHS);
+                Forecast = RHS.Forecast;
+
+                return (*this);
+            }
+
+        public:
+            Data::MetaData::Prediction Forecast;
+        };
+
     private:
         Monitor(const Monitor&);
         Monitor& operator=(const Monitor&);
@@ -393,6 +788,7 @@ namespace Plugin {
                     Add(_T("memorylimit"), &MetaDataLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("prediction"), &Prediction);
                 }
                 Entry(const Entry& copy)
                     : Core::JSON::Container()
@@ -401,12 +797,14 @@ namespace Plugin {
                     , MetaDataLimit(copy.MetaDataLimit)
                     , Operational(copy.Operational)
                     , Restart(copy.Restart)
+                    , Prediction(copy.Prediction)
                 {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("prediction"), &Prediction);
                 }
                 ~Entry()
                 {
@@ -418,13 +816,16 @@ namespace Plugin {
                 Core::JSON::DecUInt32 MetaDataLimit;
                 Core::JSON::DecSInt32 Operational;
                 RestartInfo Restart;
+                PredictionInfo Prediction;
             };
 
         public:
             Config()
                 : Core::JSON::Container()
+                , History(720)
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("history"), &History);
             }
             ~Config()
             {
@@ -432,6 +833,7 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            Core::JSON::DecUInt16 History; // Memory samples kept per observable
         };
 
         class MonitorObjects : public PluginHost::IPlugin::INotification {
@@ -450,7 +852,8 @@ namespace Plugin {
                 enum evaluation {
                     SUCCESFULL = 0x00,
                     NOT_OPERATIONAL = 0x01,
-                    EXCEEDED_MEMORY = 0x02
+                    EXCEEDED_MEMORY = 0x02,
+                    PREDICTED_MEMORY = 0x04
                 };
 
                 typedef struct {
@@ -466,7 +869,9 @@ namespace Plugin {
                     const uint64_t memoryThreshold,
                     const uint64_t absTime,
                     const uint16_t restartWindow,
-                    const uint8_t restartLimit)
+                    const uint8_t restartLimit,
+                    const uint16_t historySize,
+                    const PredictionInfo& prediction)
                     : _operationalInterval(operationalInterval)
                     , _memoryInterval(memoryInterval)
                     , _memoryThreshold(memoryThreshold * 1024)
@@ -478,6 +883,12 @@ namespace Plugin {
                     , _restartCount(0)
                     , _restartLimit(restartLimit)
                     , _measurement()
+                    , _history(historySize)
+                    , _horizon(prediction.Horizon.Value())
+                    , _minimumSamples(prediction.Samples.Value())
+                    , _idleStart(prediction.IdleStart.Value() % (24 * 60))
+                    , _idleDuration(prediction.IdleDuration.Value())
+                    , _fitStart(0)
                     , _operationalEvaluate(actOnOperational)
                     , _source(nullptr)
                     , _active{ false }
@@ -497,6 +908,12 @@ namespace Plugin {
                     , _restartCount(copy._restartCount)
                     , _restartLimit(copy._restartLimit)
                     , _measurement(copy._measurement)
+                    , _history(copy._history)
+                    , _horizon(copy._horizon)
+                    , _minimumSamples(copy._minimumSamples)
+                    , _idleStart(copy._idleStart)
+                    , _idleDuration(copy._idleDuration)
+                    , _fitStart(copy._fitStart)
                     , _operationalEvaluate(copy._operationalEvaluate)
                     , _source(copy._source)
                     , _interval(copy._interval)
@@ -562,6 +979,10 @@ namespace Plugin {
                 {
                     return (_measurement);
                 }
+                inline const History& Recorded() const
+                {
+                    return (_history);
+                }
                 inline bool HasMeasurement() const
                 {
                     return (((_measurement.Allocated().Min() == Core::NumberType<uint64_t>::Max()) && 
@@ -574,6 +995,7 @@ namespace Plugin {
                 inline void Reset()
                 {
                     _measurement.Reset();
+                    _history.Reset();
                 }
                 inline void Retrigger(uint64_t currentSlot)
                 {
@@ -591,6 +1013,10 @@ namespace Plugin {
                     if (memory != nullptr) {
                         _source = memory;
                         _source->AddRef();
+
+                        // A new process, do not project its memory from that of its predecessor.
+                        _fitStart = Core::Time::Now().Ticks();
+                        _measurement.Prediction(0, 0, false);
                     }
 
                     _measurement.Operational(_source != nullptr);
@@ -613,10 +1039,14 @@ namespace Plugin {
                         }
                         if ((_memoryInterval != 0) && (_memorySlots == 0)) {
                             _measurement.Measure(_source);
+                            _history.Add(Core::Time::Now().Ticks(), _measurement);
 
                             if ((_memoryThreshold != 0) && (_measurement.Resident().Last() > _memoryThreshold)) {
                                 status |= EXCEEDED_MEMORY;
                                 TRACE_L1("Status MetaData Exceeded. %d", __LINE__);
+                            } else if (Predict() == true) {
+                                status |= PREDICTED_MEMORY;
+                                TRACE_L1("Status MetaData Predicted to exceed. %d", __LINE__);
                             }
                             _memorySlots = _memoryInterval;
                         }
@@ -627,6 +1057,54 @@ namespace Plugin {
                 bool IsActive() const { return _active; }
                 void Active(bool active) { _active = active; }
 
+            private:
+                // Projects the resident memory onto the limit. Returns true if the limit will be reached within
+                // the horizon and we are in the idle window, so a restart now is the least disruptive.
+                bool Predict()
+                {
+                    bool restart = false;
+                    int64_t slope = 0;
+                    uint32_t timeToLimit = 0;
+                    bool scheduled = false;
+                    double rate, level;
+
+                    if ((_horizon != 0) && (_memoryThreshold != 0) && (_history.Fit(_fitStart, _minimumSamples, rate, level) == true)) {
+                        slope = static_cast<int64_t>(rate);
+
+                        if (rate > 0) {
+                            double remaining = (static_cast<double>(_memoryThreshold) - level) / rate;
+
+                            timeToLimit = (remaining <= 0 ? 0 : (remaining >= std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(remaining)));
+
+                            if ((timeToLimit < _horizon) && (HasRestartAllowed() == true)) {
+                                scheduled = true;
+                                restart = IsIdle();
+                            }
+                        }
+                    }
+
+                    _measurement.Prediction(slope, timeToLimit, scheduled);
+
+                    return (restart);
+                }
+                bool IsIdle() const
+                {
+                    bool idle = (_idleDuration == 0);
+
+                    if (idle == false) {
+                        time_t now = ::time(nullptr);
+                        struct tm local;
+
+                        if (::localtime_r(&now, &local) != nullptr) {
+                            uint16_t minutes = static_cast<uint16_t>((local.tm_hour * 60) + local.tm_min);
+
+                            idle = (((minutes + (24 * 60) - _idleStart) % (24 * 60)) < _idleDuration);
+                        }
+                    }
+
+                    return (idle);
+                }
+
             private:
                 const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
                 const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
@@ -639,6 +1117,12 @@ namespace Plugin {
                 uint32_t _restartCount;
                 uint8_t _restartLimit;
                 MetaData _measurement;
+                History _history;
+                const uint32_t _horizon; //!< Seconds, restart if the limit is projected to be reached within.
+                const uint16_t _minimumSamples;
+                const uint16_t _idleStart; //!< Minutes after local midnight.
+                const uint16_t _idleDuration; //!< Minutes, 0 means always idle.
+                uint64_t _fitStart; //!< Only samples of the current process are used for the projection.
                 bool _operationalEvaluate;
                 Exchange::IMemory* _source;
                 uint32_t _interval; //!< The greatest possible interval to check both memory and processes.
@@ -686,7 +1170,7 @@ namespace Plugin {
 
                 _adminLock.Unlock();
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
+            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index, const uint16_t historySize)
             {
                 ASSERT((service != nullptr) && (_service == nullptr));
 
@@ -721,7 +1205,9 @@ namespace Plugin {
                                 memoryThreshold, 
                                 baseTime, 
                                 restartWindow, 
-                                restartLimit)));
+                                restartLimit,
+                                historySize,
+                                element.Prediction)));
                     }
                 }
 
@@ -834,13 +1320,13 @@ namespace Plugin {
                 return (found);
             }
 
-            void Snapshot(const string& callsign, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>* response)
+            void Snapshot(const string& callsign, Core::JSON::ArrayType<Monitor::StatusData>* response)
             {
                 _adminLock.Lock();
 
                 auto AddElement = [this, &response](const string& callsign, MonitorObject& object) {
                     const MetaData& metaData = object.Measurement();
-                    JsonData::Monitor::InfoInfo info;
+                    Monitor::StatusData info;
                     info.Observable = callsign;
 
                     if (object.HasRestartAllowed()) {
@@ -854,6 +1340,7 @@ namespace Plugin {
                     translate(metaData.Process(), &info.Measurements.Process);
                     info.Measurements.Operational = metaData.Operational();
                     info.Measurements.Count = metaData.Allocated().Measurements();
+                    info.Forecast = metaData;
 
                     response->Add(info);
                 };
@@ -876,6 +1363,72 @@ namespace Plugin {
                 _adminLock.Unlock();
             }
 
+            bool Series(const string& name, const uint16_t points, Monitor::HistoryData& response)
+            {
+                std::vector<History::Sample> samples;
+
+                _adminLock.Lock();
+
+                std::map<string, MonitorObject>::iterator index(_monitor.find(name));
+
+                if (index != _monitor.end()) {
+                    const History& history(index->second.Recorded());
+
+                    response.Forecast = index->second.Measurement();
+
+                    samples.reserve(history.Count());
+
+                    for (uint16_t sample = 0; sample < history.Count(); sample++) {
+                        samples.push_back(history[sample]);
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                if (index == _monitor.end()) {
+                    return (false);
+                }
+
+                response.Callsign = name;
+                response.Count = static_cast<uint16_t>(samples.size());
+
+                if (samples.empty() == false) {
+                    // Downsample by averaging equally sized buckets, the timestamp of a bucket is that of its last sample.
+                    uint32_t buckets = (((points == 0) || (points > samples.size())) ? static_cast<uint32_t>(samples.size()) : points);
+                    uint32_t start = 0;
+
+                    for (uint32_t bucket = 0; bucket < buckets; bucket++) {
+                        uint32_t end = static_cast<uint32_t>(((bucket + 1) * samples.size()) / buckets);
+                        uint64_t resident = 0, allocated = 0, shared = 0;
+
+                        for (uint32_t sample = start; sample < end; sample++) {
+                            resident += samples[sample].Resident;
+                            allocated += samples[sample].Allocated;
+                            shared += samples[sample].Shared;
+                        }
+
+                        HistoryData::Sample& element(response.Samples.Add());
+                        element.Timestamp = samples[end - 1].Time / 1000; // Move from MicroSeconds to MilliSeconds
+                        element.Resident = resident / (end - start);
+                        element.Allocated = allocated / (end - start);
+                        element.Shared = shared / (end - start);
+
+                        start = end;
+                    }
+
+                    std::vector<uint64_t> values(samples.size());
+
+                    std::transform(samples.begin(), samples.end(), values.begin(), [](const History::Sample& entry) { return (entry.Resident); });
+                    percentiles(values, response.Resident);
+                    std::transform(samples.begin(), samples.end(), values.begin(), [](const History::Sample& entry) { return (entry.Allocated); });
+                    percentiles(values, response.Allocated);
+                    std::transform(samples.begin(), samples.end(), values.begin(), [](const History::Sample& entry) { return (entry.Shared); });
+                    percentiles(values, response.Shared);
+                }
+
+                return (true);
+            }
+
             bool Reset(const string& name, Monitor::MetaData& result)
             {
                 bool found = false;
@@ -940,18 +1493,20 @@ namespace Plugin {
                     if (info.TimeSlot() <= scheduledTime) {
                         uint32_t value(info.Evaluate());
 
-                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY)) != 0) {
+                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::PREDICTED_MEMORY)) != 0) {
                             PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(index->first));
 
                             if (plugin != nullptr) {
-                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                                // A predicted exhaustion is handled as exceeded memory, so the regular restart policy brings it back.
+                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::PREDICTED_MEMORY)) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                                const string reason(((value & MonitorObject::PREDICTED_MEMORY) != 0) ? _T("MemoryPredicted") : why.Data());
 
-                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
-                                SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + reason + "\" }");
+                                SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), reason.c_str()));
 
                                 _service->Notify(message);
 
-                                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+                                _parent.event_action(plugin->Callsign(), "Deactivate", reason);
 
                                 Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
 
@@ -990,6 +1545,20 @@ namespace Plugin {
                 to->Last = from.Last();
             }
 
+            // Nearest rank percentiles, reorders the values.
+            static void percentiles(std::vector<uint64_t>& values, HistoryData::Percentiles& to)
+            {
+                auto rank = [&values](const uint8_t percentile) -> uint64_t {
+                    std::vector<uint64_t>::iterator nth(values.begin() + (((values.size() * percentile) + 99) / 100) - 1);
+                    std::nth_element(values.begin(), nth, values.end());
+                    return (*nth);
+                };
+
+                to.P50 = rank(50);
+                to.P95 = rank(95);
+                to.P99 = rank(99);
+            }
+
             Core::CriticalSection _adminLock;
             std::map<string, MonitorObject> _monitor;
             Core::WorkerPool::JobType<MonitorObjects&> _job;
@@ -1069,8 +1638,9 @@ namespace Plugin {
         void RegisterAll();
         void UnregisterAll();
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
-        uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
-        uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, StatusData& response);
+        uint32_t get_status(const string& index, Core::JSON::ArrayType<StatusData>& response) const;
+        uint32_t endpoint_history(const HistoryParams& params, HistoryData& response);
         void event_action(const string& callsign, const string& action, const string& reason);
     };
 }
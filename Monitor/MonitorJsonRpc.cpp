@@ -33,8 +33,9 @@ namespace Plugin {
     void Monitor::RegisterAll()
     {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
-        Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
-        Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Register<ResetstatsParamsData,StatusData>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
+        Register<HistoryParams,HistoryData>(_T("history"), &Monitor::endpoint_history, this);
+        Property<Core::JSON::ArrayType<StatusData>>(_T("status"), &Monitor::get_status, nullptr, this);
     }
 
     void Monitor::UnregisterAll()
@@ -42,6 +43,7 @@ namespace Plugin {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
         Unregister(_T("status"));
+        Unregister(_T("history"));
     }
 
     // API implementation
@@ -62,11 +64,11 @@ namespace Plugin {
     // Method: resetstats - Resets memory and process statistics for a single plugin watched by the Monitor
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t Monitor::endpoint_resetstats(const ResetstatsParamsData& params, InfoInfo& response)
+    uint32_t Monitor::endpoint_resetstats(const ResetstatsParamsData& params, StatusData& response)
     {
         const string& callsign = params.Callsign.Value();
 
-        Core::JSON::ArrayType<InfoInfo> info;
+        Core::JSON::ArrayType<StatusData> info;
         _monitor->Snapshot(callsign, &info);
         if (info.Length() == 1) {
             _monitor->Reset(callsign);
@@ -78,13 +80,28 @@ namespace Plugin {
     // Property: status - The memory and process statistics either for a single plugin or all plugins watched by the Monitor
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t Monitor::get_status(const string& index, Core::JSON::ArrayType<InfoInfo>& response) const
+    uint32_t Monitor::get_status(const string& index, Core::JSON::ArrayType<StatusData>& response) const
     {
         const string& callsign = index;
         _monitor->Snapshot(callsign, &response);
         return Core::ERROR_NONE;
     }
 
+    // Method: history - Memory samples recorded for a plugin watched by the Monitor, downsampled to
+    //         at most the requested number of points, with the p50/p95/p99 over all recorded samples
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: The plugin is not watched by the Monitor
+    uint32_t Monitor::endpoint_history(const HistoryParams& params, HistoryData& response)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_KEY;
+
+        if (_monitor->Series(params.Callsign.Value(), params.Points.Value(), response) == true) {
+            result = Core::ERROR_NONE;
+        }
+        return result;
+    }
+
     // Event: action - Signals action taken by the monitor
     void Monitor::event_action(const string& callsign, const string& action, const string& reason)
     {
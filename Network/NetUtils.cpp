@@ -20,11 +20,11 @@
 #include "NetUtils.h"
 #include <string.h>
 #include "Network.h"
+#include "executor.h"
 
 //Defines
 
 #define NETUTIL_DEVICE_PROPERTIES_FILE          "/etc/device.properties"
-#define COMMAND_RESULT_FILE "cmdresult"
 
 
 namespace WPEFramework {
@@ -88,9 +88,6 @@ namespace WPEFramework {
         int NetUtils::execCmd(const char *command, std::string &output, bool *result, const char *outputfile)
         {
             std::string commandString;
-            std::string resultFile;
-            char buffer[MAX_OUTPUT_LENGTH];
-            FILE *pipe = NULL;
             size_t length = 0;
 
             output.clear();
@@ -105,32 +102,23 @@ namespace WPEFramework {
                 commandString += output;
             }
 
-            // If we have requested a result, store the result of the command in /tmp/cmdresult
-            if (result)
+            // The exit status comes straight from the shell, no result file needed
+            Utils::Exec::Result execResult = Utils::Exec::run(Utils::Exec::shell(commandString));
+            if (execResult.status < 0)
             {
-                getTmpFilename(COMMAND_RESULT_FILE, resultFile); //append a count to get a unique filename
-                commandString += "; echo $? > ";
-                commandString += resultFile;
+                // Not started or killed, whatever it printed before is still returned
+                LOGERR("%s: '%s' did not exit normally", __FUNCTION__, commandString.c_str());
             }
-
-            pipe = popen(commandString.c_str(), "r");
-            if (pipe == NULL)
+            else
             {
-                LOGERR("%s: failed to open file '%s' for read mode with result: %s", __FUNCTION__,
-                        commandString.c_str(), strerror(errno));
-                return -1;
+                LOGWARN("%s: ran '%s' with exit status %d", __FUNCTION__,
+                        commandString.c_str(), execResult.status);
             }
 
-            LOGWARN("%s: opened file '%s' for read mode", __FUNCTION__,
-                    commandString.c_str());
-
-            while (!feof(pipe) && fgets(buffer, MAX_OUTPUT_LENGTH, pipe) != NULL)
+            // If we are not dumping it to file, store the output
+            if (!outputfile)
             {
-                // If we are not dumping it to file, store the output
-                if (!outputfile)
-                {
-                    output += buffer;
-                }
+                output = execResult.output;
             }
 
             // Strip trailing line feed from the output
@@ -142,22 +130,13 @@ namespace WPEFramework {
                 }
             }
 
-            // If we have requested a result, query the contents of the result file
             if (result)
             {
-                std::string commandResult = "1";
-                if (!getFile(resultFile.c_str(), commandResult, true)) //delete file after reading
-                {
-                    LOGERR("%s: failed to get command result '%s'", __FUNCTION__,resultFile.c_str());
-                }
-                else
-                {
-                    *result =  (commandResult == "0");
-                    LOGINFO("%s: command result '%s'", __FUNCTION__,((*result)?"true":"false"));
-                }
+                *result = (0 == execResult.status);
+                LOGINFO("%s: command result '%s'", __FUNCTION__,((*result)?"true":"false"));
             }
 
-            return pclose(pipe);
+            return execResult.status;
         }
 
         /*
@@ -23,6 +23,11 @@ const string WPEFramework::Plugin::PersistentStore::METHOD_DELETE_NAMESPACE = "d
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_KEYS = "getKeys";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_NAMESPACES = "getNamespaces";
 const string WPEFramework::Plugin::PersistentStore::METHOD_GET_STORAGE_SIZE = "getStorageSize";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_CACHE_STATS = "getCacheStats";
+const string WPEFramework::Plugin::PersistentStore::METHOD_SET_ITEMS = "setItems";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_ITEMS = "getItems";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_ALL = "getAll";
+const string WPEFramework::Plugin::PersistentStore::METHOD_GET_VACUUM_STATS = "getVacuumStats";
 const string WPEFramework::Plugin::PersistentStore::EVT_ON_STORAGE_EXCEEDED = "onStorageExceeded";
 const char* WPEFramework::Plugin::PersistentStore::STORE_NAME = "rdkservicestore";
 const char* WPEFramework::Plugin::PersistentStore::STORE_KEY = "xyzzy123";
@@ -70,6 +75,26 @@ namespace WPEFramework {
         PersistentStore::PersistentStore()
             : AbstractPlugin()
             , mData(nullptr)
+            , mSize(0)
+            , mWriteBehind(false)
+            , mFlushInterval(0)
+            , mInTransaction(false)
+            , mTimer(64 * 1024, "PersistentStoreTimer")
+            , mFlushInfo(this, StoreTimerInfo::FLUSH)
+            , mCacheSize(0)
+            , mCacheHits(0)
+            , mCacheMisses(0)
+            , mWal(false)
+            , mCheckpointInterval(0)
+            , mCheckpointStop(false)
+            , mVacuumInfo(this, StoreTimerInfo::VACUUM)
+            , mVacuumInterval(0)
+            , mVacuumPages(0)
+            , mVacuumRatio(0)
+            , mVacuumConvert(false)
+            , mVacuumRuns(0)
+            , mVacuumPagesReclaimed(0)
+            , mVacuumTimeUs(0)
         {
             LOGINFO("ctor");
             PersistentStore::_instance = this;
@@ -80,6 +105,11 @@ namespace WPEFramework {
             registerMethod(METHOD_GET_KEYS, &PersistentStore::getKeysWrapper, this);
             registerMethod(METHOD_GET_NAMESPACES, &PersistentStore::getNamespacesWrapper, this);
             registerMethod(METHOD_GET_STORAGE_SIZE, &PersistentStore::getStorageSizeWrapper, this);
+            registerMethod(METHOD_GET_CACHE_STATS, &PersistentStore::getCacheStatsWrapper, this);
+            registerMethod(METHOD_SET_ITEMS, &PersistentStore::setItemsWrapper, this);
+            registerMethod(METHOD_GET_ITEMS, &PersistentStore::getItemsWrapper, this);
+            registerMethod(METHOD_GET_ALL, &PersistentStore::getAllWrapper, this);
+            registerMethod(METHOD_GET_VACUUM_STATS, &PersistentStore::getVacuumStatsWrapper, this);
         }
 
         PersistentStore::~PersistentStore()
@@ -87,20 +117,57 @@ namespace WPEFramework {
             LOGINFO("dtor");
             PersistentStore::_instance = nullptr;
 
+            stopCheckpointThread();
+            mTimer.Revoke(mFlushInfo);
+            mTimer.Revoke(mVacuumInfo);
             term();
         }
 
-        const string PersistentStore::Initialize(PluginHost::IShell* /* service */)
+        const string PersistentStore::Initialize(PluginHost::IShell* service)
         {
             LOGINFO();
 
-            auto path = g_build_filename("opt", "persistent", nullptr);
-            if (!fileExists(path))
-                g_mkdir_with_parents(path, 0745);
-            auto file = g_build_filename(path, STORE_NAME, nullptr);
-            bool success = init(file, STORE_KEY);
-            g_free(path);
-            g_free(file);
+            Config config;
+            config.FromString(service->ConfigLine());
+            mWriteBehind = config.WriteBehind.Value();
+            mFlushInterval = config.FlushInterval.Value();
+            mCacheSize = config.CacheSize.Value();
+            LOGINFO("write-behind %d, flush interval %u ms, cache size %u", mWriteBehind, mFlushInterval, mCacheSize);
+
+            mWal = config.Wal.Value();
+            mCheckpointInterval = mWal ? config.CheckpointInterval.Value() : 0;
+            mSynchronous = config.Synchronous.Value();
+            Utils::String::toLower(mSynchronous);
+            if (!mSynchronous.empty() && mSynchronous != "off" && mSynchronous != "normal" && mSynchronous != "full" && mSynchronous != "extra")
+            {
+                LOGWARN("unknown synchronous level '%s', using the default", mSynchronous.c_str());
+                mSynchronous.clear();
+            }
+            LOGINFO("wal %d, synchronous '%s', checkpoint interval %u ms", mWal, mSynchronous.c_str(), mCheckpointInterval);
+
+            mVacuumInterval = config.VacuumInterval.Value();
+            mVacuumPages = config.VacuumPages.Value();
+            mVacuumRatio = config.VacuumRatio.Value();
+            LOGINFO("vacuum interval %u ms, %u pages, %u%% free", mVacuumInterval, mVacuumPages, mVacuumRatio);
+
+            bool success;
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+
+                auto path = g_build_filename("opt", "persistent", nullptr);
+                if (!fileExists(path))
+                    g_mkdir_with_parents(path, 0745);
+                auto file = g_build_filename(path, STORE_NAME, nullptr);
+                success = init(file, STORE_KEY);
+                g_free(path);
+                g_free(file);
+            }
+
+            if (success && mCheckpointInterval > 0)
+                startCheckpointThread();
+
+            if (success && mVacuumInterval > 0)
+                mTimer.Schedule(Core::Time::Now().Add(mVacuumInterval), mVacuumInfo);
 
             return success ? "" : "init failed";
         }
@@ -109,6 +176,11 @@ namespace WPEFramework {
         {
             LOGINFO();
 
+            stopCheckpointThread();
+            mTimer.Revoke(mFlushInfo);
+            mTimer.Revoke(mVacuumInfo);
+
+            std::lock_guard<std::mutex> lock(mLock);
             term();
         }
 
@@ -285,109 +357,268 @@ namespace WPEFramework {
             returnResponse(success);
         }
 
-        bool PersistentStore::setValue(const string& ns, const string& key, const string& value)
+        uint32_t PersistentStore::getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response)
         {
-            LOGINFO("%s %s %s", ns.c_str(), key.c_str(), value.c_str());
+            LOGINFOMETHOD();
 
-            bool success = false;
+            std::lock_guard<std::mutex> lock(mLock);
 
-            sqlite3* &db = SQLITE;
+            JsonObject jsonNamespaceEntries;
+            for (auto it = mCache.begin(); it != mCache.end(); ++it)
+                jsonNamespaceEntries[it->first.c_str()] = (uint64_t)it->second.items.size();
 
-            if (db)
+            response["hits"] = mCacheHits;
+            response["misses"] = mCacheMisses;
+            response["capacity"] = mCacheSize;
+            response["namespaceEntries"] = jsonNamespaceEntries;
+
+            returnResponse(true);
+        }
+
+        uint32_t PersistentStore::setItemsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            if (!parameters.HasLabel("namespace") ||
+                !parameters.HasLabel("items"))
+            {
+                response["error"] = "params missing";
+            }
+            else if (parameters["items"].Content() != Core::JSON::Variant::type::OBJECT)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
+                response["error"] = "items must be an object";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                std::vector<std::pair<string, string>> items;
+                bool valid = !ns.empty() && ns.size() <= 1000;
 
-                if (sqlite3_step(stmt) == SQLITE_ROW)
+                JsonObject jsonItems = parameters["items"].Object();
+                auto it = jsonItems.Variants();
+                while (valid && it.Next())
                 {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                        LOGWARN("max size exceeded: %lld", size);
+                    string key = it.Label();
+                    string value = it.Current().String();
+                    if (key.empty() || key.size() > 1000 || value.size() > 1000)
+                        valid = false;
                     else
-                        success = true;
+                        items.emplace_back(key, value);
                 }
+
+                if (!valid)
+                    response["error"] = "params empty or too long";
                 else
-                    LOGERR("ERROR getting size: %s", sqlite3_errmsg(db));
+                    success = setItems(ns, items);
+            }
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getItemsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
 
-                sqlite3_finalize(stmt);
+            bool success = false;
+            if (!parameters.HasLabel("namespace") ||
+                !parameters.HasLabel("keys"))
+            {
+                response["error"] = "params missing";
             }
+            else if (parameters["keys"].Content() != Core::JSON::Variant::type::ARRAY)
+            {
+                response["error"] = "keys must be an array";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                if (ns.empty())
+                    response["error"] = "params empty";
+                else
+                {
+                    std::vector<string> keys;
+                    JsonArray jsonKeys = parameters["keys"].Array();
+                    for (int i = 0; i < jsonKeys.Length(); i++)
+                        keys.push_back(jsonKeys[i].String());
 
+                    std::map<string, string> items;
+                    success = getItems(ns, keys, items);
+                    if (success)
+                    {
+                        JsonObject jsonItems;
+                        for (auto it = items.begin(); it != items.end(); ++it)
+                            jsonItems[it->first.c_str()] = it->second;
+                        response["items"] = jsonItems;
+                    }
+                }
+            }
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getAllWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            bool success = false;
+            if (!parameters.HasLabel("namespace"))
+            {
+                response["error"] = "params missing";
+            }
+            else
+            {
+                string ns = parameters["namespace"].String();
+                if (ns.empty())
+                    response["error"] = "params empty";
+                else
+                {
+                    std::map<string, string> items;
+                    success = getAll(ns, items);
+                    if (success)
+                    {
+                        JsonObject jsonItems;
+                        for (auto it = items.begin(); it != items.end(); ++it)
+                            jsonItems[it->first.c_str()] = it->second;
+                        response["items"] = jsonItems;
+                    }
+                }
+            }
+
+            returnResponse(success);
+        }
+
+        uint32_t PersistentStore::getVacuumStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            std::lock_guard<std::mutex> lock(mLock);
+
+            int64_t freePages = 0;
+            int64_t totalPages = 0;
+            bool success = getPageCounts(freePages, totalPages);
             if (success)
             {
-                success = false;
+                response["freePages"] = freePages;
+                response["totalPages"] = totalPages;
+                response["runs"] = mVacuumRuns;
+                response["pagesReclaimed"] = mVacuumPagesReclaimed;
+                response["timeSpentMs"] = mVacuumTimeUs / 1000;
+            }
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO namespace (name) values (?);", -1, &stmt, nullptr);
+            returnResponse(success);
+        }
 
-                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+        bool PersistentStore::setValue(const string& ns, const string& key, const string& value)
+        {
+            LOGINFO("%s %s %s", ns.c_str(), key.c_str(), value.c_str());
 
-                int rc = sqlite3_step(stmt);
-                if (rc != SQLITE_DONE)
-                    LOGERR("ERROR inserting data: %s", sqlite3_errmsg(db));
-                else
-                    success = true;
+            std::lock_guard<std::mutex> lock(mLock);
+
+            return doSetValue(ns, key, value);
+        }
 
-                sqlite3_finalize(stmt);
+        bool PersistentStore::doSetValue(const string& ns, const string& key, const string& value)
+        {
+            bool success = false;
+
+            sqlite3* &db = SQLITE;
+
+            cacheErase(ns, key);
+
+            if (db)
+            {
+                if (mSize > MAX_SIZE_BYTES)
+                    LOGWARN("max size exceeded: %lld", mSize);
+                else
+                    success = beginWrite();
             }
 
             if (success)
             {
                 success = false;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "INSERT INTO item (ns,key,value)"
-                                       " SELECT id, ?, ?"
-                                       " FROM namespace"
-                                       " WHERE name = ?"
-                                       ";", -1, &stmt, nullptr);
+                sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("INSERT OR IGNORE INTO namespace (name) values (?);");
+                if (stmt)
+                {
+                    sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
 
-                sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
+                    int rc = sqlite3_step(stmt);
+                    if (rc != SQLITE_DONE)
+                        LOGERR("ERROR inserting data: %s", sqlite3_errmsg(db));
+                    else
+                    {
+                        if (sqlite3_changes(db) > 0)
+                            mSize += g_utf8_strlen(ns.c_str(), -1);
+                        success = true;
+                    }
 
-                int rc = sqlite3_step(stmt);
-                if (rc != SQLITE_DONE)
-                    LOGERR("ERROR inserting data: %s", sqlite3_errmsg(db));
-                else
-                    success = true;
+                    sqlite3_reset(stmt);
+                }
+            }
+
+            int64_t oldSize = 0;
 
-                sqlite3_finalize(stmt);
+            if (success)
+            {
+                sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT length(key)+length(value)"
+                                                                 " FROM item"
+                                                                 " INNER JOIN namespace ON namespace.id = item.ns"
+                                                                 " where name = ? and key = ?"
+                                                                 ";");
+                if (stmt)
+                {
+                    sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+                    if (sqlite3_step(stmt) == SQLITE_ROW)
+                        oldSize = sqlite3_column_int64(stmt, 0);
+
+                    sqlite3_reset(stmt);
+                }
             }
 
             if (success)
             {
                 success = false;
 
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT sum(s) FROM ("
-                                       " SELECT sum(length(key)+length(value)) s FROM item"
-                                       " UNION ALL"
-                                       " SELECT sum(length(name)) s FROM namespace"
-                                       ");", -1, &stmt, nullptr);
-
-                if (sqlite3_step(stmt) == SQLITE_ROW)
+                sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("INSERT INTO item (ns,key,value)"
+                                                                 " SELECT id, ?, ?"
+                                                                 " FROM namespace"
+                                                                 " WHERE name = ?"
+                                                                 ";");
+                if (stmt)
                 {
-                    int64_t size = sqlite3_column_int64(stmt, 0);
-                    if (size > MAX_SIZE_BYTES)
-                    {
-                        LOGWARN("max size exceeded: %lld", size);
+                    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_TRANSIENT);
+                    sqlite3_bind_text(stmt, 3, ns.c_str(), -1, SQLITE_TRANSIENT);
 
-                        JsonObject params;
-                        sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
-                    }
+                    int rc = sqlite3_step(stmt);
+                    if (rc != SQLITE_DONE)
+                        LOGERR("ERROR inserting data: %s", sqlite3_errmsg(db));
                     else
+                    {
+                        mSize += g_utf8_strlen(key.c_str(), -1) + g_utf8_strlen(value.c_str(), -1) - oldSize;
                         success = true;
+                    }
+
+                    sqlite3_reset(stmt);
                 }
-                else
-                    LOGERR("ERROR getting size: %s", sqlite3_errmsg(db));
+            }
+
+            if (success && mSize > MAX_SIZE_BYTES)
+            {
+                success = false;
 
-                sqlite3_finalize(stmt);
+                LOGWARN("max size exceeded: %lld", mSize);
+
+                JsonObject params;
+                sendNotify(C_STR(EVT_ON_STORAGE_EXCEEDED), params);
             }
 
+            if (success)
+                cachePut(ns, key, value);
+
             return success;
         }
 
@@ -395,19 +626,25 @@ namespace WPEFramework {
         {
             LOGINFO("%s %s", ns.c_str(), key.c_str());
 
-            bool success = false;
+            std::lock_guard<std::mutex> lock(mLock);
 
-            sqlite3* &db = SQLITE;
+            return doGetValue(ns, key, value);
+        }
 
-            if (db)
-            {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT value"
-                                       " FROM item"
-                                       " INNER JOIN namespace ON namespace.id = item.ns"
-                                       " where name = ? and key = ?"
-                                       ";", -1, &stmt, nullptr);
+        bool PersistentStore::doGetValue(const string& ns, const string& key, string& value)
+        {
+            if (cacheGet(ns, key, value))
+                return true;
+
+            bool success = false;
 
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT value"
+                                                             " FROM item"
+                                                             " INNER JOIN namespace ON namespace.id = item.ns"
+                                                             " where name = ? and key = ?"
+                                                             ";");
+            if (stmt)
+            {
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
 
@@ -416,10 +653,99 @@ namespace WPEFramework {
                 {
                     value = (const char*)sqlite3_column_text(stmt, 0);
                     success = true;
+                    cachePut(ns, key, value);
                 }
                 else
                     LOGWARN("not found: %d", rc);
-                sqlite3_finalize(stmt);
+
+                sqlite3_reset(stmt);
+            }
+
+            return success;
+        }
+
+        bool PersistentStore::setItems(const string& ns, const std::vector<std::pair<string, string>>& items)
+        {
+            LOGINFO("%s %u", ns.c_str(), (unsigned)items.size());
+
+            std::lock_guard<std::mutex> lock(mLock);
+
+            sqlite3* &db = SQLITE;
+
+            // a savepoint makes the batch atomic and, outside of write-behind,
+            // commits it with a single sync
+            if (!db || !beginWrite() || !execute("SAVEPOINT setitems;"))
+                return false;
+
+            bool success = true;
+            for (auto it = items.begin(); success && it != items.end(); ++it)
+                success = doSetValue(ns, it->first, it->second);
+
+            if (!success)
+            {
+                execute("ROLLBACK TO setitems;");
+                cacheEraseNamespace(ns);
+                calculateSize();
+            }
+
+            if (!execute("RELEASE setitems;"))
+                success = false;
+
+            return success;
+        }
+
+        bool PersistentStore::getItems(const string& ns, const std::vector<string>& keys, std::map<string, string>& items)
+        {
+            LOGINFO("%s %u", ns.c_str(), (unsigned)keys.size());
+
+            std::lock_guard<std::mutex> lock(mLock);
+
+            sqlite3* &db = SQLITE;
+
+            items.clear();
+
+            if (!db)
+                return false;
+
+            // all reads see one snapshot of the database
+            bool ownTransaction = sqlite3_get_autocommit(db) && execute("BEGIN TRANSACTION;");
+
+            for (auto it = keys.begin(); it != keys.end(); ++it)
+            {
+                string value;
+                if (doGetValue(ns, *it, value))
+                    items[*it] = value;
+            }
+
+            if (ownTransaction)
+                execute("COMMIT TRANSACTION;");
+
+            return true;
+        }
+
+        bool PersistentStore::getAll(const string& ns, std::map<string, string>& items)
+        {
+            LOGINFO("%s", ns.c_str());
+
+            std::lock_guard<std::mutex> lock(mLock);
+
+            bool success = false;
+
+            items.clear();
+
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT key, value"
+                                                             " FROM item"
+                                                             " where ns in (select id from namespace where name = ?)"
+                                                             ";");
+            if (stmt)
+            {
+                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+
+                while (sqlite3_step(stmt) == SQLITE_ROW)
+                    items[(const char*)sqlite3_column_text(stmt, 0)] = (const char*)sqlite3_column_text(stmt, 1);
+
+                sqlite3_reset(stmt);
+                success = true;
             }
 
             return success;
@@ -429,18 +755,38 @@ namespace WPEFramework {
         {
             LOGINFO("%s %s", ns.c_str(), key.c_str());
 
+            std::lock_guard<std::mutex> lock(mLock);
+
             bool success = false;
 
             sqlite3* &db = SQLITE;
 
-            if (db)
+            cacheErase(ns, key);
+
+            int64_t oldSize = 0;
+
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT length(key)+length(value)"
+                                                             " FROM item"
+                                                             " INNER JOIN namespace ON namespace.id = item.ns"
+                                                             " where name = ? and key = ?"
+                                                             ";");
+            if (stmt)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM item"
-                                       " where ns in (select id from namespace where name = ?)"
-                                       " and key = ?"
-                                       ";", -1, &stmt, NULL);
+                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+
+                if (sqlite3_step(stmt) == SQLITE_ROW)
+                    oldSize = sqlite3_column_int64(stmt, 0);
 
+                sqlite3_reset(stmt);
+            }
+
+            stmt = (sqlite3_stmt*)getStatement("DELETE FROM item"
+                                               " where ns in (select id from namespace where name = ?)"
+                                               " and key = ?"
+                                               ";");
+            if (stmt && beginWrite())
+            {
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
 
@@ -448,9 +794,13 @@ namespace WPEFramework {
                 if (rc != SQLITE_DONE)
                     LOGERR("ERROR removing data: %s", sqlite3_errmsg(db));
                 else
+                {
+                    if (sqlite3_changes(db) > 0)
+                        mSize -= oldSize;
                     success = true;
+                }
 
-                sqlite3_finalize(stmt);
+                sqlite3_reset(stmt);
             }
 
             return success;
@@ -460,24 +810,46 @@ namespace WPEFramework {
         {
             LOGINFO("%s", ns.c_str());
 
+            std::lock_guard<std::mutex> lock(mLock);
+
             bool success = false;
 
             sqlite3* &db = SQLITE;
 
-            if (db)
+            cacheEraseNamespace(ns);
+
+            int64_t oldSize = 0;
+
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT sum(length(key)+length(value))"
+                                                             " FROM item"
+                                                             " where ns in (select id from namespace where name = ?)"
+                                                             ";");
+            if (stmt)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "DELETE FROM namespace where name = ?;", -1, &stmt, NULL);
+                sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
 
+                if (sqlite3_step(stmt) == SQLITE_ROW)
+                    oldSize = sqlite3_column_int64(stmt, 0);
+
+                sqlite3_reset(stmt);
+            }
+
+            stmt = (sqlite3_stmt*)getStatement("DELETE FROM namespace where name = ?;");
+            if (stmt && beginWrite())
+            {
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
 
                 int rc = sqlite3_step(stmt);
                 if (rc != SQLITE_DONE)
                     LOGERR("ERROR removing data: %s", sqlite3_errmsg(db));
                 else
+                {
+                    if (sqlite3_changes(db) > 0)
+                        mSize -= oldSize + g_utf8_strlen(ns.c_str(), -1);
                     success = true;
+                }
 
-                sqlite3_finalize(stmt);
+                sqlite3_reset(stmt);
             }
 
             return success;
@@ -487,26 +859,24 @@ namespace WPEFramework {
         {
             LOGINFO("%s", ns.c_str());
 
-            bool success = false;
+            std::lock_guard<std::mutex> lock(mLock);
 
-            sqlite3* &db = SQLITE;
+            bool success = false;
 
             keys.clear();
 
-            if (db)
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT key"
+                                                             " FROM item"
+                                                             " where ns in (select id from namespace where name = ?)"
+                                                             ";");
+            if (stmt)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT key"
-                                       " FROM item"
-                                       " where ns in (select id from namespace where name = ?)"
-                                       ";", -1, &stmt, NULL);
-
                 sqlite3_bind_text(stmt, 1, ns.c_str(), -1, SQLITE_TRANSIENT);
 
                 while (sqlite3_step(stmt) == SQLITE_ROW)
                     keys.push_back((const char*)sqlite3_column_text(stmt, 0));
 
-                sqlite3_finalize(stmt);
+                sqlite3_reset(stmt);
                 success = true;
             }
 
@@ -517,21 +887,19 @@ namespace WPEFramework {
         {
             LOGINFO();
 
-            bool success = false;
+            std::lock_guard<std::mutex> lock(mLock);
 
-            sqlite3* &db = SQLITE;
+            bool success = false;
 
             namespaces.clear();
 
-            if (db)
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT name FROM namespace;");
+            if (stmt)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT name FROM namespace;", -1, &stmt, NULL);
-
                 while (sqlite3_step(stmt) == SQLITE_ROW)
                     namespaces.push_back((const char*)sqlite3_column_text(stmt, 0));
 
-                sqlite3_finalize(stmt);
+                sqlite3_reset(stmt);
                 success = true;
             }
 
@@ -542,25 +910,23 @@ namespace WPEFramework {
         {
             LOGINFO();
 
-            bool success = false;
+            std::lock_guard<std::mutex> lock(mLock);
 
-            sqlite3* &db = SQLITE;
+            bool success = false;
 
             namespaceSizes.clear();
 
-            if (db)
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT name, sum(length(key)+length(value))"
+                                                             " FROM item"
+                                                             " INNER JOIN namespace ON namespace.id = item.ns"
+                                                             " GROUP BY name"
+                                                             ";");
+            if (stmt)
             {
-                sqlite3_stmt *stmt;
-                sqlite3_prepare_v2(db, "SELECT name, sum(length(key)+length(value))"
-                                       " FROM item"
-                                       " INNER JOIN namespace ON namespace.id = item.ns"
-                                       " GROUP BY name"
-                                       ";", -1, &stmt, NULL);
-
                 while (sqlite3_step(stmt) == SQLITE_ROW)
                     namespaceSizes[(const char*)sqlite3_column_text(stmt, 0)] = sqlite3_column_int(stmt, 1);
 
-                sqlite3_finalize(stmt);
+                sqlite3_reset(stmt);
                 success = true;
             }
 
@@ -573,10 +939,15 @@ namespace WPEFramework {
 
             sqlite3* &db = SQLITE;
 
+            flush();
+            finalizeStatements();
+            mCache.clear();
+
             if (db)
                 sqlite3_close(db);
 
             db = NULL;
+            mSize = 0;
         }
 
         void PersistentStore::vacuum()
@@ -610,6 +981,9 @@ namespace WPEFramework {
 
             term();
 
+            mFilename = filename;
+            mKey.clear();
+
             bool shouldEncrypt = key && *key;
 #if defined(SQLITE_HAS_CODEC)
             bool shouldReKey = shouldEncrypt && fileExists(filename) && !fileEncrypted(filename);
@@ -668,6 +1042,8 @@ namespace WPEFramework {
 
                 if (shouldReKey && !fileEncrypted(filename))
                     LOGERR("SQLite database file is clear after re-key, path=%s", filename);
+
+                mKey = pKey;
 #endif
             }
 
@@ -742,7 +1118,410 @@ namespace WPEFramework {
                     LOGERR("%d", rc);
             }
 
+            if (mVacuumInterval > 0)
+                enableIncrementalVacuum();
+
+            if (mWal)
+            {
+                execute("PRAGMA journal_mode = WAL;");
+
+                // checkpoints are left to the background thread, not to the writer that crosses the threshold
+                if (mCheckpointInterval > 0)
+                    execute("PRAGMA wal_autocheckpoint = 0;");
+            }
+
+            if (!mSynchronous.empty())
+            {
+                string sql = "PRAGMA synchronous = " + mSynchronous + ";";
+                execute(sql.c_str());
+            }
+
+            return calculateSize();
+        }
+
+        void* PersistentStore::getStatement(const char* sql)
+        {
+            sqlite3* &db = SQLITE;
+
+            if (!db)
+                return nullptr;
+
+            sqlite3_stmt *stmt = nullptr;
+
+            auto it = mStatements.find(sql);
+            if (it != mStatements.end())
+            {
+                stmt = (sqlite3_stmt*)it->second;
+                sqlite3_reset(stmt);
+                sqlite3_clear_bindings(stmt);
+            }
+            else
+            {
+                int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+                if (rc != SQLITE_OK)
+                {
+                    LOGERR("%d : %s", rc, sqlite3_errmsg(db));
+                    sqlite3_finalize(stmt);
+                    return nullptr;
+                }
+                mStatements[sql] = stmt;
+            }
+
+            return stmt;
+        }
+
+        void PersistentStore::finalizeStatements()
+        {
+            for (auto it = mStatements.begin(); it != mStatements.end(); ++it)
+                sqlite3_finalize((sqlite3_stmt*)it->second);
+
+            mStatements.clear();
+        }
+
+        bool PersistentStore::calculateSize()
+        {
+            bool success = false;
+
+            sqlite3* &db = SQLITE;
+
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("SELECT sum(s) FROM ("
+                                                             " SELECT sum(length(key)+length(value)) s FROM item"
+                                                             " UNION ALL"
+                                                             " SELECT sum(length(name)) s FROM namespace"
+                                                             ");");
+            if (stmt)
+            {
+                if (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    mSize = sqlite3_column_int64(stmt, 0);
+                    success = true;
+                }
+                else
+                    LOGERR("ERROR getting size: %s", sqlite3_errmsg(db));
+
+                sqlite3_reset(stmt);
+            }
+
+            return success;
+        }
+
+        bool PersistentStore::beginWrite()
+        {
+            mLastWrite = std::chrono::steady_clock::now();
+
+            if (!mWriteBehind || mInTransaction)
+                return true;
+
+            if (!execute("BEGIN TRANSACTION;"))
+                return false;
+
+            mInTransaction = true;
+            mTimer.Schedule(Core::Time::Now().Add(mFlushInterval), mFlushInfo);
+
             return true;
         }
+
+        void PersistentStore::flush()
+        {
+            sqlite3* &db = SQLITE;
+
+            if (!db || !mInTransaction)
+                return;
+
+            mInTransaction = false;
+
+            if (!execute("COMMIT TRANSACTION;"))
+            {
+                // the batch is lost, bring the size counter back in line with the file
+                if (!sqlite3_get_autocommit(db))
+                    sqlite3_exec(db, "ROLLBACK TRANSACTION;", 0, 0, nullptr);
+                calculateSize();
+                mCache.clear();
+            }
+        }
+
+        bool PersistentStore::execute(const char* sql)
+        {
+            sqlite3* &db = SQLITE;
+
+            char *errmsg;
+            int rc = sqlite3_exec(db, sql, 0, 0, &errmsg);
+            if (rc != SQLITE_OK || errmsg)
+            {
+                if (errmsg)
+                {
+                    LOGERR("%s %d : %s", sql, rc, errmsg);
+                    sqlite3_free(errmsg);
+                }
+                else
+                    LOGERR("%s %d", sql, rc);
+                return false;
+            }
+
+            return true;
+        }
+
+        void PersistentStore::startCheckpointThread()
+        {
+            stopCheckpointThread();
+
+            mCheckpointStop = false;
+            mCheckpointThread = std::thread(&PersistentStore::checkpointThreadRun, this);
+        }
+
+        void PersistentStore::stopCheckpointThread()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mCheckpointLock);
+                mCheckpointStop = true;
+            }
+            mCheckpointCondition.notify_all();
+
+            if (mCheckpointThread.joinable())
+                mCheckpointThread.join();
+        }
+
+        void PersistentStore::checkpointThreadRun()
+        {
+            LOGINFO();
+
+            // a connection of its own lets the checkpoint run without holding mLock
+            sqlite3* db = nullptr;
+            int rc = sqlite3_open(mFilename.c_str(), &db);
+#if defined(SQLITE_HAS_CODEC)
+            if (rc == SQLITE_OK && !mKey.empty())
+                rc = sqlite3_key_v2(db, nullptr, mKey.data(), mKey.size());
+#endif
+            if (rc != SQLITE_OK)
+            {
+                LOGERR("%d : %s", rc, sqlite3_errmsg(db));
+                sqlite3_close(db);
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mCheckpointLock);
+            while (!mCheckpointStop)
+            {
+                mCheckpointCondition.wait_for(lock, std::chrono::milliseconds(mCheckpointInterval));
+                if (mCheckpointStop)
+                    break;
+
+                lock.unlock();
+
+                int logFrames = 0;
+                int checkpointedFrames = 0;
+                rc = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_PASSIVE, &logFrames, &checkpointedFrames);
+                if (rc != SQLITE_OK)
+                    LOGWARN("checkpoint failed %d : %s", rc, sqlite3_errmsg(db));
+                else if (logFrames != checkpointedFrames)
+                    LOGINFO("checkpointed %d of %d frames", checkpointedFrames, logFrames);
+
+                lock.lock();
+            }
+
+            sqlite3_close(db);
+        }
+
+        void PersistentStore::onTimer(StoreTimerInfo::Kind kind)
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+
+            if (kind == StoreTimerInfo::FLUSH)
+                flush();
+            else
+            {
+                incrementalVacuum();
+                if (mData)
+                    mTimer.Schedule(Core::Time::Now().Add(mVacuumInterval), mVacuumInfo);
+            }
+        }
+
+        bool PersistentStore::getPageCounts(int64_t& freePages, int64_t& totalPages)
+        {
+            bool success = false;
+
+            sqlite3_stmt *stmt = (sqlite3_stmt*)getStatement("PRAGMA freelist_count;");
+            if (stmt)
+            {
+                if (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    freePages = sqlite3_column_int64(stmt, 0);
+                    success = true;
+                }
+                sqlite3_reset(stmt);
+            }
+
+            stmt = success ? (sqlite3_stmt*)getStatement("PRAGMA page_count;") : nullptr;
+            if (stmt)
+            {
+                success = false;
+                if (sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    totalPages = sqlite3_column_int64(stmt, 0);
+                    success = true;
+                }
+                sqlite3_reset(stmt);
+            }
+
+            return success;
+        }
+
+        bool PersistentStore::enableIncrementalVacuum()
+        {
+            sqlite3* &db = SQLITE;
+
+            bool success = false;
+            int mode = -1;
+
+            sqlite3_stmt *stmt;
+            sqlite3_prepare_v2(db, "PRAGMA auto_vacuum;", -1, &stmt, nullptr);
+            if (sqlite3_step(stmt) == SQLITE_ROW)
+                mode = sqlite3_column_int(stmt, 0);
+            sqlite3_finalize(stmt);
+
+            mVacuumConvert = false;
+            if (mode == 2) // INCREMENTAL
+                success = true;
+            else if (mode >= 0)
+            {
+                // the mode of an existing file only changes with one full rebuild, left to the first idle
+                // tick so that it doesn't hold up the start
+                LOGWARN("switching auto_vacuum from %d to incremental on the first idle tick", mode);
+                if (execute("PRAGMA auto_vacuum = INCREMENTAL;"))
+                {
+                    mVacuumConvert = true;
+                    success = true;
+                }
+            }
+
+            return success;
+        }
+
+        void PersistentStore::incrementalVacuum()
+        {
+            sqlite3* &db = SQLITE;
+
+            // only when idle: no open write-behind batch and nothing written for a whole tick
+            if (!db || mInTransaction
+                || std::chrono::steady_clock::now() - mLastWrite < std::chrono::milliseconds(mVacuumInterval))
+                return;
+
+            int64_t freePages = 0;
+            int64_t totalPages = 0;
+            if (!getPageCounts(freePages, totalPages) || totalPages == 0)
+                return;
+
+            auto start = std::chrono::steady_clock::now();
+
+            if (mVacuumConvert)
+            {
+                vacuum();
+                mVacuumConvert = false;
+
+                uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                mVacuumRuns++;
+                mVacuumPagesReclaimed += freePages;
+                mVacuumTimeUs += elapsed;
+
+                LOGINFO("switched to incremental auto_vacuum in %llu us", (unsigned long long)elapsed);
+                return;
+            }
+
+            if (freePages * 100 < totalPages * (int64_t)mVacuumRatio || freePages == 0)
+                return;
+
+            string sql = "PRAGMA incremental_vacuum(" + std::to_string(mVacuumPages) + ");";
+            if (!execute(sql.c_str()))
+                return;
+
+            uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+            int64_t freePagesAfter = freePages;
+            getPageCounts(freePagesAfter, totalPages);
+
+            mVacuumRuns++;
+            mVacuumPagesReclaimed += freePages - freePagesAfter;
+            mVacuumTimeUs += elapsed;
+
+            LOGINFO("reclaimed %lld pages in %llu us, %lld of %lld free",
+                (long long)(freePages - freePagesAfter), (unsigned long long)elapsed, (long long)freePagesAfter, (long long)totalPages);
+        }
+
+        bool PersistentStore::cacheGet(const string& ns, const string& key, string& value)
+        {
+            if (mCacheSize == 0)
+                return false;
+
+            auto nsIt = mCache.find(ns);
+            if (nsIt != mCache.end())
+            {
+                NamespaceCache& cache = nsIt->second;
+                auto it = cache.index.find(key);
+                if (it != cache.index.end())
+                {
+                    cache.items.splice(cache.items.begin(), cache.items, it->second);
+                    value = it->second->second;
+                    mCacheHits++;
+                    return true;
+                }
+            }
+
+            mCacheMisses++;
+            return false;
+        }
+
+        void PersistentStore::cachePut(const string& ns, const string& key, const string& value)
+        {
+            if (mCacheSize == 0)
+                return;
+
+            NamespaceCache& cache = mCache[ns];
+            auto it = cache.index.find(key);
+            if (it != cache.index.end())
+            {
+                it->second->second = value;
+                cache.items.splice(cache.items.begin(), cache.items, it->second);
+                return;
+            }
+
+            if (cache.items.size() >= mCacheSize)
+            {
+                cache.index.erase(cache.items.back().first);
+                cache.items.pop_back();
+            }
+
+            cache.items.emplace_front(key, value);
+            cache.index[key] = cache.items.begin();
+        }
+
+        void PersistentStore::cacheErase(const string& ns, const string& key)
+        {
+            auto nsIt = mCache.find(ns);
+            if (nsIt == mCache.end())
+                return;
+
+            NamespaceCache& cache = nsIt->second;
+            auto it = cache.index.find(key);
+            if (it != cache.index.end())
+            {
+                cache.items.erase(it->second);
+                cache.index.erase(it);
+            }
+
+            if (cache.items.empty())
+                mCache.erase(nsIt);
+        }
+
+        void PersistentStore::cacheEraseNamespace(const string& ns)
+        {
+            mCache.erase(ns);
+        }
+
+        uint64_t StoreTimerInfo::Timed(const uint64_t scheduledTime)
+        {
+            uint64_t result = 0;
+            m_store->onTimer(m_kind);
+            return(result);
+        }
     } // namespace Plugin
 } // namespace WPEFramework
@@ -6,12 +6,99 @@
 
 #include <vector>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 
 namespace WPEFramework {
 
     namespace Plugin {
 
+        class PersistentStore;
+        class StoreTimerInfo
+        {
+        public:
+            enum Kind { FLUSH, VACUUM };
+
+        private:
+            StoreTimerInfo() = delete;
+            StoreTimerInfo& operator=(const StoreTimerInfo& RHS) = delete;
+
+        public:
+            StoreTimerInfo(PersistentStore* ps, Kind kind)
+            : m_store(ps)
+            , m_kind(kind)
+            {
+            }
+            StoreTimerInfo(const StoreTimerInfo& copy)
+            : m_store(copy.m_store)
+            , m_kind(copy.m_kind)
+            {
+            }
+            ~StoreTimerInfo() {}
+
+            inline bool operator==(const StoreTimerInfo& RHS) const
+            {
+                return(m_store == RHS.m_store && m_kind == RHS.m_kind);
+            }
+
+        public:
+            uint64_t Timed(const uint64_t scheduledTime);
+
+        private:
+            PersistentStore* m_store;
+            Kind m_kind;
+        };
+
         class PersistentStore :  public AbstractPlugin {
+        public:
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : Core::JSON::Container()
+                    , WriteBehind(false)
+                    , FlushInterval(1000)
+                    , CacheSize(64)
+                    , Wal(false)
+                    , Synchronous()
+                    , CheckpointInterval(30000)
+                    , VacuumInterval(60000)
+                    , VacuumPages(64)
+                    , VacuumRatio(10)
+                {
+                    Add(_T("writebehind"), &WriteBehind);
+                    Add(_T("flushinterval"), &FlushInterval);
+                    Add(_T("cachesize"), &CacheSize);
+                    Add(_T("wal"), &Wal);
+                    Add(_T("synchronous"), &Synchronous);
+                    Add(_T("checkpointinterval"), &CheckpointInterval);
+                    Add(_T("vacuuminterval"), &VacuumInterval);
+                    Add(_T("vacuumpages"), &VacuumPages);
+                    Add(_T("vacuumratio"), &VacuumRatio);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::Boolean WriteBehind; // coalesce setValue calls into one transaction
+                Core::JSON::DecUInt32 FlushInterval; // ms until a pending transaction is committed
+                Core::JSON::DecUInt32 CacheSize; // max cached values per namespace, 0 disables the cache
+                Core::JSON::Boolean Wal; // use write-ahead logging instead of the rollback journal
+                Core::JSON::String Synchronous; // PRAGMA synchronous level: off, normal, full, extra
+                Core::JSON::DecUInt32 CheckpointInterval; // ms between background WAL checkpoints, 0 keeps auto-checkpoint
+                Core::JSON::DecUInt32 VacuumInterval; // ms between incremental vacuum ticks, 0 disables them
+                Core::JSON::DecUInt32 VacuumPages; // max pages reclaimed per tick
+                Core::JSON::DecUInt32 VacuumRatio; // free page percentage that triggers reclaiming
+            };
+
         public:
             PersistentStore();
             virtual ~PersistentStore();
@@ -34,6 +121,11 @@ namespace WPEFramework {
             static const string METHOD_GET_KEYS;
             static const string METHOD_GET_NAMESPACES;
             static const string METHOD_GET_STORAGE_SIZE;
+            static const string METHOD_GET_CACHE_STATS;
+            static const string METHOD_SET_ITEMS;
+            static const string METHOD_GET_ITEMS;
+            static const string METHOD_GET_ALL;
+            static const string METHOD_GET_VACUUM_STATS;
             //events
             static const string EVT_ON_STORAGE_EXCEEDED;
             //other
@@ -52,6 +144,20 @@ namespace WPEFramework {
             uint32_t getKeysWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getNamespacesWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getStorageSizeWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getCacheStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setItemsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getItemsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getAllWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getVacuumStatsWrapper(const JsonObject& parameters, JsonObject& response);
+
+        private/*types*/:
+            // most recently used value at the front
+            typedef std::list<std::pair<string, string>> CacheList;
+            struct NamespaceCache
+            {
+                CacheList items;
+                std::unordered_map<string, CacheList::iterator> index;
+            };
 
         private/*internal methods*/:
             PersistentStore(const PersistentStore&) = delete;
@@ -64,12 +170,70 @@ namespace WPEFramework {
             bool getKeys(const string& ns, std::vector<string>& keys);
             bool getNamespaces(std::vector<string>& namespaces);
             bool getStorageSize(std::map<string, uint64_t>& namespaceSizes);
+            bool setItems(const string& ns, const std::vector<std::pair<string, string>>& items);
+            bool getItems(const string& ns, const std::vector<string>& keys, std::map<string, string>& items);
+            bool getAll(const string& ns, std::map<string, string>& items);
+
+            // callers hold mLock
+            bool doSetValue(const string& ns, const string& key, const string& value);
+            bool doGetValue(const string& ns, const string& key, string& value);
 
             void term();
             void vacuum();
             bool init(const char* filename, const char* key = nullptr);
 
+            void* getStatement(const char* sql);
+            void finalizeStatements();
+            bool calculateSize();
+            bool beginWrite();
+            bool execute(const char* sql);
+            void startCheckpointThread();
+            void stopCheckpointThread();
+            void checkpointThreadRun();
+            void flush();
+            void onTimer(StoreTimerInfo::Kind kind);
+            bool enableIncrementalVacuum();
+            void incrementalVacuum();
+            bool getPageCounts(int64_t& freePages, int64_t& totalPages);
+
+            bool cacheGet(const string& ns, const string& key, string& value);
+            void cachePut(const string& ns, const string& key, const string& value);
+            void cacheErase(const string& ns, const string& key);
+            void cacheEraseNamespace(const string& ns);
+
             void* mData;
+            std::map<string, void*> mStatements;
+            std::mutex mLock;
+            int64_t mSize;
+            bool mWriteBehind;
+            uint32_t mFlushInterval;
+            bool mInTransaction;
+            Core::TimerType<StoreTimerInfo> mTimer;
+            StoreTimerInfo mFlushInfo;
+            std::map<string, NamespaceCache> mCache;
+            uint32_t mCacheSize;
+            uint64_t mCacheHits;
+            uint64_t mCacheMisses;
+            bool mWal;
+            string mSynchronous;
+            uint32_t mCheckpointInterval;
+            string mFilename;
+            std::vector<uint8_t> mKey;
+            std::thread mCheckpointThread;
+            std::mutex mCheckpointLock;
+            std::condition_variable mCheckpointCondition;
+            bool mCheckpointStop;
+            StoreTimerInfo mVacuumInfo;
+            uint32_t mVacuumInterval;
+            uint32_t mVacuumPages;
+            uint32_t mVacuumRatio;
+            bool mVacuumConvert; // auto_vacuum is not INCREMENTAL yet, the first idle tick rebuilds the file
+            std::chrono::steady_clock::time_point mLastWrite;
+            uint64_t mVacuumRuns;
+            uint64_t mVacuumPagesReclaimed;
+            uint64_t mVacuumTimeUs;
+
+            friend class StoreTimerInfo;
         };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -0,0 +1,130 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+ * @file persistentStoreBenchmark.cpp
+ * @brief Measures PersistentStore setValue/getValue throughput and latency with concurrent JSON-RPC clients.
+ *
+ * Usage: persistentStoreBenchmark [clients] [operations per client]
+ * Compare the plugin configurations (e.g. "wal", "synchronous", "writebehind") by re-running against each.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "Module.h"
+
+#define PERSISTENTSTORE_CALLSIGN "org.rdk.PersistentStore.1"
+#define SERVER_DETAILS  "127.0.0.1:9998"
+
+using namespace std;
+using namespace WPEFramework;
+
+struct Result
+{
+    vector<double> latencies; // microseconds
+    int failures = 0;
+};
+
+static void runClient(const string& method, int client, int operations, Result& result)
+{
+    JSONRPC::LinkType<Core::JSON::IElement> remoteObject(_T(PERSISTENTSTORE_CALLSIGN), _T(""));
+
+    string ns = "benchmark" + std::to_string(client);
+    result.latencies.reserve(operations);
+
+    for (int i = 0; i < operations; i++)
+    {
+        JsonObject params, response;
+        params["namespace"] = ns;
+        params["key"] = "key" + std::to_string(i % 100);
+        if (method == "setValue")
+            params["value"] = "value" + std::to_string(i);
+
+        auto start = chrono::steady_clock::now();
+        uint32_t ret = remoteObject.Invoke<JsonObject, JsonObject>(5000, method, params, response);
+        auto end = chrono::steady_clock::now();
+
+        if (ret != Core::ERROR_NONE || !response["success"].Boolean())
+            result.failures++;
+        result.latencies.push_back(chrono::duration<double, std::micro>(end - start).count());
+    }
+}
+
+static void runPhase(const string& method, int clients, int operations)
+{
+    vector<Result> results(clients);
+    vector<std::thread> threads;
+
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < clients; c++)
+        threads.emplace_back(runClient, method, c, operations, std::ref(results[c]));
+    for (auto& t : threads)
+        t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> all;
+    int failures = 0;
+    for (auto& r : results)
+    {
+        all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+        failures += r.failures;
+    }
+    if (all.empty())
+        return;
+    std::sort(all.begin(), all.end());
+
+    auto percentile = [&all](double p) { return all[std::min(all.size() - 1, (size_t)(p * all.size()))]; };
+
+    std::cout << method << ": " << all.size() << " calls, " << failures << " failed, "
+              << (all.size() / seconds) << " calls/s, latency us"
+              << " p50=" << percentile(0.50)
+              << " p95=" << percentile(0.95)
+              << " p99=" << percentile(0.99)
+              << " max=" << all.back() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    int clients = argc > 1 ? atoi(argv[1]) : 8;
+    int operations = argc > 2 ? atoi(argv[2]) : 1000;
+
+    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T(SERVER_DETAILS)));
+
+    std::cout << "clients=" << clients << " operations per client=" << operations << std::endl;
+
+    runPhase("setValue", clients, operations);
+    runPhase("getValue", clients, operations);
+
+    {
+        JSONRPC::LinkType<Core::JSON::IElement> remoteObject(_T(PERSISTENTSTORE_CALLSIGN), _T(""));
+        for (int c = 0; c < clients; c++)
+        {
+            JsonObject params, response;
+            params["namespace"] = "benchmark" + std::to_string(c);
+            remoteObject.Invoke<JsonObject, JsonObject>(5000, _T("deleteNamespace"), params, response);
+        }
+    }
+
+    return 0;
+}
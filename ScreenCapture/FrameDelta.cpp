@@ -0,0 +1,217 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FrameDelta.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCREENCAPTURE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCREENCAPTURE_SSE2
+#endif
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            const int BYTES_PER_PIXEL = 4;
+            const int DEFAULT_TILE_SIZE = 32;
+            const int MIN_TILE_SIZE = 8;
+            const int MAX_TILE_SIZE = 256;
+            const size_t HEADER_SIZE = 20;
+
+            void putUint32(unsigned char *p, uint32_t value)
+            {
+                p[0] = (unsigned char)(value >> 24);
+                p[1] = (unsigned char)(value >> 16);
+                p[2] = (unsigned char)(value >> 8);
+                p[3] = (unsigned char)value;
+            }
+
+            // 64 bytes per step, the differences are ORed together and tested once
+            bool spanEqual(const unsigned char *a, const unsigned char *b, size_t bytes)
+            {
+                size_t i = 0;
+
+#if defined(SCREENCAPTURE_NEON)
+                for (; i + 64 <= bytes; i += 64)
+                {
+                    uint8x16_t diff = vorrq_u8(
+                        vorrq_u8(veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)), veorq_u8(vld1q_u8(a + i + 16), vld1q_u8(b + i + 16))),
+                        vorrq_u8(veorq_u8(vld1q_u8(a + i + 32), vld1q_u8(b + i + 32)), veorq_u8(vld1q_u8(a + i + 48), vld1q_u8(b + i + 48))));
+                    uint64x2_t wide = vreinterpretq_u64_u8(diff);
+                    if (vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1))
+                        return false;
+                }
+#elif defined(SCREENCAPTURE_SSE2)
+                for (; i + 64 <= bytes; i += 64)
+                {
+                    const __m128i *pa = (const __m128i *)(a + i);
+                    const __m128i *pb = (const __m128i *)(b + i);
+                    __m128i diff = _mm_or_si128(
+                        _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa), _mm_loadu_si128(pb)), _mm_xor_si128(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1))),
+                        _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)), _mm_xor_si128(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3))));
+                    if (0xffff != _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())))
+                        return false;
+                }
+#endif
+
+                return 0 == memcmp(a + i, b + i, bytes - i);
+            }
+        }
+
+        FrameDelta::FrameDelta()
+            : m_tileSize(DEFAULT_TILE_SIZE)
+            , m_width(0)
+            , m_height(0)
+        {
+        }
+
+        void FrameDelta::setTileSize(int tileSize)
+        {
+            tileSize = std::max(MIN_TILE_SIZE, std::min(tileSize, MAX_TILE_SIZE));
+            if (tileSize != m_tileSize)
+            {
+                m_tileSize = tileSize;
+                reset();
+            }
+        }
+
+        size_t FrameDelta::tileCount(int width, int height) const
+        {
+            return (size_t)((width + m_tileSize - 1) / m_tileSize) * ((height + m_tileSize - 1) / m_tileSize);
+        }
+
+        bool FrameDelta::compare(const unsigned char *rgba, int width, int height, std::vector<uint32_t> &dirty) const
+        {
+            dirty.clear();
+
+            if (NULL == rgba || m_previous.empty() || width != m_width || height != m_height)
+                return false;
+
+            const int columns = (width + m_tileSize - 1) / m_tileSize;
+            const size_t stride = (size_t)width * BYTES_PER_PIXEL;
+            std::vector<bool> changed(columns);
+
+            for (int row = 0; row * m_tileSize < height; row++)
+            {
+                const int last = std::min(height, (row + 1) * m_tileSize);
+                int remaining = columns;
+                changed.assign(columns, false);
+
+                // Once a tile is dirty its other rows are skipped, a row with all tiles dirty ends early
+                for (int y = row * m_tileSize; y < last && remaining > 0; y++)
+                {
+                    const unsigned char *current = rgba + y * stride;
+                    const unsigned char *previous = &m_previous[y * stride];
+
+                    for (int column = 0; column < columns; column++)
+                    {
+                        if (changed[column])
+                            continue;
+
+                        const size_t offset = (size_t)column * m_tileSize * BYTES_PER_PIXEL;
+                        const size_t bytes = std::min(stride - offset, (size_t)m_tileSize * BYTES_PER_PIXEL);
+                        if (!spanEqual(current + offset, previous + offset, bytes))
+                        {
+                            changed[column] = true;
+                            remaining--;
+                        }
+                    }
+                }
+
+                for (int column = 0; column < columns; column++)
+                {
+                    if (changed[column])
+                        dirty.push_back((uint32_t)row * columns + column);
+                }
+            }
+
+            return true;
+        }
+
+        void FrameDelta::gatherTiles(const unsigned char *rgba, int width, int height, const std::vector<uint32_t> &dirty, std::vector<unsigned char> &tiles) const
+        {
+            const int columns = (width + m_tileSize - 1) / m_tileSize;
+            const size_t tileStride = (size_t)m_tileSize * BYTES_PER_PIXEL;
+            const size_t tileBytes = tileStride * m_tileSize;
+
+            tiles.assign(tileBytes * dirty.size(), 0);
+
+            for (size_t n = 0; n < dirty.size(); n++)
+            {
+                const int x = (dirty[n] % columns) * m_tileSize;
+                const int y = (dirty[n] / columns) * m_tileSize;
+                const size_t bytes = (size_t)std::min(m_tileSize, width - x) * BYTES_PER_PIXEL;
+                const int rows = std::min(m_tileSize, height - y);
+
+                unsigned char *out = &tiles[n * tileBytes];
+                for (int i = 0; i < rows; i++)
+                    memcpy(out + i * tileStride, rgba + ((size_t)(y + i) * width + x) * BYTES_PER_PIXEL, bytes);
+            }
+        }
+
+        bool FrameDelta::writeHeader(int width, int height, const std::vector<uint32_t> &dirty, const PngEncoder::Writer &writer) const
+        {
+            const int columns = (width + m_tileSize - 1) / m_tileSize;
+            std::vector<unsigned char> header(HEADER_SIZE + dirty.size() * 4);
+
+            memcpy(&header[0], "SCRD", 4);
+            putUint32(&header[4], width);
+            putUint32(&header[8], height);
+            putUint32(&header[12], m_tileSize);
+            putUint32(&header[16], (uint32_t)dirty.size());
+
+            unsigned char *p = &header[HEADER_SIZE];
+            for (size_t n = 0; n < dirty.size(); n++, p += 4)
+            {
+                const uint32_t column = dirty[n] % columns;
+                const uint32_t row = dirty[n] / columns;
+                p[0] = (unsigned char)(column >> 8);
+                p[1] = (unsigned char)column;
+                p[2] = (unsigned char)(row >> 8);
+                p[3] = (unsigned char)row;
+            }
+
+            return writer(&header[0], header.size());
+        }
+
+        void FrameDelta::setPrevious(std::vector<unsigned char> &frame, int width, int height)
+        {
+            m_previous.swap(frame);
+            m_width = width;
+            m_height = height;
+        }
+
+        void FrameDelta::reset()
+        {
+            std::vector<unsigned char>().swap(m_previous);
+            m_width = 0;
+            m_height = 0;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,69 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "PngEncoder.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Dirty tiles of a frame against the previous one, for captures of a mostly static screen.
+        //
+        // A delta starts with a 20 byte header: "SCRD", then width, height, tile size and number of
+        // dirty tiles, big endian 32 bit each. For every dirty tile follow its column and row as big
+        // endian 16 bit values, left to right and top to bottom. Then, unless no tile changed, an image
+        // in the requested format (png, raw or rle) with the dirty tiles stacked on top of each other in
+        // the same order: tile size wide, tile size times the number of tiles high. Tiles at the right
+        // and bottom edges are cut off by the frame, the rest of their area is padded with zeros.
+        class FrameDelta
+        {
+        public:
+            FrameDelta();
+
+            void setTileSize(int tileSize);
+            int tileSize() const { return m_tileSize; }
+
+            // False if there is no previous frame of the same size, then a full frame has to be sent
+            bool compare(const unsigned char *rgba, int width, int height, std::vector<uint32_t> &dirty) const;
+            size_t tileCount(int width, int height) const;
+
+            // The tiles of the frame stacked as described above
+            void gatherTiles(const unsigned char *rgba, int width, int height, const std::vector<uint32_t> &dirty, std::vector<unsigned char> &tiles) const;
+            bool writeHeader(int width, int height, const std::vector<uint32_t> &dirty, const PngEncoder::Writer &writer) const;
+
+            // The frame the receiver has now; takes over the buffer
+            void setPrevious(std::vector<unsigned char> &frame, int width, int height);
+            void reset();
+
+        private:
+            int m_tileSize;
+            std::vector<unsigned char> m_previous;
+            int m_width;
+            int m_height;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,223 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FrameFormat.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            const int BYTES_PER_PIXEL = 4;
+            const size_t HEADER_SIZE = 16;
+            const size_t OUTPUT_BUFFER = 64 * 1024;
+            const int MAX_LITERAL = 128;
+            const int MAX_REPEAT = 129;
+
+            void putUint32(unsigned char *p, uint32_t value)
+            {
+                p[0] = (unsigned char)(value >> 24);
+                p[1] = (unsigned char)(value >> 16);
+                p[2] = (unsigned char)(value >> 8);
+                p[3] = (unsigned char)value;
+            }
+
+            bool writeHeader(const char *magic, int width, int height, const PngEncoder::Writer &writer)
+            {
+                unsigned char header[HEADER_SIZE] = { 0 };
+                memcpy(header, magic, 4);
+                putUint32(header + 4, width);
+                putUint32(header + 8, height);
+                return writer(header, sizeof(header));
+            }
+
+            inline uint32_t pixelAt(const unsigned char *row, int x)
+            {
+                uint32_t value;
+                memcpy(&value, row + x * BYTES_PER_PIXEL, sizeof(value));
+                return value;
+            }
+
+            // Collects the output in blocks, so the writer is not called for every run
+            class BlockWriter
+            {
+            public:
+                BlockWriter(const PngEncoder::Writer &writer) : m_writer(writer), m_used(0), m_ok(true), m_buffer(OUTPUT_BUFFER) {}
+
+                unsigned char *reserve(size_t length)
+                {
+                    if (m_used + length > m_buffer.size())
+                        flush();
+                    unsigned char *p = &m_buffer[m_used];
+                    m_used += length;
+                    return p;
+                }
+
+                bool flush()
+                {
+                    if (m_ok && m_used > 0)
+                        m_ok = m_writer(&m_buffer[0], m_used);
+                    m_used = 0;
+                    return m_ok;
+                }
+
+                bool ok() const { return m_ok; }
+
+            private:
+                const PngEncoder::Writer &m_writer;
+                size_t m_used;
+                bool m_ok;
+                std::vector<unsigned char> m_buffer;
+            };
+        }
+
+        bool FrameFormat::parse(const std::string &name, Format &format)
+        {
+            if (name == "png")
+                format = FORMAT_PNG;
+            else if (name == "raw")
+                format = FORMAT_RAW;
+            else if (name == "rle")
+                format = FORMAT_RLE;
+            else
+                return false;
+
+            return true;
+        }
+
+        const char *FrameFormat::contentType(Format format)
+        {
+            return FORMAT_PNG == format ? "image/png" : "application/octet-stream";
+        }
+
+        bool FrameFormat::writeRaw(const unsigned char *rgba, int width, int height, int stride, const PngEncoder::Writer &writer)
+        {
+            if (NULL == rgba || width <= 0 || height <= 0 || stride < width * BYTES_PER_PIXEL)
+                return false;
+
+            if (!writeHeader("SCRW", width, height, writer))
+                return false;
+
+            const size_t bytes = (size_t)width * BYTES_PER_PIXEL;
+
+            if ((size_t)stride == bytes)
+                return writer(rgba, bytes * height);
+
+            for (int y = 0; y < height; y++)
+            {
+                if (!writer(rgba + (size_t)y * stride, bytes))
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool FrameFormat::writeRle(const unsigned char *rgba, int width, int height, int stride, const PngEncoder::Writer &writer)
+        {
+            if (NULL == rgba || width <= 0 || height <= 0 || stride < width * BYTES_PER_PIXEL)
+                return false;
+
+            if (!writeHeader("SCRL", width, height, writer))
+                return false;
+
+            BlockWriter out(writer);
+
+            for (int y = 0; y < height && out.ok(); y++)
+            {
+                const unsigned char *row = rgba + (size_t)y * stride;
+                int x = 0;
+
+                while (x < width)
+                {
+                    const uint32_t pixel = pixelAt(row, x);
+                    int run = 1;
+                    while (x + run < width && run < MAX_REPEAT && pixelAt(row, x + run) == pixel)
+                        run++;
+
+                    if (run > 1)
+                    {
+                        unsigned char *p = out.reserve(1 + BYTES_PER_PIXEL);
+                        p[0] = (unsigned char)(126 + run);
+                        memcpy(p + 1, &pixel, BYTES_PER_PIXEL);
+                        x += run;
+                        continue;
+                    }
+
+                    // Literals up to the next pair of equal pixels
+                    int start = x++;
+                    while (x < width && x - start < MAX_LITERAL && !(x + 1 < width && pixelAt(row, x) == pixelAt(row, x + 1)))
+                        x++;
+
+                    const int count = x - start;
+                    unsigned char *p = out.reserve(1 + (size_t)count * BYTES_PER_PIXEL);
+                    p[0] = (unsigned char)(count - 1);
+                    memcpy(p + 1, row + start * BYTES_PER_PIXEL, (size_t)count * BYTES_PER_PIXEL);
+                }
+            }
+
+            return out.flush();
+        }
+
+        void FrameFormat::downscale(const unsigned char *rgba, int width, int height, int stride, int factor,
+            std::vector<unsigned char> &out, int &outWidth, int &outHeight)
+        {
+            factor = std::max(1, std::min(factor, std::min(width, height)));
+            outWidth = width / factor;
+            outHeight = height / factor;
+
+            out.resize((size_t)outWidth * outHeight * BYTES_PER_PIXEL);
+
+            const unsigned int area = factor * factor;
+            std::vector<unsigned int> sums((size_t)outWidth * BYTES_PER_PIXEL);
+
+            for (int oy = 0; oy < outHeight; oy++)
+            {
+                std::fill(sums.begin(), sums.end(), 0);
+
+                // Row by row, so the source is read sequentially
+                for (int y = oy * factor; y < (oy + 1) * factor; y++)
+                {
+                    const unsigned char *src = rgba + (size_t)y * stride;
+                    unsigned int *sum = &sums[0];
+                    for (int ox = 0; ox < outWidth; ox++, sum += BYTES_PER_PIXEL)
+                    {
+                        for (int i = 0; i < factor; i++, src += BYTES_PER_PIXEL)
+                        {
+                            sum[0] += src[0];
+                            sum[1] += src[1];
+                            sum[2] += src[2];
+                            sum[3] += src[3];
+                        }
+                    }
+                }
+
+                unsigned char *dst = &out[(size_t)oy * outWidth * BYTES_PER_PIXEL];
+                for (size_t i = 0; i < sums.size(); i++)
+                    dst[i] = (unsigned char)((sums[i] + area / 2) / area);
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
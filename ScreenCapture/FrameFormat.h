@@ -0,0 +1,63 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "PngEncoder.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Cheaper alternatives to png for captures taken several times a second.
+        //
+        // Both start with a 16 byte header: a 4 byte magic ("SCRW" raw, "SCRL" run length encoded),
+        // then width, height and a reserved word, big endian. The pixels follow top to bottom as 8 bit
+        // RGBA. In the run length encoded variant every row is a series of runs; a control byte c < 128
+        // is followed by c + 1 literal pixels, c >= 128 by one pixel that repeats c - 126 times.
+        class FrameFormat
+        {
+        public:
+            enum Format
+            {
+                FORMAT_PNG,
+                FORMAT_RAW,
+                FORMAT_RLE
+            };
+
+            // "png", "raw" or "rle"
+            static bool parse(const std::string &name, Format &format);
+            static const char *contentType(Format format);
+
+            static bool writeRaw(const unsigned char *rgba, int width, int height, int stride, const PngEncoder::Writer &writer);
+            static bool writeRle(const unsigned char *rgba, int width, int height, int stride, const PngEncoder::Writer &writer);
+
+            // Box filter: every factor x factor block becomes one pixel, a partial block at the right
+            // or bottom edge is dropped
+            static void downscale(const unsigned char *rgba, int width, int height, int stride, int factor,
+                std::vector<unsigned char> &out, int &outWidth, int &outHeight);
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
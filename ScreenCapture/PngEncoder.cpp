@@ -0,0 +1,515 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PngEncoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCREENCAPTURE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCREENCAPTURE_SSE2
+#endif
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace
+        {
+            // Rows per stripe whatever the thread count, so the first IDAT is ready after this many rows;
+            // a fresh deflate stream starts without history, smaller stripes compress worse
+            const int STRIPE_ROWS = 64;
+            const int BYTES_PER_PIXEL = 4;
+            // First guess for the deflate output of a stripe, deflateLine() grows it as needed
+            const size_t MIN_STRIPE_OUTPUT = 64 * 1024;
+
+            struct Stripe
+            {
+                Stripe() : first(0), last(0), adler(0), length(0), ok(false), done(false) {}
+
+                int first;
+                int last;
+                std::vector<unsigned char> out; // raw deflate data
+                uLong adler;                    // of the filtered rows
+                uLong length;                   // filtered bytes
+                bool ok;
+                bool done;                      // guarded by Job::lock
+            };
+
+            // State shared by the threads encoding the stripes of one frame
+            struct Job
+            {
+                Job(const unsigned char *rgba, int width, int stride, int level, PngEncoder::Filter filter, int count, int window)
+                    : rgba(rgba), width(width), stride(stride), level(level), filter(filter), stripes(count)
+                    , next(0), written(0), window(window), abort(false) {}
+
+                const unsigned char *rgba;
+                int width;
+                int stride;
+                int level;
+                PngEncoder::Filter filter;
+                std::vector<Stripe> stripes;
+                int next;    // first stripe no worker took yet, guarded by lock
+                int written; // stripes handed to the writer, guarded by lock
+                int window;  // stripes encoded ahead of the writer at most
+                std::atomic<bool> abort; // set when the writer failed, the remaining rows are skipped
+                std::mutex lock;
+                std::condition_variable signal;
+            };
+
+            inline unsigned char paethPredictor(int a, int b, int c)
+            {
+                int p = a + b - c;
+                int pa = abs(p - a);
+                int pb = abs(p - b);
+                int pc = abs(p - c);
+                if (pa <= pb && pa <= pc)
+                    return a;
+                return (pb <= pc) ? b : c;
+            }
+
+            // Writes the filter type byte and the filtered row to out
+            void filterRow(PngEncoder::Filter filter, const unsigned char *row, const unsigned char *prev, size_t bytes, unsigned char *out)
+            {
+                out[0] = (unsigned char)filter;
+                out++;
+
+                switch (filter)
+                {
+                    case PngEncoder::FILTER_SUB:
+                        memcpy(out, row, BYTES_PER_PIXEL);
+                        for (size_t i = BYTES_PER_PIXEL; i < bytes; i++)
+                            out[i] = row[i] - row[i - BYTES_PER_PIXEL];
+                        break;
+                    case PngEncoder::FILTER_UP:
+                        for (size_t i = 0; i < bytes; i++)
+                            out[i] = row[i] - prev[i];
+                        break;
+                    case PngEncoder::FILTER_AVERAGE:
+                        for (size_t i = 0; i < BYTES_PER_PIXEL; i++)
+                            out[i] = row[i] - (prev[i] >> 1);
+                        for (size_t i = BYTES_PER_PIXEL; i < bytes; i++)
+                            out[i] = row[i] - ((row[i - BYTES_PER_PIXEL] + prev[i]) >> 1);
+                        break;
+                    case PngEncoder::FILTER_PAETH:
+                        for (size_t i = 0; i < BYTES_PER_PIXEL; i++)
+                            out[i] = row[i] - prev[i];
+                        for (size_t i = BYTES_PER_PIXEL; i < bytes; i++)
+                            out[i] = row[i] - paethPredictor(row[i - BYTES_PER_PIXEL], prev[i], prev[i - BYTES_PER_PIXEL]);
+                        break;
+                    default:
+                        memcpy(out, row, bytes);
+                        break;
+                }
+            }
+
+            // Sum of the filtered bytes taken as signed values, the heuristic recommended by the PNG
+            // specification; stops counting once it exceeds limit
+            unsigned long rowCost(const unsigned char *line, size_t bytes, unsigned long limit)
+            {
+                unsigned long cost = 0;
+                for (size_t i = 1; i <= bytes && cost <= limit; )
+                {
+                    size_t end = std::min(bytes + 1, i + 256);
+                    for (; i < end; i++)
+                        cost += (line[i] < 128) ? line[i] : 256 - line[i];
+                }
+                return cost;
+            }
+
+            bool deflateLine(z_stream &zs, std::vector<unsigned char> &out, int flush)
+            {
+                for (;;)
+                {
+                    if (0 == zs.avail_out)
+                    {
+                        size_t used = out.size();
+                        out.resize(used * 2);
+                        zs.next_out = &out[used];
+                        zs.avail_out = (uInt)used;
+                    }
+
+                    int ret = deflate(&zs, flush);
+                    if (Z_STREAM_ERROR == ret)
+                        return false;
+
+                    if (Z_FINISH == flush)
+                    {
+                        if (Z_STREAM_END == ret)
+                            return true;
+                    }
+                    else if (0 == zs.avail_in && 0 != zs.avail_out)
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            void encodeStripe(const unsigned char *rgba, int width, int stride, int level, PngEncoder::Filter filter, bool lastStripe, const std::atomic<bool> &abort, Stripe &stripe)
+            {
+                const size_t bytes = (size_t)width * BYTES_PER_PIXEL;
+
+                z_stream zs;
+                memset(&zs, 0, sizeof(zs));
+
+                // Negative window bits: raw deflate, the zlib header and trailer are written once for all stripes
+                if (Z_OK != deflateInit2(&zs, level, Z_DEFLATED, -15, 8, PngEncoder::FILTER_NONE == filter ? Z_DEFAULT_STRATEGY : Z_FILTERED))
+                    return;
+
+                std::vector<unsigned char> zero(bytes, 0);
+                std::vector<unsigned char> line(bytes + 1);
+                std::vector<unsigned char> candidate(PngEncoder::FILTER_ADAPTIVE == filter ? bytes + 1 : 0);
+
+                // Screens usually deflate to well under an eighth of the filtered size; starting at the
+                // worst case bound would zero several MB per frame only to throw most of it away
+                size_t filtered = (bytes + 1) * (stripe.last - stripe.first);
+                stripe.out.resize(std::min((size_t)deflateBound(&zs, filtered) + 16, std::max(filtered / 8, MIN_STRIPE_OUTPUT)));
+                zs.next_out = &stripe.out[0];
+                zs.avail_out = (uInt)stripe.out.size();
+
+                stripe.adler = adler32(0, Z_NULL, 0);
+                stripe.ok = true;
+
+                for (int y = stripe.first; y < stripe.last && stripe.ok && !abort.load(std::memory_order_relaxed); y++)
+                {
+                    const unsigned char *row = rgba + (size_t)y * stride;
+                    const unsigned char *prev = (0 == y) ? &zero[0] : row - stride;
+
+                    if (PngEncoder::FILTER_ADAPTIVE == filter)
+                    {
+                        unsigned long best = (unsigned long)-1;
+                        for (int f = PngEncoder::FILTER_NONE; f < PngEncoder::FILTER_ADAPTIVE; f++)
+                        {
+                            filterRow((PngEncoder::Filter)f, row, prev, bytes, &candidate[0]);
+                            unsigned long cost = rowCost(&candidate[0], bytes, best);
+                            if (cost < best)
+                            {
+                                best = cost;
+                                line.swap(candidate);
+                            }
+                        }
+                    }
+                    else
+                    {
+                        filterRow(filter, row, prev, bytes, &line[0]);
+                    }
+
+                    stripe.adler = adler32(stripe.adler, &line[0], (uInt)line.size());
+
+                    int flush = Z_NO_FLUSH;
+                    if (y + 1 == stripe.last)
+                        flush = lastStripe ? Z_FINISH : Z_SYNC_FLUSH;
+
+                    zs.next_in = &line[0];
+                    zs.avail_in = (uInt)line.size();
+                    stripe.ok = deflateLine(zs, stripe.out, flush);
+                }
+
+                stripe.length = (uLong)filtered;
+                stripe.out.resize(zs.total_out);
+                if (stripe.out.capacity() > 2 * stripe.out.size())
+                    std::vector<unsigned char>(stripe.out).swap(stripe.out);
+
+                deflateEnd(&zs);
+            }
+
+            void runStripe(Job &job, int index)
+            {
+                Stripe &stripe = job.stripes[index];
+                encodeStripe(job.rgba, job.width, job.stride, job.level, job.filter, index + 1 == (int)job.stripes.size(), job.abort, stripe);
+
+                std::lock_guard<std::mutex> lock(job.lock);
+                stripe.done = true;
+                job.signal.notify_all();
+            }
+
+            // Takes the next stripe in order until none is left, staying at most window stripes ahead
+            // of the writer so a slow writer doesn't have the whole frame buffered
+            void runWorker(Job &job)
+            {
+                const int count = (int)job.stripes.size();
+
+                for (;;)
+                {
+                    int index;
+                    {
+                        std::unique_lock<std::mutex> lock(job.lock);
+                        job.signal.wait(lock, [&job, count] {
+                            return job.abort || job.next >= count || job.next < job.written + job.window;
+                        });
+                        if (job.abort || job.next >= count)
+                            return;
+                        index = job.next++;
+                    }
+                    runStripe(job, index);
+                }
+            }
+
+            void putUint32(unsigned char *p, uint32_t value)
+            {
+                p[0] = (unsigned char)(value >> 24);
+                p[1] = (unsigned char)(value >> 16);
+                p[2] = (unsigned char)(value >> 8);
+                p[3] = (unsigned char)value;
+            }
+
+            struct Piece
+            {
+                const unsigned char *data;
+                size_t length;
+            };
+
+            bool writeChunk(const PngEncoder::Writer &writer, const char *type, const Piece *pieces, size_t count)
+            {
+                size_t length = 0;
+                for (size_t i = 0; i < count; i++)
+                    length += pieces[i].length;
+
+                unsigned char header[8];
+                putUint32(header, (uint32_t)length);
+                memcpy(header + 4, type, 4);
+
+                uLong crc = crc32(0, header + 4, 4);
+                if (!writer(header, sizeof(header)))
+                    return false;
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (0 == pieces[i].length)
+                        continue;
+                    crc = crc32(crc, pieces[i].data, (uInt)pieces[i].length);
+                    if (!writer(pieces[i].data, pieces[i].length))
+                        return false;
+                }
+
+                unsigned char trailer[4];
+                putUint32(trailer, (uint32_t)crc);
+                return writer(trailer, sizeof(trailer));
+            }
+        }
+
+        void swapRedBlue(unsigned char *data, size_t pixels)
+        {
+            size_t i = 0;
+
+#if defined(SCREENCAPTURE_NEON)
+            for (; i + 16 <= pixels; i += 16)
+            {
+                uint8x16x4_t v = vld4q_u8(data + i * 4);
+                uint8x16_t red = v.val[0];
+                v.val[0] = v.val[2];
+                v.val[2] = red;
+                vst4q_u8(data + i * 4, v);
+            }
+#elif defined(SCREENCAPTURE_SSE2)
+            const __m128i mask = _mm_set1_epi32(0x00ff00ff);
+            for (; i + 4 <= pixels; i += 4)
+            {
+                __m128i *p = (__m128i *)(data + i * 4);
+                __m128i v = _mm_loadu_si128(p);
+                // Little endian pixel 0xAABBGGRR: rotating the R/B bytes by 16 bits swaps them
+                __m128i rb = _mm_and_si128(v, mask);
+                __m128i ga = _mm_andnot_si128(mask, v);
+                rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+                _mm_storeu_si128(p, _mm_or_si128(rb, ga));
+            }
+#endif
+
+            for (; i < pixels; i++)
+            {
+                unsigned char *p = data + i * 4;
+                unsigned char red = p[0];
+                p[0] = p[2];
+                p[2] = red;
+            }
+        }
+
+        PngEncoder::PngEncoder()
+            : m_level(Z_DEFAULT_COMPRESSION)
+            , m_filter(FILTER_ADAPTIVE)
+            , m_threads(0)
+        {
+        }
+
+        void PngEncoder::setCompressionLevel(int level)
+        {
+            m_level = (level < 0 || level > 9) ? Z_DEFAULT_COMPRESSION : level;
+        }
+
+        void PngEncoder::setFilter(Filter filter)
+        {
+            m_filter = filter;
+        }
+
+        void PngEncoder::setThreads(unsigned int threads)
+        {
+            m_threads = threads;
+        }
+
+        bool PngEncoder::parseFilter(const std::string &name, Filter &filter)
+        {
+            static const char *names[] = { "none", "sub", "up", "average", "paeth", "adaptive" };
+
+            for (int i = FILTER_NONE; i <= FILTER_ADAPTIVE; i++)
+            {
+                if (name == names[i])
+                {
+                    filter = (Filter)i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool PngEncoder::encode(const unsigned char *rgba, int width, int height, int stride, const Writer &writer) const
+        {
+            if (NULL == rgba || width <= 0 || height <= 0 || stride < width * BYTES_PER_PIXEL)
+                return false;
+
+            unsigned int threads = m_threads;
+            if (0 == threads)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+
+            int count = (height + STRIPE_ROWS - 1) / STRIPE_ROWS;
+            threads = std::min(threads, (unsigned int)count);
+
+            // Header first, so a streaming writer can start sending before anything is compressed
+            static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+            if (!writer(signature, sizeof(signature)))
+                return false;
+
+            unsigned char ihdr[13];
+            putUint32(ihdr, width);
+            putUint32(ihdr + 4, height);
+            ihdr[8] = 8;  // bit depth
+            ihdr[9] = 6;  // color type RGBA
+            ihdr[10] = 0; // deflate
+            ihdr[11] = 0; // adaptive filtering
+            ihdr[12] = 0; // no interlace
+            Piece header = { ihdr, sizeof(ihdr) };
+            if (!writeChunk(writer, "IHDR", &header, 1))
+                return false;
+
+            Job job(rgba, width, stride, m_level, m_filter, count, 2 * threads);
+            std::vector<std::thread> workers;
+
+            for (int i = 0; i < count; i++)
+            {
+                job.stripes[i].first = i * STRIPE_ROWS;
+                job.stripes[i].last = std::min(height, (i + 1) * STRIPE_ROWS);
+            }
+
+            // With one thread the calling thread encodes each stripe right before writing it, otherwise
+            // it only writes and the workers encode
+            for (unsigned int i = 0; i < threads && threads > 1; i++)
+            {
+                try
+                {
+                    workers.emplace_back(runWorker, std::ref(job));
+                }
+                catch (const std::system_error &)
+                {
+                    break;
+                }
+            }
+
+            // zlib header: 32K window, level hint as zlib would set it
+            unsigned char zlibHeader[2] = { 0x78, 0x9c };
+            if (m_level == 0 || m_level == 1)
+                zlibHeader[1] = 0x01;
+            else if (m_level >= 2 && m_level <= 5)
+                zlibHeader[1] = 0x5e;
+            else if (m_level >= 7)
+                zlibHeader[1] = 0xda;
+
+            unsigned char zlibTrailer[4];
+            uLong adler = 0;
+            bool ok = true;
+
+            // Each stripe is written as soon as it and the ones before it are done
+            for (int i = 0; i < count && ok; i++)
+            {
+                Stripe &stripe = job.stripes[i];
+                bool encode = workers.empty();
+                if (!encode)
+                {
+                    std::unique_lock<std::mutex> lock(job.lock);
+                    // Not taken by a worker yet, they are busy or none could be started: encode it here
+                    job.signal.wait(lock, [&stripe, &job, i] { return stripe.done || job.next <= i; });
+                    if (!stripe.done)
+                    {
+                        job.next = i + 1;
+                        encode = true;
+                    }
+                }
+                if (encode)
+                    runStripe(job, i);
+
+                if (!stripe.ok)
+                {
+                    ok = false;
+                    break;
+                }
+
+                adler = (0 == i) ? stripe.adler : adler32_combine(adler, stripe.adler, stripe.length);
+                putUint32(zlibTrailer, (uint32_t)adler);
+
+                Piece pieces[3] = {
+                    { zlibHeader, (size_t)(0 == i ? sizeof(zlibHeader) : 0) },
+                    { stripe.out.empty() ? NULL : &stripe.out[0], stripe.out.size() },
+                    { zlibTrailer, (size_t)(i + 1 == count ? sizeof(zlibTrailer) : 0) }
+                };
+                ok = writeChunk(writer, "IDAT", pieces, 3);
+
+                // Done with it, give the memory back early
+                std::vector<unsigned char>().swap(stripe.out);
+
+                std::lock_guard<std::mutex> lock(job.lock);
+                job.written = i + 1;
+                job.signal.notify_all();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(job.lock);
+                if (!ok)
+                    job.abort = true;
+                job.signal.notify_all();
+            }
+
+            for (auto &worker : workers)
+                worker.join();
+
+            return ok && writeChunk(writer, "IEND", NULL, 0);
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
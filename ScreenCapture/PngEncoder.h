@@ -0,0 +1,79 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Converts 32 bit BGRA pixels to RGBA (and back) in place, 16 pixels at a time with NEON or SSE2
+        void swapRedBlue(unsigned char *data, size_t pixels);
+
+        // PNG encoder for 8 bit RGBA frames.
+        //
+        // The rows are split into horizontal stripes of a fixed height, whatever the number of threads,
+        // that a pool of threads filters and deflates in order; with one thread each stripe is encoded
+        // right before it is written. Every stripe but the last ends with a sync flush, so the raw deflate streams concatenate into
+        // one valid zlib stream; the Adler-32 checksums of the stripes are combined for its trailer.
+        // Each stripe becomes one IDAT chunk, handed to the writer as soon as it and the stripes before
+        // it are done, so a streaming writer sends while the rest of the frame is still compressed.
+        class PngEncoder
+        {
+        public:
+            enum Filter
+            {
+                FILTER_NONE = 0,
+                FILTER_SUB = 1,
+                FILTER_UP = 2,
+                FILTER_AVERAGE = 3,
+                FILTER_PAETH = 4,
+                FILTER_ADAPTIVE = 5 // per row, the filter with the smallest sum of absolute differences
+            };
+
+            // Receives the encoded file in order; returning false aborts the encoding
+            typedef std::function<bool(const unsigned char *data, size_t length)> Writer;
+
+            PngEncoder();
+
+            // zlib level, 0 (store) to 9 (best), -1 for the zlib default
+            void setCompressionLevel(int level);
+            void setFilter(Filter filter);
+            // 0 uses one thread per core
+            void setThreads(unsigned int threads);
+
+            // "none", "sub", "up", "average", "paeth" or "adaptive"
+            static bool parseFilter(const std::string &name, Filter &filter);
+
+            bool encode(const unsigned char *rgba, int width, int height, int stride, const Writer &writer) const;
+
+        private:
+            int m_level;
+            Filter m_filter;
+            unsigned int m_threads;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -26,12 +26,12 @@
 #include <nxclient.h>
 #endif
 
-#include <png.h>
-#include <curl/curl.h>
-
 // Methods
 #define METHOD_UPLOAD "uploadScreenCapture"
 
+// Thumbnails go down to 1/16 of the screen in each direction
+#define MAX_SCALE 16
+
 // Events
 #define EVT_UPLOAD_COMPLETE "uploadComplete"
 
@@ -58,6 +58,27 @@ namespace WPEFramework
             Register(METHOD_UPLOAD, &ScreenCapture::uploadScreenCapture, this);
         }
 
+        const string ScreenCapture::Initialize(PluginHost::IShell* service)
+        {
+            LOGINFO();
+
+            Config config;
+            config.FromString(service->ConfigLine());
+
+            PngEncoder::Filter filter = PngEncoder::FILTER_ADAPTIVE;
+            if (!config.Filter.Value().empty() && !PngEncoder::parseFilter(config.Filter.Value(), filter))
+                LOGWARN("unknown png filter '%s', using adaptive", config.Filter.Value().c_str());
+
+            m_encoder.setCompressionLevel(config.CompressionLevel.Value());
+            m_encoder.setFilter(filter);
+            m_encoder.setThreads(config.EncoderThreads.Value());
+            m_delta.setTileSize(config.DeltaTileSize.Value());
+            LOGINFO("png compression level %d, filter %d, %u encoder threads (0: one per core), %d pixel delta tiles",
+                config.CompressionLevel.Value(), filter, config.EncoderThreads.Value(), m_delta.tileSize());
+
+            return "";
+        }
+
         ScreenCapture::~ScreenCapture()
         {
             LOGINFO();
@@ -84,7 +105,30 @@ namespace WPEFramework
             if(parameters.HasLabel("callGUID"))
               callGUID = parameters["callGUID"].String();
 
-            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this, parameters["url"].String(), callGUID ) );
+            FrameFormat::Format format = FrameFormat::FORMAT_PNG;
+            if(parameters.HasLabel("format") && !FrameFormat::parse(parameters["format"].String(), format))
+            {
+                response["message"] = "Unsupported format, expected png, raw or rle";
+
+                returnResponse(false);
+            }
+
+            // An unparsable scale becomes 0 and is rejected below
+            int scale = 1;
+            if(parameters.HasLabel("scale"))
+                getNumberParameter("scale", scale);
+            if(scale < 1 || scale > MAX_SCALE)
+            {
+                response["message"] = "Scale must be between 1 and " + std::to_string(MAX_SCALE);
+
+                returnResponse(false);
+            }
+
+            bool delta = false;
+            if(parameters.HasLabel("delta"))
+                getBoolParameter("delta", delta);
+
+            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this, parameters["url"].String(), callGUID, format, scale, delta ) );
 
             returnResponse(true);
         }
@@ -97,36 +141,97 @@ namespace WPEFramework
                 return 0;
             }
 
-            m_screenCapture->doUploadScreenCapture(url, callGUID);
+            m_screenCapture->doUploadScreenCapture(url, callGUID, format, scale, delta);
 
             return 0;
         }
 
-        bool ScreenCapture::doUploadScreenCapture(std::string url, std::string callGUID)
+        bool ScreenCapture::doUploadScreenCapture(std::string url, std::string callGUID, FrameFormat::Format format, int scale, bool delta)
         {
-            std::vector<unsigned char> png_data;
+            std::vector<unsigned char> frame;
+            int width = 0;
+            int height = 0;
             bool got_screenshot = false;
 
             #ifdef PLATFORM_BROADCOM
-            got_screenshot = getScreenshotNexus(png_data);
+            got_screenshot = getScreenshotNexus(frame, width, height);
             #endif
 
             #ifdef PLATFORM_INTEL
-            got_screenshot = getScreenshotIntel(png_data);
+            got_screenshot = getScreenshotIntel(frame, width, height);
             #endif
 
+            if(got_screenshot && scale > 1)
+            {
+                std::vector<unsigned char> thumbnail;
+                int thumbnailWidth, thumbnailHeight;
+                FrameFormat::downscale(&frame[0], width, height, 4 * width, scale, thumbnail, thumbnailWidth, thumbnailHeight);
+
+                frame.swap(thumbnail);
+                width = thumbnailWidth;
+                height = thumbnailHeight;
+            }
+
             if(got_screenshot)
             {
                 std::string error_str;
+                bool uploaded = false;
+
+                // Deltas only go to the receiver that has the previous frame, and only while they are
+                // smaller than a full frame
+                std::vector<uint32_t> dirty;
+                bool send_delta = delta && url == m_deltaUrl && m_delta.compare(&frame[0], width, height, dirty)
+                    && dirty.size() * 2 <= m_delta.tileCount(width, height);
 
-                LOGWARN("uploading %d of png data to '%s'", png_data.size(), url.c_str() );
+                if(send_delta)
+                {
+                    LOGWARN("uploading %zu changed tiles of the %dx%d frame as %s to '%s'", dirty.size(), width, height, FrameFormat::contentType(format), url.c_str() );
+
+                    std::vector<unsigned char> tiles;
+                    m_delta.gatherTiles(&frame[0], width, height, dirty, tiles);
 
-                if(uploadDataToUrl(png_data, url.c_str(), error_str))
+                    uploaded = m_upload.post(url, "application/octet-stream", [&](const PngEncoder::Writer &writer) {
+                        return m_delta.writeHeader(width, height, dirty, writer)
+                            && (dirty.empty() || encodeFrame(&tiles[0], m_delta.tileSize(), m_delta.tileSize() * (int)dirty.size(), format, writer));
+                    }, error_str);
+                }
+                else
+                {
+                    LOGWARN("uploading %dx%d frame as %s to '%s'", width, height, FrameFormat::contentType(format), url.c_str() );
+
+                    // Encoded straight into the upload, the encoded file is never held as a whole
+                    uploaded = m_upload.post(url, FrameFormat::contentType(format), [&](const PngEncoder::Writer &writer) {
+                        return encodeFrame(&frame[0], width, height, format, writer);
+                    }, error_str);
+                }
+
+                // A plain capture to the delta receiver replaces its frame too, so the next delta is based on it
+                if(delta || (!m_deltaUrl.empty() && url == m_deltaUrl))
+                {
+                    // After a failed upload it is unknown what the receiver has, the next one is a full frame
+                    if(uploaded)
+                    {
+                        m_delta.setPrevious(frame, width, height);
+                        m_deltaUrl = url;
+                    }
+                    else
+                    {
+                        m_delta.reset();
+                        m_deltaUrl.clear();
+                    }
+                }
+
+                if(uploaded)
                 {
                     JsonObject params;
                     params["status"] = true;
                     params["message"] = "Success";
                     params["call_guid"] = callGUID;
+                    if(delta)
+                    {
+                        params["delta"] = send_delta;
+                        params["changedTiles"] = (int)(send_delta ? dirty.size() : m_delta.tileCount(width, height));
+                    }
 
                     sendNotify(EVT_UPLOAD_COMPLETE, params);
 
@@ -160,24 +265,28 @@ namespace WPEFramework
         }
 
 #ifdef PLATFORM_INTEL
-        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &frame, int &width, int &height)
         {
-            int i;
             char *filename = "/proc/gdl/dump/wbp";    //both video and guide graphics, potentially at lower 720x480
 //             char *filename = "/proc/gdl/dump/upp_d"; //graphics only, normally at higher 1280x720
 //             char *filename = "/proc/gdl/dump/upp_a"; //video only, normally at higher 1280x720
 
             FILE* fp = fopen(filename, "rb");
 
-            unsigned char info[56];
-            fread(info, sizeof(unsigned char), 56, fp); // read the 54-byte header
-
             if(!fp)
             {
                 LOGERR("Error: could not open image file '%s'", filename);
                 return false;
             }
 
+            unsigned char info[56];
+            if(fread(info, sizeof(unsigned char), 56, fp) != 56) // read the 54-byte header
+            {
+                LOGERR("Error: could not read the header of '%s'", filename);
+                fclose(fp);
+                return false;
+            }
+
             // extract image height and width from header
             int w = abs(*(int*)&info[18]);
             int h = abs(*(int*)&info[22]);
@@ -189,29 +298,21 @@ namespace WPEFramework
             if(size < 1)
             {
                 LOGERR("Error: png data size < 1");
+                fclose(fp);
                 return false;
             }
 
-            std::vector<unsigned char> data_v(size);
-            std::vector<unsigned char> new_data_v(size);
-
-            unsigned char* data = &data_v[0];
-            unsigned char* new_data = &new_data_v[0];
+            frame.resize(size);
+            unsigned char* data = &frame[0];
 
             fread(data, sizeof(unsigned char), size, fp); // read the rest of the data at once
             fclose(fp);
 
-            for(i = 0; i < size; i += 4)
-            {
-                //r and b need swapped?
-                new_data[i+0] = data[i+2];
-                new_data[i+1] = data[i+1];
-                new_data[i+2] = data[i+0];
-                new_data[i+3] = data[i+3];
-            }
+            // BGRA to RGBA, in place
+            swapRedBlue(data, w * h);
 
-            //convert to png
-            saveToPng(new_data, w, h, png_out_data);
+            width = w;
+            height = h;
 
             return true;
         }
@@ -243,7 +344,7 @@ namespace WPEFramework
             return true;
         }
 
-        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &frame, int &width, int &height)
         {
             if(!joinNexus())
             {
@@ -275,8 +376,8 @@ namespace WPEFramework
             //defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
             defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_B8_G8_R8;
             int bytesPerPixel = 4;
-            std::vector<unsigned char> data_v(1280 * 720 * 4);
-            unsigned char *bytes = &data_v[0];
+            frame.resize(1280 * 720 * 4);
+            unsigned char *bytes = &frame[0];
 //             unsigned char bytes[1280 * 720 * 4];
 
 
@@ -324,173 +425,40 @@ namespace WPEFramework
                 return false;
             }
 
-            if(!saveToPng(bytes, defSurfSettings.width, defSurfSettings.height, png_out_data))
-            {
-                LOGERR("could not convert Nexus screenshot to png");
-                return false;
-            }
-            else
-                return true;
-        }
-#endif
+            width = defSurfSettings.width;
+            height = defSurfSettings.height;
 
-        static void PngWriteCallback(png_structp  png_ptr, png_bytep data, png_size_t length)
-        {
-            std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
-            p->insert(p->end(), data, data + length);
+            return true;
         }
+#endif
 
-        bool ScreenCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        bool ScreenCapture::encodeFrame(const unsigned char *rgba, int width, int height, FrameFormat::Format format, const PngEncoder::Writer &writer)
         {
-            CURL *curl;
-            CURLcode res;
-            bool call_succeeded = true;
-
-            if(!url || !strlen(url))
+            if (NULL == rgba)
             {
-                LOGERR("no url given");
+                LOGERR("Error: failed to encode the frame because the given data is NULL.");
                 return false;
             }
 
-            LOGWARN("uploading png data of size %u to '%s'", data.size(), url);
-
-            //init curl
-            curl_global_init(CURL_GLOBAL_ALL);
-            curl = curl_easy_init();
-
-            if(!curl)
-            {
-                LOGERR("could not init curl\n");
-                return false;
-            }
-
-            //create header
-            struct curl_slist *chunk = NULL;
-            chunk = curl_slist_append(chunk, "Content-Type: image/png");
-
-            //set url and data
-            curl_easy_setopt(curl, CURLOPT_URL, url);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
-
-            //perform blocking upload call
-            res = curl_easy_perform(curl);
+            bool ok = false;
 
-            //output success / failure log
-            if(CURLE_OK == res)
+            switch (format)
             {
-                long response_code;
-
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-                if(600 > response_code && response_code >= 400)
-                {
-                    LOGERR("uploading failed with response code %ld\n", response_code);
-                    error_str = std::string("response code:") + std::to_string(response_code);
-                    call_succeeded = false;
-                }
-                else
-                    LOGWARN("upload done");
+            case FrameFormat::FORMAT_RAW:
+                ok = FrameFormat::writeRaw(rgba, width, height, 4 * width, writer);
+                break;
+            case FrameFormat::FORMAT_RLE:
+                ok = FrameFormat::writeRle(rgba, width, height, 4 * width, writer);
+                break;
+            default:
+                ok = m_encoder.encode(rgba, width, height, 4 * width, writer);
+                break;
             }
-            else
-            {
-                LOGERR("upload failed with error %d:'%s'", res, curl_easy_strerror(res));
-                error_str = std::to_string(res) + std::string(":'") + std::string(curl_easy_strerror(res)) + std::string("'");
-                call_succeeded = false;
-            }
-
-            //clean up curl object
-            curl_easy_cleanup(curl);
-            curl_slist_free_all(chunk);
-
-            return call_succeeded;
-        }
 
-        bool ScreenCapture::saveToPng(unsigned char *data, int width, int height, std::vector<unsigned char> &png_out_data)
-        {
-            int bitdepth = 8;
-            int colortype = PNG_COLOR_TYPE_RGBA;
-            int pitch = 4 * width;
-            int transform = PNG_TRANSFORM_IDENTITY;
-
-            int i = 0;
-            int r = 0;
-            png_structp png_ptr = NULL;
-            png_infop info_ptr = NULL;
-            png_bytep* row_pointers = NULL;
-
-            if (NULL == data)
-            {
-                LOGERR("Error: failed to save the png because the given data is NULL.");
-                r = -1;
-                goto error;
-            }
-
-            if (0 == pitch)
-            {
-                LOGERR("Error: failed to save the png because the given pitch is 0.");
-                r = -3;
-                goto error;
-            }
-
-            png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-            if (NULL == png_ptr)
-            {
-                LOGERR("Error: failed to create the png write struct.");
-                r = -5;
-                goto error;
-            }
-
-            info_ptr = png_create_info_struct(png_ptr);
-            if (NULL == info_ptr)
-            {
-                LOGERR("Error: failed to create the png info struct.");
-                r = -6;
-                goto error;
-            }
-
-            png_set_IHDR(png_ptr,
-                            info_ptr,
-                            width,
-                            height,
-                            bitdepth,                 /* e.g. 8 */
-                            colortype,                /* PNG_COLOR_TYPE_{GRAY, PALETTE, RGB, RGB_ALPHA, GRAY_ALPHA, RGBA, GA} */
-                            PNG_INTERLACE_NONE,       /* PNG_INTERLACE_{NONE, ADAM7 } */
-                            PNG_COMPRESSION_TYPE_BASE,
-                            PNG_FILTER_TYPE_BASE);
-
-            row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-
-            for (i = 0; i < height; ++i)
-                row_pointers[i] = data + i * pitch;
-
-            png_set_write_fn(png_ptr, &png_out_data, PngWriteCallback, NULL);
-            png_set_rows(png_ptr, info_ptr, row_pointers);
-            png_write_png(png_ptr, info_ptr, transform, NULL);
-
-            error:
-
-            if (NULL != png_ptr)
-            {
-
-                if (NULL == info_ptr)
-                {
-                    LOGERR("Error: info ptr is null. not supposed to happen here.\n");
-                }
-
-                png_destroy_write_struct(&png_ptr, &info_ptr);
-                png_ptr = NULL;
-                info_ptr = NULL;
-            }
-
-            if (NULL != row_pointers)
-            {
-                free(row_pointers);
-                row_pointers = NULL;
-            }
+            if (!ok)
+                LOGERR("Error: failed to encode or send the %dx%d frame", width, height);
 
-            return (r==0);
+            return ok;
         }
 
     } // namespace Plugin
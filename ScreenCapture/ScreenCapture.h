@@ -23,6 +23,10 @@
 #include <vector>
 
 #include "tptimer.h"
+#include "PngEncoder.h"
+#include "FrameFormat.h"
+#include "FrameDelta.h"
+#include "StreamUpload.h"
 
 #include "Module.h"
 #include "utils.h"
@@ -41,8 +45,9 @@ namespace WPEFramework {
             ScreenShotJob& operator=(const ScreenShotJob& RHS) = delete;
 
         public:
-            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt, std::string _url, std::string _callGUID) : m_screenCapture(tpt), url(_url), callGUID(_callGUID) { }
-            ScreenShotJob(const ScreenShotJob& copy) : m_screenCapture(copy.m_screenCapture), url(copy.url), callGUID(copy.callGUID) { }
+            ScreenShotJob(WPEFramework::Plugin::ScreenCapture* tpt, std::string _url, std::string _callGUID, FrameFormat::Format _format = FrameFormat::FORMAT_PNG, int _scale = 1, bool _delta = false)
+                : m_screenCapture(tpt), url(_url), callGUID(_callGUID), format(_format), scale(_scale), delta(_delta) { }
+            ScreenShotJob(const ScreenShotJob& copy) : m_screenCapture(copy.m_screenCapture), url(copy.url), callGUID(copy.callGUID), format(copy.format), scale(copy.scale), delta(copy.delta) { }
             ~ScreenShotJob() {}
 
             inline bool operator==(const ScreenShotJob& RHS) const
@@ -59,6 +64,9 @@ namespace WPEFramework {
             WPEFramework::Plugin::ScreenCapture* m_screenCapture;
             std::string url;
             std::string callGUID;
+            FrameFormat::Format format;
+            int scale;
+            bool delta;
         };
 
         // This is a server for a JSONRPC communication channel.
@@ -74,6 +82,36 @@ namespace WPEFramework {
         // this class exposes a public method called, Notify(), using this methods, all subscribed clients
         // will receive a JSONRPC message as a notification, in case this method is called.
         class ScreenCapture : public AbstractPlugin {
+        public:
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : Core::JSON::Container()
+                    , CompressionLevel(-1)
+                    , Filter(_T("adaptive"))
+                    , EncoderThreads(0)
+                    , DeltaTileSize(32)
+                {
+                    Add(_T("compressionlevel"), &CompressionLevel);
+                    Add(_T("filter"), &Filter);
+                    Add(_T("encoderthreads"), &EncoderThreads);
+                    Add(_T("deltatilesize"), &DeltaTileSize);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::DecSInt8 CompressionLevel; // zlib level 0-9, -1 for the zlib default
+                Core::JSON::String Filter; // png row filter: none, sub, up, average, paeth or adaptive
+                Core::JSON::DecUInt8 EncoderThreads; // threads deflating stripes of the frame, 0 for one per core
+                Core::JSON::DecUInt16 DeltaTileSize; // edge of the tiles compared for delta captures, 8 to 256 pixels
+            };
+
         private:
 
             // We do not allow this plugin to be copied !!
@@ -85,21 +123,21 @@ namespace WPEFramework {
             //End methods
 
             #ifdef PLATFORM_BROADCOM
-            bool getScreenshotNexus(std::vector<unsigned char> &png_data);
+            bool getScreenshotNexus(std::vector<unsigned char> &frame, int &width, int &height);
             bool joinNexus();
             #endif
 
             #ifdef PLATFORM_INTEL
-            bool getScreenshotIntel(std::vector<unsigned char> &png_data);
+            bool getScreenshotIntel(std::vector<unsigned char> &frame, int &width, int &height);
             #endif
 
-            bool saveToPng(unsigned char *bytes, int w, int h, std::vector<unsigned char> &png_out_data);
-            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str);
-            bool doUploadScreenCapture(std::string url, std::string callGUID);
+            bool encodeFrame(const unsigned char *rgba, int width, int height, FrameFormat::Format format, const PngEncoder::Writer &writer);
+            bool doUploadScreenCapture(std::string url, std::string callGUID, FrameFormat::Format format, int scale, bool delta);
 
         public:
             ScreenCapture();
             virtual ~ScreenCapture();
+            virtual const string Initialize(PluginHost::IShell* service) override;
 
         public:
             static ScreenCapture* _instance;
@@ -108,6 +146,13 @@ namespace WPEFramework {
 
             WPEFramework::Core::TimerType<ScreenShotJob> *screenShotDispatcher;
 
+            PngEncoder m_encoder;
+            StreamUpload m_upload;
+
+            // Only used on the dispatcher thread
+            FrameDelta m_delta;
+            std::string m_deltaUrl; // receiver of the frame in m_delta
+
             #ifdef PLATFORM_BROADCOM
             bool inNexus;
             #endif
@@ -0,0 +1,249 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "StreamUpload.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+#include "utils.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            std::once_flag curlInit;
+
+            // A receiver that stops reading would otherwise block the encoder in write() for good
+            const long CONNECT_TIMEOUT_SEC = 10;
+            const long STALL_TIME_SEC = 15;   // below STALL_SPEED bytes per second for this long
+            const long STALL_SPEED = 1;
+            const long TRANSFER_TIMEOUT_SEC = 300;
+        }
+
+        StreamUpload::StreamUpload(size_t pipeSize)
+            : m_curl(NULL)
+            , m_pipe(std::max(pipeSize, (size_t)CURL_MAX_WRITE_SIZE))
+            , m_head(0)
+            , m_used(0)
+            , m_eof(false)
+            , m_aborted(false)
+            , m_finished(false)
+            , m_sent(0)
+        {
+            // Not thread safe and process wide, never cleaned up: other plugins in the process may use curl
+            std::call_once(curlInit, []() { curl_global_init(CURL_GLOBAL_ALL); });
+        }
+
+        StreamUpload::~StreamUpload()
+        {
+            if (m_curl)
+                curl_easy_cleanup(m_curl);
+        }
+
+        bool StreamUpload::post(const std::string &url, const std::string &contentType, const Producer &produce, std::string &error)
+        {
+            std::lock_guard<std::mutex> guard(m_postMutex);
+
+            if (url.empty())
+            {
+                LOGERR("no url given");
+                error = "no url given";
+                return false;
+            }
+
+            if (!m_curl)
+                m_curl = curl_easy_init();
+            else
+                curl_easy_reset(m_curl); // keeps the connection cache
+
+            if (!m_curl)
+            {
+                LOGERR("could not init curl");
+                error = "could not init curl";
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_head = 0;
+                m_used = 0;
+                m_eof = false;
+                m_aborted = false;
+                m_finished = false;
+                m_sent = 0;
+            }
+
+            struct curl_slist *headers = NULL;
+            headers = curl_slist_append(headers, ("Content-Type: " + contentType).c_str());
+            headers = curl_slist_append(headers, "Transfer-Encoding: chunked");
+            headers = curl_slist_append(headers, "Expect:"); // no round trip for 100-continue
+
+            curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(m_curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, headers);
+            curl_easy_setopt(m_curl, CURLOPT_READFUNCTION, &StreamUpload::readCallback);
+            curl_easy_setopt(m_curl, CURLOPT_READDATA, this);
+            curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(m_curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_SEC);
+            curl_easy_setopt(m_curl, CURLOPT_LOW_SPEED_LIMIT, STALL_SPEED);
+            curl_easy_setopt(m_curl, CURLOPT_LOW_SPEED_TIME, STALL_TIME_SEC);
+            curl_easy_setopt(m_curl, CURLOPT_TIMEOUT, TRANSFER_TIMEOUT_SEC);
+
+            CURLcode res = CURLE_OK;
+
+            std::thread sender;
+            try
+            {
+                sender = std::thread([this, &res]() {
+                    res = curl_easy_perform(m_curl);
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_finished = true;
+                    m_writable.notify_all();
+                });
+            }
+            catch (const std::system_error &e)
+            {
+                LOGERR("could not start the upload thread: %s", e.what());
+                error = "could not start the upload thread";
+                curl_slist_free_all(headers);
+                return false;
+            }
+
+            bool produced = produce([this](const unsigned char *data, size_t length) { return write(data, length); });
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (produced)
+                    m_eof = true;
+                else
+                    m_aborted = true;
+                m_readable.notify_all();
+            }
+
+            sender.join();
+            curl_slist_free_all(headers);
+
+            bool call_succeeded = true;
+
+            if (CURLE_OK == res)
+            {
+                long response_code = 0;
+                curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &response_code);
+
+                if (600 > response_code && response_code >= 400)
+                {
+                    LOGERR("uploading failed with response code %ld", response_code);
+                    error = std::string("response code:") + std::to_string(response_code);
+                    call_succeeded = false;
+                }
+                else if (!produced)
+                {
+                    // Only possible when the producer failed after the server already answered
+                    LOGERR("could not produce the data");
+                    error = "could not produce the data";
+                    call_succeeded = false;
+                }
+                else
+                {
+                    LOGWARN("upload of %zu bytes done", m_sent);
+                }
+            }
+            else if (!produced && CURLE_ABORTED_BY_CALLBACK == res)
+            {
+                LOGERR("could not produce the data, upload aborted");
+                error = "could not produce the data";
+                call_succeeded = false;
+            }
+            else
+            {
+                LOGERR("upload failed with error %d:'%s'", res, curl_easy_strerror(res));
+                error = std::to_string(res) + std::string(":'") + std::string(curl_easy_strerror(res)) + std::string("'");
+                call_succeeded = false;
+            }
+
+            return call_succeeded;
+        }
+
+        bool StreamUpload::write(const unsigned char *data, size_t length)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (length > 0)
+            {
+                m_writable.wait(lock, [this]() { return m_used < m_pipe.size() || m_finished; });
+
+                // The transfer ended early, the rest would never be read
+                if (m_finished)
+                    return false;
+
+                size_t tail = (m_head + m_used) % m_pipe.size();
+                size_t count = std::min(length, std::min(m_pipe.size() - m_used, m_pipe.size() - tail));
+
+                memcpy(&m_pipe[tail], data, count);
+                m_used += count;
+                data += count;
+                length -= count;
+
+                m_readable.notify_one();
+            }
+
+            return true;
+        }
+
+        size_t StreamUpload::read(char *buffer, size_t length)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_readable.wait(lock, [this]() { return m_used > 0 || m_eof || m_aborted; });
+
+            if (m_aborted)
+                return CURL_READFUNC_ABORT;
+
+            size_t copied = 0;
+            while (copied < length && m_used > 0)
+            {
+                size_t count = std::min(length - copied, std::min(m_used, m_pipe.size() - m_head));
+
+                memcpy(buffer + copied, &m_pipe[m_head], count);
+                m_head = (m_head + count) % m_pipe.size();
+                m_used -= count;
+                copied += count;
+            }
+
+            m_sent += copied;
+            m_writable.notify_one();
+
+            // 0 once the producer is done and everything is sent: the last chunk
+            return copied;
+        }
+
+        size_t StreamUpload::readCallback(char *buffer, size_t size, size_t count, void *self)
+        {
+            return static_cast<StreamUpload*>(self)->read(buffer, size * count);
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
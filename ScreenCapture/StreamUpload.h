@@ -0,0 +1,80 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "PngEncoder.h"
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // HTTP POST of data that is still being produced.
+        //
+        // The producer runs on the calling thread and writes into a bounded pipe; curl reads from it on
+        // a second thread and sends it with chunked transfer encoding, so encoding and network overlap
+        // and the whole file is never held in memory. When the transfer fails the writer returns false,
+        // which stops the producer. The curl handle, and with it the connection, is kept for the next
+        // upload.
+        class StreamUpload
+        {
+        public:
+            typedef std::function<bool(const PngEncoder::Writer &writer)> Producer;
+
+            explicit StreamUpload(size_t pipeSize = 256 * 1024);
+            ~StreamUpload();
+
+            bool post(const std::string &url, const std::string &contentType, const Producer &produce, std::string &error);
+
+        private:
+            StreamUpload(const StreamUpload&) = delete;
+            StreamUpload& operator=(const StreamUpload&) = delete;
+
+            bool write(const unsigned char *data, size_t length);
+            size_t read(char *buffer, size_t length);
+            static size_t readCallback(char *buffer, size_t size, size_t count, void *self);
+
+            CURL *m_curl;
+            std::mutex m_postMutex;
+
+            // The pipe, guarded by m_mutex
+            std::mutex m_mutex;
+            std::condition_variable m_readable;
+            std::condition_variable m_writable;
+            std::vector<unsigned char> m_pipe;
+            size_t m_head;
+            size_t m_used;
+            bool m_eof;       // producer is done
+            bool m_aborted;   // producer failed, curl aborts the transfer
+            bool m_finished;  // curl returned, nothing is read anymore
+            size_t m_sent;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,429 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+// Compares the ScreenCapture frame conversion before and after the striped encoder on a synthetic
+// frame: the byte-by-byte R/B copy against the in-place swizzle, and a default libpng encode against
+// PngEncoder with the given level, filter and thread counts. Every PngEncoder output is decoded with
+// libpng and compared with the source pixels. The time until the encoder hands out its first IDAT
+// chunk is what a streaming upload waits before sending. The raw and run length encoded formats and
+// the thumbnail downscale are timed as well; the run length encoded output is decoded and compared.
+// Finally a delta capture: a few small areas of the frame change, the dirty tiles are found, stacked
+// and encoded, and the previous frame patched with them has to match the new one.
+//
+// Usage: screenCaptureBenchmark [-w <width>] [-h <height>] [-n <runs>] [-l <level>] [-f <filter>] [-t <threads,...>] [-s <scale>]
+//   -w, -h  frame size (default 1920x1080)
+//   -n      runs per measurement (default 5)
+//   -l      zlib level, -1 for the default (default -1)
+//   -f      none, sub, up, average, paeth or adaptive (default adaptive)
+//   -t      comma separated thread counts (default 1,2,4)
+//   -s      thumbnail downscale factor (default 4)
+//   -d      delta tile size (default 32)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <png.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "PngEncoder.h"
+#include "FrameFormat.h"
+#include "FrameDelta.h"
+
+using namespace WPEFramework::Plugin;
+
+static double wallTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Something like a UI over video: flat panels with text-like detail on top of a noisy gradient
+static void makeFrame(std::vector<unsigned char> &frame, int width, int height)
+{
+    unsigned int seed = 1;
+    frame.resize((size_t)width * height * 4);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            unsigned char *p = &frame[((size_t)y * width + x) * 4];
+            seed = seed * 1103515245 + 12345;
+            int noise = (seed >> 16) & 0x0f;
+
+            bool panel = (y > height / 8 && y < height / 3) || (x > width * 2 / 3 && y > height / 2);
+            if (panel)
+            {
+                bool glyph = ((x / 3) % 7 < 2) && ((y / 4) % 5 < 3) && ((x / 40 + y / 24) % 3 != 0);
+                p[0] = glyph ? 240 : 32;
+                p[1] = glyph ? 240 : 36;
+                p[2] = glyph ? 240 : 48;
+            }
+            else
+            {
+                p[0] = (unsigned char)(x * 255 / width + noise);
+                p[1] = (unsigned char)(y * 255 / height + noise);
+                p[2] = (unsigned char)(128 + noise);
+            }
+            p[3] = 255;
+        }
+    }
+}
+
+static void writeCallback(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
+    p->insert(p->end(), data, data + length);
+}
+
+// What saveToPng did before PngEncoder
+static bool libpngEncode(unsigned char *data, int width, int height, std::vector<unsigned char> &out)
+{
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+    if (!info_ptr)
+        return false;
+
+    png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+
+    std::vector<png_bytep> rows(height);
+    for (int i = 0; i < height; i++)
+        rows[i] = data + (size_t)i * width * 4;
+
+    png_set_write_fn(png_ptr, &out, writeCallback, NULL);
+    png_set_rows(png_ptr, info_ptr, &rows[0]);
+    png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    return true;
+}
+
+static bool verify(const std::vector<unsigned char> &png, const std::vector<unsigned char> &rgba, int width, int height)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_memory(&image, &png[0], png.size()))
+        return false;
+
+    image.format = PNG_FORMAT_RGBA;
+    std::vector<unsigned char> decoded(PNG_IMAGE_SIZE(image));
+    bool ok = png_image_finish_read(&image, NULL, &decoded[0], 0, NULL) && (int)image.width == width && (int)image.height == height;
+
+    if (!ok)
+        fprintf(stderr, "decode failed: %s\n", image.message);
+
+    return ok && decoded == rgba;
+}
+
+static bool verifyRle(const std::vector<unsigned char> &rle, const std::vector<unsigned char> &rgba, int width, int height)
+{
+    if (rle.size() < 16 || 0 != memcmp(&rle[0], "SCRL", 4))
+        return false;
+
+    std::vector<unsigned char> decoded;
+    decoded.reserve(rgba.size());
+
+    size_t i = 16;
+    while (i < rle.size())
+    {
+        unsigned int c = rle[i++];
+        size_t pixels = c < 128 ? c + 1 : 1;
+        if (i + pixels * 4 > rle.size())
+            return false;
+
+        if (c < 128)
+            decoded.insert(decoded.end(), &rle[i], &rle[i] + pixels * 4);
+        else
+            for (unsigned int n = 0; n < c - 126; n++)
+                decoded.insert(decoded.end(), &rle[i], &rle[i] + 4);
+        i += pixels * 4;
+    }
+
+    return decoded.size() == (size_t)width * height * 4 && decoded == rgba;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int runs = 5;
+    int level = -1;
+    std::string filterName = "adaptive";
+    std::string threadList = "1,2,4";
+    int scale = 4;
+    int tileSize = 32;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:h:n:l:f:t:s:d:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'w': width = atoi(optarg); break;
+            case 'h': height = atoi(optarg); break;
+            case 'n': runs = atoi(optarg); break;
+            case 'l': level = atoi(optarg); break;
+            case 'f': filterName = optarg; break;
+            case 't': threadList = optarg; break;
+            case 's': scale = atoi(optarg); break;
+            case 'd': tileSize = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-w <width>] [-h <height>] [-n <runs>] [-l <level>] [-f <filter>] [-t <threads,...>] [-s <scale>] [-d <tile size>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    PngEncoder::Filter filter;
+    if (width <= 0 || height <= 0 || !PngEncoder::parseFilter(filterName, filter))
+    {
+        fprintf(stderr, "invalid frame size or filter\n");
+        return 1;
+    }
+
+    if (runs < 1)
+        runs = 1;
+
+    std::vector<unsigned char> bgra;
+    makeFrame(bgra, width, height);
+    size_t size = bgra.size();
+
+    // Swizzle
+    std::vector<unsigned char> frame(bgra);
+    double start = wallTime();
+    for (int n = 0; n < runs; n++)
+    {
+        std::vector<unsigned char> copy(size);
+        for (size_t i = 0; i < size; i += 4)
+        {
+            copy[i + 0] = frame[i + 2];
+            copy[i + 1] = frame[i + 1];
+            copy[i + 2] = frame[i + 0];
+            copy[i + 3] = frame[i + 3];
+        }
+        frame.swap(copy);
+    }
+    printf("swap     copy      %8.2f ms\n", (wallTime() - start) / runs);
+
+    frame = bgra;
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+        swapRedBlue(&frame[0], size / 4);
+    printf("swap     in place  %8.2f ms\n", (wallTime() - start) / runs);
+
+    // An odd number of swaps leaves RGBA
+    std::vector<unsigned char> rgba(bgra);
+    swapRedBlue(&rgba[0], size / 4);
+    if (frame != (runs % 2 ? rgba : bgra))
+    {
+        fprintf(stderr, "swizzle mismatch\n");
+        return 1;
+    }
+
+    // Encoding
+    std::vector<unsigned char> png;
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+    {
+        png.clear();
+        libpngEncode(&rgba[0], width, height, png);
+    }
+    printf("libpng   default   %8.2f ms %9zu bytes\n", (wallTime() - start) / runs, png.size());
+
+    int result = 0;
+    for (const char *p = threadList.c_str(); *p; )
+    {
+        char *end;
+        unsigned int threads = strtoul(p, &end, 10);
+        if (end == p || (*end && ',' != *end))
+        {
+            fprintf(stderr, "Invalid thread list: %s\n", threadList.c_str());
+            return 1;
+        }
+        p = *end ? end + 1 : end;
+
+        PngEncoder encoder;
+        encoder.setCompressionLevel(level);
+        encoder.setFilter(filter);
+        encoder.setThreads(threads);
+
+        bool ok = true;
+        double firstData = 0;
+        start = wallTime();
+        for (int n = 0; n < runs; n++)
+        {
+            png.clear();
+            double begin = wallTime();
+            bool first = true;
+            ok = encoder.encode(&rgba[0], width, height, width * 4, [&](const unsigned char *data, size_t length) {
+                // Signature and IHDR come first, the first IDAT is the 4th piece handed out
+                if (first && png.size() > 8 + 25)
+                {
+                    firstData += wallTime() - begin;
+                    first = false;
+                }
+                png.insert(png.end(), data, data + length);
+                return true;
+            }) && ok;
+            if (first)
+                firstData += wallTime() - begin;
+        }
+        double elapsed = (wallTime() - start) / runs;
+
+        ok = ok && verify(png, rgba, width, height);
+        printf("encoder  %2u thr    %8.2f ms %9zu bytes  %s, first data after %.2f ms\n", threads, elapsed, png.size(), ok ? "valid" : "INVALID", firstData / runs);
+        if (!ok)
+            result = 1;
+
+        // A writer that fails, as a broken upload does, stops the encoder
+        size_t calls = 0;
+        if (encoder.encode(&rgba[0], width, height, width * 4, [&calls](const unsigned char *, size_t) { return ++calls < 3; }))
+        {
+            fprintf(stderr, "encoder did not stop on a failing writer\n");
+            result = 1;
+        }
+    }
+
+    // Other formats
+    std::vector<unsigned char> out;
+    PngEncoder::Writer collect = [&out](const unsigned char *data, size_t length) {
+        out.insert(out.end(), data, data + length);
+        return true;
+    };
+
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+    {
+        out.clear();
+        FrameFormat::writeRaw(&rgba[0], width, height, width * 4, collect);
+    }
+    printf("raw                %8.2f ms %9zu bytes\n", (wallTime() - start) / runs, out.size());
+
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+    {
+        out.clear();
+        FrameFormat::writeRle(&rgba[0], width, height, width * 4, collect);
+    }
+    double elapsed = (wallTime() - start) / runs;
+    bool ok = verifyRle(out, rgba, width, height);
+    printf("rle                %8.2f ms %9zu bytes  %s\n", elapsed, out.size(), ok ? "valid" : "INVALID");
+    if (!ok)
+        result = 1;
+
+    std::vector<unsigned char> thumbnail;
+    int thumbnailWidth = 0, thumbnailHeight = 0;
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+        FrameFormat::downscale(&rgba[0], width, height, width * 4, scale, thumbnail, thumbnailWidth, thumbnailHeight);
+    printf("downscale 1/%-2d     %8.2f ms %dx%d\n", scale, (wallTime() - start) / runs, thumbnailWidth, thumbnailHeight);
+
+    if (thumbnailWidth > 0 && thumbnailHeight > 0)
+    {
+        PngEncoder encoder;
+        encoder.setCompressionLevel(level);
+        encoder.setFilter(filter);
+
+        start = wallTime();
+        for (int n = 0; n < runs; n++)
+        {
+            out.clear();
+            encoder.encode(&thumbnail[0], thumbnailWidth, thumbnailHeight, thumbnailWidth * 4, collect);
+        }
+        printf("thumbnail png      %8.2f ms %9zu bytes\n", (wallTime() - start) / runs, out.size());
+    }
+
+    // Delta: a clock, a focus highlight and a progress bar change
+    FrameDelta delta;
+    delta.setTileSize(tileSize);
+    tileSize = delta.tileSize();
+
+    std::vector<unsigned char> previous(rgba);
+    std::vector<unsigned char> next(rgba);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool clock = x > width - 200 && x < width - 40 && y > 30 && y < 70;
+            bool focus = x > width / 4 && x < width / 4 + 300 && y > height / 2 && y < height / 2 + 6;
+            bool progress = y > height - 60 && y < height - 50 && x > width / 10 && x < width / 2;
+            if (clock || focus || progress)
+                next[((size_t)y * width + x) * 4 + 1] ^= 0x5a;
+        }
+    }
+
+    std::vector<unsigned char> baseline(previous);
+    delta.setPrevious(baseline, width, height);
+
+    std::vector<uint32_t> dirty;
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+        delta.compare(&next[0], width, height, dirty);
+    printf("delta compare      %8.2f ms %zu of %zu tiles dirty\n", (wallTime() - start) / runs, dirty.size(), delta.tileCount(width, height));
+
+    std::vector<unsigned char> tiles;
+    PngEncoder encoder;
+    encoder.setCompressionLevel(level);
+    encoder.setFilter(filter);
+
+    start = wallTime();
+    for (int n = 0; n < runs; n++)
+    {
+        out.clear();
+        delta.compare(&next[0], width, height, dirty);
+        delta.writeHeader(width, height, dirty, collect);
+        delta.gatherTiles(&next[0], width, height, dirty, tiles);
+        if (!dirty.empty())
+            encoder.encode(&tiles[0], tileSize, tileSize * (int)dirty.size(), tileSize * 4, collect);
+    }
+    elapsed = (wallTime() - start) / runs;
+
+    // Patch the previous frame with the tiles, as the receiver would
+    const int columns = (width + tileSize - 1) / tileSize;
+    for (size_t n = 0; n < dirty.size(); n++)
+    {
+        int x = (dirty[n] % columns) * tileSize;
+        int y = (dirty[n] / columns) * tileSize;
+        for (int i = 0; i < tileSize && y + i < height; i++)
+            memcpy(&previous[((size_t)(y + i) * width + x) * 4], &tiles[(n * tileSize + i) * tileSize * 4], (size_t)std::min(tileSize, width - x) * 4);
+    }
+
+    ok = previous == next;
+    printf("delta png          %8.2f ms %9zu bytes  %s\n", elapsed, out.size(), ok ? "valid" : "INVALID");
+    if (!ok)
+        result = 1;
+
+    delta.compare(&rgba[0], width, height, dirty);
+    baseline = rgba;
+    delta.setPrevious(baseline, width, height);
+    delta.compare(&rgba[0], width, height, dirty);
+    if (!dirty.empty())
+    {
+        fprintf(stderr, "unchanged frame has dirty tiles\n");
+        result = 1;
+    }
+
+    return result;
+}
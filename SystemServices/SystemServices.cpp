@@ -40,6 +40,7 @@
 #include "SystemServices.h"
 #include "StateObserverHelper.h"
 #include "utils.h"
+#include "executor.h"
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
 #include "libIARM.h"
@@ -242,6 +243,11 @@ namespace WPEFramework {
         SystemServices::SystemServices()
             : AbstractPlugin()
               , m_cacheService(SYSTEM_SERVICE_SETTINGS_FILE)
+              , m_identityReady(false)
+              , m_identityRefreshing(false)
+              , m_identityRefreshPending(false)
+              , m_identityStopped(false)
+              , m_identityRetrySec(IDENTITY_RETRY_MIN_SEC)
         {
             SystemServices::_instance = this;
 
@@ -360,6 +366,13 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             InitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            /* Collect the device identity while the UI starts up, so its first queries are answered from memory. */
+            {
+                std::lock_guard<std::mutex> lock(m_identityMutex);
+                m_identityStopped = false;
+                m_identityRefreshPending = false;
+            }
+            refreshIdentity();
             /* On Success; return empty to indicate no error text. */
             return (string());
         }
@@ -370,6 +383,128 @@ namespace WPEFramework {
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
             DeinitializeIARM();
 #endif /* defined(USE_IARMBUS) || defined(USE_IARM_BUS) */
+            {
+                std::lock_guard<std::mutex> lock(m_identityMutex);
+                m_identityStopped = true;
+            }
+            if (m_identityThread.joinable())
+                m_identityThread.join();
+        }
+
+        /***
+         * @brief : Worker that runs the identity scripts, all at the same time, and
+         *          publishes the result as the new identity snapshot. Runs again if a
+         *          refresh was requested meanwhile, since the result may predate it.
+         */
+        void SystemServices::collectIdentity()
+        {
+            const char* macTypeList[] = {"ecm_mac", "estb_mac",
+                "moca_mac", "eth_mac", "wifi_mac"};
+            const size_t macCount = sizeof(macTypeList) / sizeof(macTypeList[0]);
+
+            std::vector<Utils::Exec::Command> commands;
+            for (size_t i = 0; i < macCount; i++) {
+                commands.push_back({ "/lib/rdk/getDeviceDetails.sh", "read", macTypeList[i] });
+            }
+            commands.push_back(Utils::Exec::shell("PATH=${PATH}:/sbin:/usr/sbin /lib/rdk/getDeviceDetails.sh read"));
+            commands.push_back({ "/usr/bin/mfr_util", "--PDRIVersion" });
+            commands.push_back(Utils::Exec::shell(". /lib/rdk/getPartnerId.sh; getPartnerId"));
+            commands.push_back(Utils::Exec::shell(". /lib/rdk/getAccountId.sh; getAccountId"));
+
+            for (;;) {
+                DeviceIdentity identity;
+                std::vector<Utils::Exec::Result> results = Utils::Exec::runAll(commands, IDENTITY_SCRIPT_TIMEOUT_MS);
+
+                for (size_t i = 0; i < macCount; i++) {
+                    string mac = results[i].output;
+                    removeCharsFromString(mac, "\n\r");
+                    if (!mac.empty()) {
+                        identity.macAddresses[macTypeList[i]] = mac;
+                    }
+                }
+                identity.model = trim(caseInsensitive(results[macCount].output));
+                identity.pdriVersion = trim(results[macCount + 1].output);
+                identity.partnerId = trim(results[macCount + 2].output);
+                identity.accountId = trim(results[macCount + 3].output);
+
+                /* A device without MoCA or WiFi, or not activated yet, never gets the other values */
+                identity.complete = !identity.model.empty() && identity.macAddresses.count("estb_mac") > 0;
+
+                identity.stbVersion = getStbVersionString();
+                identity.clientVersion = getClientVersionString();
+                identity.stbTimestamp = getStbTimestampString();
+
+                LOGINFO("identity collected, model: %s, %zu MAC addresses%s\n", identity.model.c_str(),
+                        identity.macAddresses.size(), identity.complete ? "" : ", incomplete");
+
+                std::lock_guard<std::mutex> lock(m_identityMutex);
+                if (identity.complete) {
+                    m_identityRetrySec = IDENTITY_RETRY_MIN_SEC;
+                } else if (m_identityReady && !m_identity.complete) {
+                    m_identityRetrySec = std::min(2 * m_identityRetrySec, (unsigned int)IDENTITY_SCRIPT_CACHE_TTL_SEC);
+                }
+                m_identity = identity;
+                m_identityReady = true;
+                m_identityTime = std::chrono::steady_clock::now();
+                m_identitySignal.notify_all();
+
+                if (!m_identityRefreshPending || m_identityStopped) {
+                    m_identityRefreshing = false;
+                    break;
+                }
+                m_identityRefreshPending = false;
+            }
+        }
+
+        /***
+         * @brief : Starts collecting the identity in the background. If that is already going on,
+         *          the running worker collects it once more when it is done.
+         */
+        void SystemServices::refreshIdentity()
+        {
+            std::lock_guard<std::mutex> lock(m_identityMutex);
+            if (m_identityStopped) {
+                return;
+            }
+            if (m_identityRefreshing) {
+                m_identityRefreshPending = true;
+                return;
+            }
+            /* A previous worker has published its result already and is about to return */
+            if (m_identityThread.joinable()) {
+                m_identityThread.join();
+            }
+            m_identityRefreshing = true;
+            m_identityThread = std::thread(&SystemServices::collectIdentity, this);
+        }
+
+        /***
+         * @brief : Returns the identity snapshot. Only the very first call can wait, until the
+         *          collection started by Initialize() is done; an old snapshot, or an incomplete
+         *          one past its retry delay, is returned as it is and refreshed in the background.
+         */
+        DeviceIdentity SystemServices::getIdentity()
+        {
+            DeviceIdentity identity;
+            bool outdated = false;
+            {
+                std::unique_lock<std::mutex> lock(m_identityMutex);
+                if (!m_identityReady && !m_identityRefreshing) {
+                    lock.unlock();
+                    refreshIdentity();
+                    lock.lock();
+                }
+                m_identitySignal.wait_for(lock, std::chrono::milliseconds(2 * IDENTITY_SCRIPT_TIMEOUT_MS),
+                        [this] { return m_identityReady || !m_identityRefreshing; });
+                identity = m_identity;
+                unsigned int maxAge = m_identity.complete ? IDENTITY_SCRIPT_CACHE_TTL_SEC : m_identityRetrySec;
+                outdated = m_identityReady && !m_identityRefreshing
+                        && std::chrono::steady_clock::now() - m_identityTime > std::chrono::seconds(maxAge);
+            }
+            if (outdated) {
+                refreshIdentity();
+            }
+            return identity;
         }
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
@@ -786,6 +921,7 @@ namespace WPEFramework {
                 //set values in temp file so they can be restored in receiver restarts / crashes
                 m_temp_settings.setValue("mode", m_currentMode);
                 m_temp_settings.setValue("mode_duration", m_remainingDuration);
+                m_temp_settings.flush();
             } else {
                 LOGWARN("Current mode '%s' not changed", m_currentMode.c_str());
             }
@@ -880,8 +1016,10 @@ namespace WPEFramework {
             string env = "";
             string model;
             string firmwareVersion;
+            DeviceIdentity identity;
             if (_instance) {
-                firmwareVersion = _instance->getStbVersionString();
+                identity = _instance->getIdentity();
+                firmwareVersion = identity.stbVersion;
             } else {
                 LOGERR("_instance is NULL.\n");
             }
@@ -899,7 +1037,7 @@ namespace WPEFramework {
                 env = "CQA";
 
             string ipAddress = collectDeviceInfo("estb_ip");
-            model = getModel();
+            model = identity.model;
 
             if (eStbMac.empty())
                 eStbMac = collectDeviceInfo("estb_mac");
@@ -924,14 +1062,9 @@ namespace WPEFramework {
                 fullCommand.replace(start_pos, match.length(), "https://");
             }
 
-            pdriVersion = Utils::cRunScript("/usr/bin/mfr_util --PDRIVersion");
-            pdriVersion = trim(pdriVersion);
-
-            partnerId = Utils::cRunScript("sh -c \". /lib/rdk/getPartnerId.sh; getPartnerId\"");
-            partnerId = trim(partnerId);
-
-            accountId = Utils::cRunScript("sh -c \". /lib/rdk/getAccountId.sh; getAccountId\"");
-            accountId = trim(accountId);
+            pdriVersion = identity.pdriVersion;
+            partnerId = identity.partnerId;
+            accountId = identity.accountId;
 
             fullCommand += "?eStbMac=" + eStbMac
                 + "&env=" + env
@@ -1129,7 +1262,8 @@ namespace WPEFramework {
                 JsonObject& response)
         {
             JsonObject rConf;
-            std::string stbVersion = getStbVersionString();
+            DeviceIdentity identity = getIdentity();
+            std::string stbVersion = identity.stbVersion;
             string firm = stbVersion;
             LOGINFO("stbVersion = %s firm = %s\n",
                     stbVersion.c_str(), firm.c_str());
@@ -1146,7 +1280,7 @@ namespace WPEFramework {
             std::string estbMac = collectDeviceInfo("estb_mac");
             removeCharsFromString(estbMac, "\n\r");
             rConf["eStbMac"] = estbMac;
-            rConf["model"] = getModel();
+            rConf["model"] = identity.model;
             rConf["firmwareVersion"] = stbVersion;
             response["xconfParams"] = rConf;
             returnResponse(true);
@@ -1373,7 +1507,7 @@ namespace WPEFramework {
                         }
                     }
                 }
-                response["currentFWVersion"] = getStbVersionString();
+                response["currentFWVersion"] = getIdentity().stbVersion;
                 response["downloadedFWVersion"] = downloadedFWVersion;
                 response["downloadedFWLocation"] = downloadedFWLocation;
                 response["isRebootDeferred"] = isRebootDeferred;
@@ -1468,17 +1602,16 @@ namespace WPEFramework {
             JsonObject params;
             string macTypeList[] = {"ecm_mac", "estb_mac",
                 "moca_mac", "eth_mac", "wifi_mac"};
-            string tempBuffer, cmdBuffer;
+            string tempBuffer;
+            DeviceIdentity identity;
+
+            if (pSs) {
+                identity = pSs->getIdentity();
+            }
 
             for (i = 0; i < 5; i++) {
-                cmdBuffer.clear();
-                cmdBuffer = "/lib/rdk/getDeviceDetails.sh read ";
-                cmdBuffer += macTypeList[i];
-                LOGWARN("cmd = %s\n", cmdBuffer.c_str());
-                tempBuffer.clear();
-                tempBuffer = Utils::cRunScript(cmdBuffer.c_str());
+                tempBuffer = identity.macAddresses[macTypeList[i]];
                 if (!tempBuffer.empty()) {
-                    removeCharsFromString(tempBuffer, "\n\r");
                     LOGWARN("resp = %s\n", tempBuffer.c_str());
                     params[macTypeList[i].c_str()] = tempBuffer;
                     listLength++;
@@ -2518,9 +2651,11 @@ namespace WPEFramework {
         {
             bool status = false;
 
-            response["stbVersion"]      = getStbVersionString();
-            response["receiverVersion"] = getClientVersionString();
-            response["stbTimestamp"]    = getStbTimestampString();
+            DeviceIdentity identity = getIdentity();
+
+            response["stbVersion"]      = identity.stbVersion;
+            response["receiverVersion"] = identity.clientVersion;
+            response["stbTimestamp"]    = identity.stbTimestamp;
             status = true;
             returnResponse(status);
         }
@@ -2596,6 +2731,21 @@ namespace WPEFramework {
                 void *data, size_t len)
         {
             LOGINFO("len = %d\n", len);
+            if (IARM_BUS_SYSMGR_EVENT_SYSTEMSTATE == eventId && data) {
+                IARM_Bus_SYSMgr_EventData_t *stateData = (IARM_Bus_SYSMgr_EventData_t *)data;
+                switch (stateData->data.systemStates.stateId) {
+                    /* MAC addresses and the identity scripts' answers become available with the network */
+                    case IARM_BUS_SYSMGR_SYSSTATE_ECM_MAC:
+                    case IARM_BUS_SYSMGR_SYSSTATE_ESTB_IP:
+                    case IARM_BUS_SYSMGR_SYSSTATE_IP_MODE:
+                        if (SystemServices::_instance) {
+                            SystemServices::_instance->refreshIdentity();
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
             switch (eventId) {
                 case IARM_BUS_SYSMGR_SYSSTATE_FIRMWARE_UPDATE_STATE:
                     {
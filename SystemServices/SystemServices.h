@@ -22,6 +22,10 @@
 
 #include <stdint.h>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
 
 #include "Module.h"
 #include "tracing/Logging.h"
@@ -55,6 +59,22 @@
 namespace WPEFramework {
     namespace Plugin {
 
+        /* Device identity derived from scripts and the version file; it doesn't change
+           while the plugin runs, apart from values that are not known yet at boot. */
+        struct DeviceIdentity {
+            DeviceIdentity() : complete(false) {}
+
+            std::map<string, string> macAddresses; /* by type, e.g. "estb_mac"; only the available ones */
+            string model;
+            string pdriVersion;
+            string partnerId;
+            string accountId;
+            string stbVersion;
+            string clientVersion;
+            string stbTimestamp;
+            bool complete; /* false if the model or the eSTB MAC was missing; other values may be absent for good */
+        };
+
         // This is a server for a JSONRPC communication channel.
         // For a plugin to be capable to handle JSONRPC, inherit from PluginHost::JSONRPC.
         // By inheriting from this class, the plugin realizes the interface PluginHost::IDispatcher.
@@ -106,6 +126,19 @@ namespace WPEFramework {
                 static int m_remainingDuration;
                 std::thread m_getFirmwareInfoThread;
 
+                DeviceIdentity m_identity;
+                bool m_identityReady;
+                bool m_identityRefreshing;
+                bool m_identityRefreshPending; /* refresh requested while one was running */
+                bool m_identityStopped;
+                std::chrono::steady_clock::time_point m_identityTime;
+                unsigned int m_identityRetrySec; /* age at which an incomplete snapshot is collected again */
+                std::mutex m_identityMutex;
+                std::condition_variable m_identitySignal;
+                std::thread m_identityThread;
+
+                void collectIdentity();
+
                 static void startModeTimer(int duration);
                 static void stopModeTimer();
                 static void updateDuration();
@@ -125,6 +158,8 @@ namespace WPEFramework {
                 std::string getStbVersionString();
                 std::string getClientVersionString();
                 std::string getStbTimestampString();
+                DeviceIdentity getIdentity();
+                void refreshIdentity();
 
 #if defined(USE_IARMBUS) || defined(USE_IARM_BUS)
                 void InitializeIARM();
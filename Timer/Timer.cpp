@@ -27,6 +27,11 @@
 
 #include "utils.h"
 
+#include <math.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 // Methods
 #define TIMER_METHOD_START_TIMER          "startTimer"
 #define TIMER_METHOD_CANCEL               "cancel"
@@ -41,6 +46,25 @@
 
 #define TIMER_ACCURACY 0.001 // 10 milliseconds
 
+// Longest time the TpTimer is armed for, later deadlines are checked again after it
+#define TIMER_MAX_TIMEOUT 100000
+
+// Number of canceled or expired timers still reported by getTimers before their slots are reused
+#define TIMER_FINISHED_HISTORY 32
+
+// A timer id is the slot in m_timerItems plus the generation of the slot above it, so an id is
+// only handed out again after its slot has been reused TIMER_ID_GENERATIONS times
+#define TIMER_ID_SLOT_BITS 16
+#define TIMER_ID_MAX_SLOTS (1u << TIMER_ID_SLOT_BITS)
+#define TIMER_ID_GENERATIONS (1u << 15)
+
+// SLEEP and WAKE timers survive a restart
+#define TIMER_PERSISTENT_FILE "/opt/timers.json"
+
+// A restored timer that expired longer ago than this while we were down is not fired late: the
+// standby or wake up it stands for is no longer wanted hours after the fact
+#define TIMER_RESTORE_GRACE 60.0
+
 static const char* stateStrings[] = {
     "",
     "RUNNING",
@@ -86,73 +110,129 @@ namespace WPEFramework
             Timer::_instance = nullptr;
         }
 
-        void Timer::checkTimers()
+        const string Timer::Initialize(PluginHost::IShell* /* service */)
         {
             LOGINFO();
 
-            double minTimeout = 100000;
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
-            {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
-                {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
-                }
-                if (m_timerItems[timerId].state != RUNNING)
-                {
-                    LOGERR("Internal error: timer %d has wrong state", timerId);
-                    continue;
-                }
+            // Restored here rather than in the constructor: timers that expired while we were down
+            // fire from the TpTimer thread once the plugin is up, not before it is activated
+            std::lock_guard<std::mutex> guard(m_callMutex);
+            loadTimers();
+            checkTimers();
 
-                std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
-                double timeout =  m_timerItems[timerId].interval - elapsed.count();
+            return "";
+        }
 
-                if (!m_timerItems[timerId].reminderSent && m_timerItems[timerId].remindBefore > TIMER_ACCURACY)
-                {
-                    if (timeout > m_timerItems[timerId].remindBefore)
-                    {
-                        timeout -= m_timerItems[timerId].remindBefore;
-                    }
-                    else
-                    {
-                        sendTimerExpiryReminder(timerId);
-                        m_timerItems[timerId].reminderSent = true;
-                    }
-                }
+        void Timer::Deinitialize(PluginHost::IShell* /* service */)
+        {
+            LOGINFO();
+
+            m_timer.stop();
+
+            std::lock_guard<std::mutex> guard(m_callMutex);
+            m_timerItems.clear();
+            m_freeIds.clear();
+            m_finishedIds.clear();
+            m_queue = TimerQueue();
+        }
+
+        std::chrono::system_clock::time_point Timer::nextDeadline(const TimerItem& item)
+        {
+            double timeout = item.interval;
+            if (!item.reminderSent && item.remindBefore > TIMER_ACCURACY)
+                timeout -= item.remindBefore;
+
+            return item.lastExpired + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(timeout));
+        }
+
+        void Timer::checkTimers()
+        {
+            unsigned int timerId;
+            std::chrono::system_clock::time_point deadline;
 
-                if (timeout < minTimeout)
-                    minTimeout = timeout;
+            if (!m_queue.top(timerId, deadline))
+            {
+                m_timer.stop();
+                return;
             }
 
+            std::chrono::duration<double> timeout = deadline - std::chrono::system_clock::now();
+            double minTimeout = timeout.count();
+
             if (minTimeout < TIMER_ACCURACY)
                 minTimeout = TIMER_ACCURACY;
+            if (minTimeout > TIMER_MAX_TIMEOUT)
+                minTimeout = TIMER_MAX_TIMEOUT;
+
+            m_timer.start(int(minTimeout * 1000));
+        }
+
+        bool Timer::allocateTimerId(unsigned int& timerId)
+        {
+            if (!m_freeIds.empty())
+            {
+                timerId = m_freeIds.back();
+                m_freeIds.pop_back();
+            }
+            else if (m_finishedIds.size() >= TIMER_FINISHED_HISTORY || m_timerItems.size() >= TIMER_ID_MAX_SLOTS)
+            {
+                if (m_finishedIds.empty())
+                    return false;
+
+                timerId = m_finishedIds.front();
+                m_finishedIds.pop_front();
+            }
+            else
+            {
+                timerId = m_timerItems.size();
+                m_timerItems.push_back(TimerItem());
+                return true;
+            }
+
+            m_timerItems[timerId].generation = (m_timerItems[timerId].generation + 1) % TIMER_ID_GENERATIONS;
+            return true;
+        }
 
-            if (minTimeout < 100000)
-                m_timer.start(int(minTimeout * 1000));
+        bool Timer::findTimer(unsigned int publicId, unsigned int& timerId)
+        {
+            timerId = publicId % TIMER_ID_MAX_SLOTS;
+            return timerId < m_timerItems.size() && INITIAL != m_timerItems[timerId].state
+                && publicId == publicTimerId(timerId);
+        }
+
+        unsigned int Timer::publicTimerId(unsigned int timerId)
+        {
+            return (m_timerItems[timerId].generation << TIMER_ID_SLOT_BITS) | timerId;
+        }
+
+        void Timer::finishTimer(int timerId)
+        {
+            m_finishedIds.push_back(timerId);
         }
 
         void Timer::startTimer(int timerId)
         {
-            m_runningItems.push_back(timerId);
             m_timerItems[timerId].state = RUNNING;
 
             m_timerItems[timerId].lastExpired = std::chrono::system_clock::now();
             m_timerItems[timerId].lastExpiryReminder = std::chrono::system_clock::now();
             m_timerItems[timerId].reminderSent = false;
 
+            m_queue.push(timerId, nextDeadline(m_timerItems[timerId]));
             checkTimers();
         }
 
         bool Timer::cancelTimer(int timerId)
         {
+            TimerState state = m_timerItems[timerId].state;
             m_timerItems[timerId].state = CANCELED;
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
+            if (EXPIRED != state)
+                finishTimer(timerId);
+
+            if (m_queue.contains(timerId))
             {
-                m_runningItems.erase(it);
-                m_timer.stop();
+                m_queue.remove(timerId);
                 checkTimers();
                 return true;
             }
@@ -164,11 +244,9 @@ namespace WPEFramework
         {
             m_timerItems[timerId].state = SUSPENDED;
 
-            auto it = std::find(m_runningItems.begin(), m_runningItems.end(), timerId);
-            if (m_runningItems.end() != it)
+            if (m_queue.contains(timerId))
             {
-                m_runningItems.erase(it);
-                m_timer.stop();
+                m_queue.remove(timerId);
                 checkTimers();
                 return true;
             }
@@ -182,16 +260,18 @@ namespace WPEFramework
 
             LOGINFO();
 
-            std::list <int> itemsToDelete;
+            bool persistentChanged = false;
+            unsigned int timerId;
+            std::chrono::system_clock::time_point deadline;
 
-            for (auto it = m_runningItems.cbegin(); it != m_runningItems.cend(); ++it)
+            while (m_queue.top(timerId, deadline))
             {
-                unsigned int timerId = *it;
-                if (timerId < 0 || timerId >= m_timerItems.size())
-                {
-                    LOGERR("Internal error: wrong timerId");
-                    continue;
-                }
+                std::chrono::duration<double> untilDeadline = deadline - std::chrono::system_clock::now();
+                if (untilDeadline.count() > TIMER_ACCURACY)
+                    break;
+
+                m_queue.pop();
+
                 if (m_timerItems[timerId].state != RUNNING)
                 {
                     LOGERR("Internal error: timer %d has wrong state", timerId);
@@ -223,28 +303,187 @@ namespace WPEFramework
                     else
                     {
                         m_timerItems[timerId].state = EXPIRED;
-                        itemsToDelete.push_back(timerId);
+                        finishTimer(timerId);
                     }
 
                     m_timerItems[timerId].reminderSent = false;
+
+                    if (GENERIC != m_timerItems[timerId].mode)
+                        persistentChanged = true;
                 }
+
+                if (RUNNING == m_timerItems[timerId].state)
+                    m_queue.push(timerId, nextDeadline(m_timerItems[timerId]));
+            }
+
+            if (persistentChanged)
+                saveTimers();
+
+            checkTimers();
+        }
+
+        void Timer::saveTimers()
+        {
+            JsonArray timers;
+            char buf[256];
+
+            for (unsigned int n = 0; n < m_timerItems.size(); n++)
+            {
+                const TimerItem& item = m_timerItems[n];
+                if (GENERIC == item.mode || (RUNNING != item.state && SUSPENDED != item.state))
+                    continue;
+
+                JsonObject timer;
+                timer["timerId"] = publicTimerId(n);
+                timer["state"] = stateStrings[item.state];
+                timer["mode"] = modeStrings[item.mode];
+
+                snprintf(buf, sizeof(buf), "%.3f", item.interval);
+                timer["interval"] = (const char *)buf;
+
+                snprintf(buf, sizeof(buf), "%.3f", item.repeatInterval);
+                timer["repeatInterval"] = (const char *)buf;
+
+                snprintf(buf, sizeof(buf), "%.3f", item.remindBefore);
+                timer["remindBefore"] = (const char *)buf;
+
+                // Wall clock time of the expiry, so the remaining time is right after a restart
+                std::chrono::duration<double> expiry = item.lastExpired.time_since_epoch();
+                snprintf(buf, sizeof(buf), "%.3f", expiry.count() + item.interval);
+                timer["expiry"] = (const char *)buf;
+
+                timer["reminderSent"] = item.reminderSent;
+                timers.Add(timer);
             }
 
-            for (auto delIt = itemsToDelete.cbegin(); delIt != itemsToDelete.cend(); ++delIt)
+            JsonObject data;
+            data["timers"] = timers;
+
+            // Written next to the file and renamed over it, so a crash never leaves a partial file
+            std::string tempName = std::string(TIMER_PERSISTENT_FILE) + ".tmp";
+            Core::File file;
+            file = tempName;
+
+            file.Destroy();
+            if (!file.Create())
             {
-                auto it = std::find(m_runningItems.begin(), m_runningItems.end(), *delIt);
-                if (m_runningItems.end() != it)
-                    m_runningItems.erase(it);
+                LOGERR("Failed to create %s", tempName.c_str());
+                return;
+            }
+            data.IElement::ToFile(file);
+            file.Close();
 
+            // The rename must not reach the disk before the data does
+            int fd = open(tempName.c_str(), O_WRONLY);
+            if (fd >= 0)
+            {
+                fsync(fd);
+                close(fd);
             }
 
-            checkTimers();
+            if (0 != rename(tempName.c_str(), TIMER_PERSISTENT_FILE))
+                LOGERR("Failed to save timers to %s", TIMER_PERSISTENT_FILE);
+        }
+
+        void Timer::loadTimers()
+        {
+            Core::File file;
+            file = TIMER_PERSISTENT_FILE;
+
+            if (!file.Open())
+                return;
+
+            JsonObject data;
+            data.IElement::FromFile(file);
+            file.Close();
+
+            bool missed = false;
+            JsonArray timers = data["timers"].Array();
+            for (int n = 0; n < timers.Length(); n++)
+            {
+                JsonObject timer = timers[n].Object();
+                if (!timer.HasLabel("timerId") || !timer.HasLabel("interval") || !timer.HasLabel("expiry")
+                    || timer["timerId"].Number() < 0 || timer["timerId"].Number() >= TIMER_ID_MAX_SLOTS * TIMER_ID_GENERATIONS)
+                {
+                    LOGERR("Ignoring malformed timer in %s", TIMER_PERSISTENT_FILE);
+                    continue;
+                }
+
+                unsigned int publicId = timer["timerId"].Number();
+                unsigned int timerId = publicId % TIMER_ID_MAX_SLOTS;
+
+                if (timerId >= m_timerItems.size())
+                    m_timerItems.resize(timerId + 1, TimerItem());
+
+                TimerItem& item = m_timerItems[timerId];
+                item.generation = publicId >> TIMER_ID_SLOT_BITS;
+                item.mode = ("WAKE" == timer["mode"].String()) ? WAKE : SLEEP;
+                item.interval = std::stod(timer["interval"].String());
+                item.repeatInterval = timer.HasLabel("repeatInterval") ? std::stod(timer["repeatInterval"].String()) : 0.0;
+                item.remindBefore = timer.HasLabel("remindBefore") ? std::stod(timer["remindBefore"].String()) : 0.0;
+                item.reminderSent = timer["reminderSent"].Boolean();
+                item.lastExpiryReminder = std::chrono::system_clock::now();
+
+                if ("SUSPENDED" == timer["state"].String())
+                {
+                    item.state = SUSPENDED;
+                    item.lastExpired = std::chrono::system_clock::now();
+                }
+                else
+                {
+                    // Keep the original expiry; a timer that expired while we were down fires right away
+                    // unless it is more than TIMER_RESTORE_GRACE late
+                    std::chrono::duration<double> expiry(std::stod(timer["expiry"].String()) - item.interval);
+                    item.state = RUNNING;
+                    item.lastExpired = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(expiry));
+
+                    std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - item.lastExpired;
+                    double late = elapsed.count() - item.interval;
+                    if (late > TIMER_RESTORE_GRACE)
+                    {
+                        missed = true;
+
+                        if (item.repeatInterval > 0)
+                        {
+                            // Skip the missed periods, the next one is in the future
+                            double periods = floor(late / item.repeatInterval);
+                            item.lastExpired += std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                std::chrono::duration<double>(item.interval + periods * item.repeatInterval));
+                            item.interval = item.repeatInterval;
+                            item.reminderSent = false;
+                            LOGWARN("%s timer %u missed %.0f expiries while down, not fired", modeStrings[item.mode], publicId, periods + 1);
+                        }
+                        else
+                        {
+                            // Reported as expired by getTimers, without sending timerExpired
+                            item.state = EXPIRED;
+                            finishTimer(timerId);
+                            LOGWARN("%s timer %u expired %.0f s ago while down, not fired", modeStrings[item.mode], publicId, late);
+                            continue;
+                        }
+                    }
+
+                    m_queue.push(timerId, nextDeadline(item));
+                }
+
+                LOGINFO("Restored %s timer %u", modeStrings[item.mode], publicId);
+            }
+
+            if (missed)
+                saveTimers();
+
+            // Lowest ids are handed out first
+            for (unsigned int n = m_timerItems.size(); n > 0; n--)
+            {
+                if (INITIAL == m_timerItems[n - 1].state)
+                    m_freeIds.push_back(n - 1);
+            }
         }
 
         void Timer::getTimerStatus(int timerId, JsonObject& output, bool writeTimerId)
         {
             if (writeTimerId)
-                output["timerId"] = timerId;
+                output["timerId"] = publicTimerId(timerId);
 
             output["state"] = stateStrings[m_timerItems[timerId].state];
             output["mode"] = modeStrings[m_timerItems[timerId].mode];
@@ -293,10 +532,21 @@ namespace WPEFramework
             item.repeatInterval = parameters.HasLabel("repeatInterval") ? std::stod(parameters["repeatInterval"].String()) : 0.0;
             item.remindBefore = parameters.HasLabel("remindBefore") ? std::stod(parameters["remindBefore"].String()) : 0.0;
 
-            m_timerItems.push_back(item);
+            unsigned int timerId;
+            if (!allocateTimerId(timerId))
+            {
+                LOGERR("Too many timers");
+                returnResponse(false);
+            }
+
+            item.generation = m_timerItems[timerId].generation;
+            m_timerItems[timerId] = item;
 
-            startTimer(m_timerItems.size() - 1);
-            response["timerId"] = m_timerItems.size() - 1;
+            startTimer(timerId);
+            if (GENERIC != item.mode)
+                saveTimers();
+
+            response["timerId"] = publicTimerId(timerId);
 
             returnResponse(true);
         }
@@ -313,17 +563,21 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            unsigned int timerId;
-            getNumberParameter("timerId", timerId);
+            unsigned int publicId;
+            getNumberParameter("timerId", publicId);
 
-            if (timerId >=0 && timerId < m_timerItems.size())
+            unsigned int timerId;
+            if (findTimer(publicId, timerId))
             {
                 if (CANCELED != m_timerItems[timerId].state)
                 {
-                    returnResponse(cancelTimer(timerId));
+                    bool result = cancelTimer(timerId);
+                    if (GENERIC != m_timerItems[timerId].mode)
+                        saveTimers();
+                    returnResponse(result);
                 }
 
-                LOGERR("timer %d is already canceled", timerId);
+                LOGERR("timer %u is already canceled", publicId);
                 returnResponse(false);
             }
 
@@ -343,17 +597,21 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            unsigned int timerId;
-            getNumberParameter("timerId", timerId);
+            unsigned int publicId;
+            getNumberParameter("timerId", publicId);
 
-            if (timerId >=0 && timerId < m_timerItems.size())
+            unsigned int timerId;
+            if (findTimer(publicId, timerId))
             {
                 if (RUNNING == m_timerItems[timerId].state)
                 {
-                    returnResponse(suspendTimer(timerId));
+                    bool result = suspendTimer(timerId);
+                    if (GENERIC != m_timerItems[timerId].mode)
+                        saveTimers();
+                    returnResponse(result);
                 }
 
-                LOGERR("timer %d is not in running state", timerId);
+                LOGERR("timer %u is not in running state", publicId);
                 returnResponse(false);
             }
 
@@ -373,18 +631,21 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            unsigned int timerId;
-            getNumberParameter("timerId", timerId);
+            unsigned int publicId;
+            getNumberParameter("timerId", publicId);
 
-            if (timerId >=0 && timerId < m_timerItems.size())
+            unsigned int timerId;
+            if (findTimer(publicId, timerId))
             {
                 if (SUSPENDED == m_timerItems[timerId].state)
                 {
                     startTimer(timerId);
+                    if (GENERIC != m_timerItems[timerId].mode)
+                        saveTimers();
                     returnResponse(true);
                 }
 
-                LOGERR("timer %d is not in suspended state", timerId);
+                LOGERR("timer %u is not in suspended state", publicId);
                 returnResponse(false);
             }
 
@@ -404,10 +665,11 @@ namespace WPEFramework
                 returnResponse(false);
             }
 
-            unsigned int timerId;
-            getNumberParameter("timerId", timerId);
+            unsigned int publicId;
+            getNumberParameter("timerId", publicId);
 
-            if (timerId >= 0 && timerId < m_timerItems.size())
+            unsigned int timerId;
+            if (findTimer(publicId, timerId))
             {
                 getTimerStatus(timerId, response);
             }
@@ -429,6 +691,9 @@ namespace WPEFramework
             JsonArray timers;
             for (unsigned int n = 0; n < m_timerItems.size(); n++)
             {
+                if (INITIAL == m_timerItems[n].state)
+                    continue;
+
                 JsonObject timer;
                 getTimerStatus(n, timer, true);
                 timers.Add(timer);
@@ -459,7 +724,7 @@ namespace WPEFramework
             }
 #endif
             JsonObject params;
-            params["timerId"] = timerId;
+            params["timerId"] = publicTimerId(timerId);
             params["mode"] = modeStrings[m_timerItems[timerId].mode];
             params["status"] = 0;
             sendNotify(TIMER_EVT_TIMER_EXPIRED, params);
@@ -468,7 +733,7 @@ namespace WPEFramework
         void Timer::sendTimerExpiryReminder(int timerId)
         {
             JsonObject params;
-            params["timerId"] = timerId;
+            params["timerId"] = publicTimerId(timerId);
             params["mode"] = modeStrings[m_timerItems[timerId].mode];
 
             std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - m_timerItems[timerId].lastExpired;
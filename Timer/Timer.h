@@ -20,6 +20,7 @@
 #pragma once
 
 #include <mutex>
+#include <deque>
 
 #include "Module.h"
 #include "utils.h"
@@ -27,13 +28,14 @@
 
 
 #include "tptimer.h"
+#include "TimerQueue.h"
 
 namespace WPEFramework {
 
     namespace Plugin {
 
         enum TimerState {
-            INITIAL,
+            INITIAL, // slot not used by any timer
             RUNNING,
             SUSPENDED,
             CANCELED,
@@ -55,6 +57,7 @@ namespace WPEFramework {
             std::chrono::system_clock::time_point lastExpired;
             std::chrono::system_clock::time_point lastExpiryReminder;
             bool reminderSent;
+            unsigned int generation; // bumped when the slot is reused, part of the timer id
         };
 
 		// This is a server for a JSONRPC communication channel.
@@ -92,23 +95,36 @@ namespace WPEFramework {
 
             void checkTimers();
 
+            bool allocateTimerId(unsigned int& timerId);
+            bool findTimer(unsigned int publicId, unsigned int& timerId);
+            unsigned int publicTimerId(unsigned int timerId);
+            void finishTimer(int timerId);
+            std::chrono::system_clock::time_point nextDeadline(const TimerItem& item);
+
             void startTimer(int timerId);
             bool cancelTimer(int timerId);
             bool suspendTimer(int timerId);
 
+            void loadTimers();
+            void saveTimers();
+
             void onTimerCallback();
             void getTimerStatus(int timerId, JsonObject& output, bool writeTimerId = false);
 
         public:
             Timer();
             virtual ~Timer();
+            virtual const string Initialize(PluginHost::IShell* service) override;
+            virtual void Deinitialize(PluginHost::IShell* service) override;
 
         public:
             static Timer* _instance;
         private:
             TpTimer m_timer;
-            std::vector <TimerItem> m_timerItems;
-            std::list <int> m_runningItems;
+            std::vector <TimerItem> m_timerItems; // indexed by the slot part of the timer id
+            std::vector <unsigned int> m_freeIds;
+            std::deque <unsigned int> m_finishedIds; // canceled and expired timers, oldest first
+            TimerQueue m_queue;
             std::mutex m_callMutex;
         };
 	} // namespace Plugin
@@ -0,0 +1,117 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "TimerQueue.h"
+
+#include <algorithm>
+#include <functional>
+
+// Outdated entries tolerated in the heap before it is rebuilt
+#define TIMER_QUEUE_MIN_SLACK 64
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        TimerQueue::TimerQueue()
+        : m_lastSequence(0)
+        , m_live(0)
+        {
+        }
+
+        void TimerQueue::push(unsigned int timerId, const TimePoint& deadline)
+        {
+            if (timerId >= m_sequence.size())
+                m_sequence.resize(timerId + 1, 0);
+
+            if (0 == m_sequence[timerId])
+                m_live++;
+
+            // 0 is reserved for "not queued"
+            if (0 == ++m_lastSequence)
+                ++m_lastSequence;
+            m_sequence[timerId] = m_lastSequence;
+
+            m_heap.push_back(Entry { deadline, timerId, m_lastSequence });
+            std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+
+            compact();
+        }
+
+        void TimerQueue::remove(unsigned int timerId)
+        {
+            if (!contains(timerId))
+                return;
+
+            m_sequence[timerId] = 0;
+            m_live--;
+
+            compact();
+        }
+
+        bool TimerQueue::top(unsigned int& timerId, TimePoint& deadline)
+        {
+            while (!m_heap.empty() && !isCurrent(m_heap.front()))
+            {
+                std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+                m_heap.pop_back();
+            }
+
+            if (m_heap.empty())
+                return false;
+
+            timerId = m_heap.front().timerId;
+            deadline = m_heap.front().deadline;
+            return true;
+        }
+
+        void TimerQueue::pop()
+        {
+            unsigned int timerId;
+            TimePoint deadline;
+            if (!top(timerId, deadline))
+                return;
+
+            std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+            m_heap.pop_back();
+            m_sequence[timerId] = 0;
+            m_live--;
+        }
+
+        bool TimerQueue::contains(unsigned int timerId) const
+        {
+            return timerId < m_sequence.size() && 0 != m_sequence[timerId];
+        }
+
+        bool TimerQueue::isCurrent(const Entry& entry) const
+        {
+            return m_sequence[entry.timerId] == entry.sequence;
+        }
+
+        void TimerQueue::compact()
+        {
+            if (m_heap.size() <= 2 * m_live + TIMER_QUEUE_MIN_SLACK)
+                return;
+
+            m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(),
+                [this](const Entry& entry) { return !isCurrent(entry); }), m_heap.end());
+            std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,73 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Next deadline of every running timer, earliest first.
+        // Timers are identified by their slot in Timer::m_timerItems. A timer is never searched for in
+        // the heap: rescheduling or removing it only bumps its sequence number, and the outdated entry
+        // is dropped once it reaches the top, or when the heap is compacted.
+        class TimerQueue {
+        public:
+            typedef std::chrono::system_clock::time_point TimePoint;
+
+            TimerQueue();
+
+            // Sets the deadline of a timer, replacing the previous one if it is queued
+            void push(unsigned int timerId, const TimePoint& deadline);
+
+            // Removes a timer, no-op if it isn't queued
+            void remove(unsigned int timerId);
+
+            // Earliest deadline, false if no timer is queued
+            bool top(unsigned int& timerId, TimePoint& deadline);
+
+            // Removes the timer returned by top()
+            void pop();
+
+            bool contains(unsigned int timerId) const;
+            size_t size() const { return m_live; }
+
+        private:
+            struct Entry {
+                TimePoint deadline;
+                unsigned int timerId;
+                uint32_t sequence;
+
+                bool operator>(const Entry& other) const { return deadline > other.deadline; }
+            };
+
+            bool isCurrent(const Entry& entry) const;
+            void compact();
+
+            std::vector <Entry> m_heap;
+            std::vector <uint32_t> m_sequence; // per timer id, 0 if the timer isn't queued
+            uint32_t m_lastSequence;
+            size_t m_live;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,186 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+// Compares the cpu cost of the Timer plugin bookkeeping with the deadline heap (TimerQueue) against
+// the linear scans over every running timer done before, for a given number of concurrent timers.
+// Time is simulated: each round starts the timers, cancels some of them and processes all expiries
+// in deadline order, the way onTimerCallback would be called by the TpTimer.
+//
+// Usage: timerBenchmark [-n <timers>] [-r <rounds>] [-c <percent canceled>]
+//   -n  concurrent timers (default 5000)
+//   -r  rounds (default 5)
+//   -c  share of the timers canceled before they expire (default 25)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include "TimerQueue.h"
+
+using namespace WPEFramework::Plugin;
+
+typedef std::chrono::system_clock::time_point TimePoint;
+
+static double cpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Bookkeeping as done before TimerQueue: one scan of the running timers per callback
+static unsigned int runLinear(const std::vector<TimePoint>& deadlines, const std::vector<bool>& canceled)
+{
+    std::vector<TimePoint> items;
+    std::list<int> running;
+    unsigned int fired = 0;
+
+    for (size_t n = 0; n < deadlines.size(); n++)
+    {
+        items.push_back(deadlines[n]);
+        running.push_back(n);
+
+        // checkTimers() after every start
+        TimePoint earliest = TimePoint::max();
+        for (auto it = running.cbegin(); it != running.cend(); ++it)
+            earliest = std::min(earliest, items[*it]);
+    }
+
+    for (size_t n = 0; n < deadlines.size(); n++)
+    {
+        if (!canceled[n])
+            continue;
+        auto it = std::find(running.begin(), running.end(), (int)n);
+        if (running.end() != it)
+            running.erase(it);
+    }
+
+    while (!running.empty())
+    {
+        // The TpTimer fires at the earliest deadline, the callback then scans every timer
+        TimePoint now = TimePoint::max();
+        for (auto it = running.cbegin(); it != running.cend(); ++it)
+            now = std::min(now, items[*it]);
+
+        for (auto it = running.begin(); it != running.end(); )
+        {
+            if (items[*it] <= now)
+            {
+                fired++;
+                it = running.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    return fired;
+}
+
+static unsigned int runQueue(const std::vector<TimePoint>& deadlines, const std::vector<bool>& canceled)
+{
+    TimerQueue queue;
+    unsigned int fired = 0;
+
+    for (size_t n = 0; n < deadlines.size(); n++)
+    {
+        queue.push(n, deadlines[n]);
+
+        unsigned int timerId;
+        TimePoint earliest;
+        queue.top(timerId, earliest);
+    }
+
+    for (size_t n = 0; n < deadlines.size(); n++)
+    {
+        if (canceled[n])
+            queue.remove(n);
+    }
+
+    unsigned int timerId;
+    TimePoint now;
+    while (queue.top(timerId, now))
+    {
+        TimePoint deadline;
+        while (queue.top(timerId, deadline) && deadline <= now)
+        {
+            fired++;
+            queue.pop();
+        }
+    }
+
+    return fired;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int timers = 5000;
+    unsigned int rounds = 5;
+    unsigned int canceledPercent = 25;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:c:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': timers = atoi(optarg); break;
+            case 'r': rounds = atoi(optarg); break;
+            case 'c': canceledPercent = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n <timers>] [-r <rounds>] [-c <percent canceled>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (0 == rounds)
+        rounds = 1;
+
+    srand(1);
+    TimePoint start = std::chrono::system_clock::now();
+    std::vector<TimePoint> deadlines;
+    std::vector<bool> canceled;
+    for (unsigned int n = 0; n < timers; n++)
+    {
+        deadlines.push_back(start + std::chrono::milliseconds(rand() % (3600 * 1000)));
+        canceled.push_back((unsigned int)(rand() % 100) < canceledPercent);
+    }
+
+    unsigned int linearFired = 0, queueFired = 0;
+
+    double cpuStart = cpuTime();
+    for (unsigned int i = 0; i < rounds; i++)
+        linearFired = runLinear(deadlines, canceled);
+    double linear = (cpuTime() - cpuStart) / rounds;
+
+    cpuStart = cpuTime();
+    for (unsigned int i = 0; i < rounds; i++)
+        queueFired = runQueue(deadlines, canceled);
+    double queue = (cpuTime() - cpuStart) / rounds;
+
+    printf("%u timers, %u expired\n", timers, queueFired);
+    printf("linear   cpu %10.2f ms/round\n", linear);
+    printf("queue    cpu %10.2f ms/round\n", queue);
+
+    return (linearFired == queueFired) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "TraceFileFormat.h"
+
+#ifndef __WINDOWS__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <unordered_map>
+
+namespace WPEFramework {
+namespace Plugin {
+
+#ifndef __WINDOWS__
+    // Stores trace entries unformatted in a memory mapped file of a fixed size. When the file
+    // is full it is moved aside to "<name>.1" (replacing the previous one) and a new file is
+    // started, so at most twice the size is used. Names are interned per file, see TraceFileFormat.h.
+    class BinaryOutput {
+    private:
+        BinaryOutput() = delete;
+        BinaryOutput(const BinaryOutput&) = delete;
+        BinaryOutput& operator=(const BinaryOutput&) = delete;
+
+    public:
+        // Room for the file header and a handful of entries; a smaller configured size is raised to this.
+        static const uint32_t MinimumSize = 4096;
+
+        BinaryOutput(const string& fileName, const uint32_t size)
+            : _fileName(fileName)
+            , _size((size < MinimumSize) ? static_cast<uint32_t>(MinimumSize) : size)
+            , _buffer(nullptr)
+            , _offset(0)
+            , _strings()
+        {
+            Open();
+        }
+        ~BinaryOutput()
+        {
+            Close();
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_buffer != nullptr);
+        }
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const char module[],
+            const char category[], const char className[], const char data[], const uint16_t length)
+        {
+            if (_buffer == nullptr) {
+                return;
+            }
+
+            uint16_t lengths[4] = {
+                static_cast<uint16_t>(strlen(fileName)), static_cast<uint16_t>(strlen(module)),
+                static_cast<uint16_t>(strlen(category)), static_cast<uint16_t>(strlen(className))
+            };
+
+            // Worst case every name is new to this file.
+            uint32_t required = TraceFile::EntryHeaderSize + length + 1;
+            for (uint8_t index = 0; index < 4; index++) {
+                required += TraceFile::StringHeaderSize + lengths[index];
+            }
+
+            if (required > (_size - TraceFile::HeaderSize)) {
+                return;
+            }
+
+            // Rotate when the file is full or the string ids of this file are exhausted.
+            if (((_offset + required) > _size) || ((_strings.size() + 4) > 0xFFFF)) {
+                Rotate();
+
+                if (_buffer == nullptr) {
+                    return;
+                }
+            }
+
+            uint16_t ids[4] = {
+                Intern(fileName, lengths[0]), Intern(module, lengths[1]),
+                Intern(category, lengths[2]), Intern(className, lengths[3])
+            };
+
+            Write<uint8_t>(TraceFile::ENTRY);
+            Write<uint64_t>(timestamp);
+            Write<uint32_t>(lineNumber);
+            for (uint8_t index = 0; index < 4; index++) {
+                Write<uint16_t>(ids[index]);
+            }
+            Write<uint16_t>(length);
+            ::memcpy(&_buffer[_offset], data, length);
+            _offset += length;
+        }
+
+    private:
+        template <typename TYPE>
+        inline void Write(const TYPE value)
+        {
+            ::memcpy(&_buffer[_offset], &value, sizeof(TYPE));
+            _offset += sizeof(TYPE);
+        }
+        uint16_t Intern(const char name[], const uint16_t length)
+        {
+            string key(name, length);
+            std::unordered_map<string, uint16_t>::const_iterator index(_strings.find(key));
+
+            if (index != _strings.end()) {
+                return (index->second);
+            }
+
+            uint16_t id = static_cast<uint16_t>(_strings.size());
+            _strings.emplace(key, id);
+
+            Write<uint8_t>(TraceFile::STRING);
+            Write<uint16_t>(id);
+            Write<uint16_t>(length);
+            ::memcpy(&_buffer[_offset], name, length);
+            _offset += length;
+
+            return (id);
+        }
+        void Open()
+        {
+            int fd = ::open(_fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if (fd < 0) {
+                TRACE_L1("Could not create binary trace file %s (%d)", _fileName.c_str(), errno);
+            } else {
+                if (::ftruncate(fd, _size) == 0) {
+                    void* buffer = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+                    if (buffer != MAP_FAILED) {
+                        _buffer = static_cast<uint8_t*>(buffer);
+                    }
+                }
+                ::close(fd);
+            }
+
+            _offset = 0;
+            _strings.clear();
+
+            if (_buffer != nullptr) {
+                ::memcpy(_buffer, TraceFile::Magic, sizeof(TraceFile::Magic));
+                _offset = sizeof(TraceFile::Magic);
+                Write<uint32_t>(TraceFile::Version);
+            }
+        }
+        void Close()
+        {
+            if (_buffer != nullptr) {
+                ::msync(_buffer, _size, MS_ASYNC);
+                ::munmap(_buffer, _size);
+                _buffer = nullptr;
+            }
+        }
+        void Rotate()
+        {
+            Close();
+
+            string previous(_fileName + _T(".1"));
+            ::rename(_fileName.c_str(), previous.c_str());
+
+            Open();
+        }
+
+    private:
+        const string _fileName;
+        const uint32_t _size;
+        uint8_t* _buffer;
+        uint32_t _offset;
+        std::unordered_map<string, uint16_t> _strings;
+    };
+#endif
+
+} // namespace Plugin
+} // namespace WPEFramework
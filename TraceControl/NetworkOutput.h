@@ -0,0 +1,258 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Module.h"
+#include "TraceNetworkFormat.h"
+
+#ifndef __WINDOWS__
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+#ifndef __WINDOWS__
+    // Sends trace messages over UDP, packing as many messages as fit in a datagram. Messages
+    // are queued in a bounded queue and sent from a thread of its own, so a slow network never
+    // holds up the caller. If the queue is full the oldest message is dropped and counted,
+    // the count is reported in every datagram. See TraceNetworkFormat.h for the wire format.
+    class NetworkOutput : public Trace::ITraceMedia, private Core::Thread {
+    private:
+        NetworkOutput() = delete;
+        NetworkOutput(const NetworkOutput&) = delete;
+        NetworkOutput& operator=(const NetworkOutput&) = delete;
+
+        // Time the sender waits after a wakeup, to allow a burst of messages to share a datagram.
+        static constexpr uint32_t LingerTime = 5;
+
+    public:
+        NetworkOutput(const string& address, const uint16_t port, const uint16_t queueSize, const uint16_t datagramSize)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("TraceNetwork"))
+            , _adminLock()
+            , _signal(false, true)
+            , _socket(-1)
+            , _remote()
+            , _remoteLength(0)
+            , _datagramSize(std::min(std::max(datagramSize, static_cast<uint16_t>(TraceNetwork::HeaderSize + TraceNetwork::MessageHeaderSize + 64)), TraceNetwork::MaxDatagramSize))
+            , _slotSize(_datagramSize - TraceNetwork::HeaderSize)
+            , _capacity(std::max(queueSize, static_cast<uint16_t>(1)))
+            , _slots(_capacity * _slotSize)
+            , _lengths(_capacity, 0)
+            , _head(0)
+            , _count(0)
+            , _queued(0)
+            , _dropped(0)
+            , _sequence(0)
+            , _datagram(_datagramSize)
+        {
+            struct addrinfo hints;
+            struct addrinfo* result = nullptr;
+
+            ::memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_DGRAM;
+
+            if (::getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+                TRACE_L1("Could not resolve trace destination %s:%d", address.c_str(), port);
+            } else {
+                _socket = ::socket(result->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+                if (_socket < 0) {
+                    TRACE_L1("Could not create trace socket (%d)", errno);
+                } else {
+                    ::memcpy(&_remote, result->ai_addr, result->ai_addrlen);
+                    _remoteLength = result->ai_addrlen;
+                    Core::Thread::Run();
+                }
+                ::freeaddrinfo(result);
+            }
+        }
+        ~NetworkOutput() override
+        {
+            Core::Thread::Block();
+            _signal.SetEvent();
+            Core::Thread::Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+            if (_socket >= 0) {
+                // Whatever is still queued, is sent before we leave.
+                while (Send() == true) {
+                }
+                ::close(_socket);
+            }
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_socket >= 0);
+        }
+        void Output(const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information) override
+        {
+            Output(Core::Time::Now().Ticks(), fileName, lineNumber, className, information);
+        }
+        // The timestamp is the one of the trace entry, not the time it is sent.
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
+        {
+            if (_socket < 0) {
+                return;
+            }
+
+            const char* strings[5] = { fileName, information->Module(), information->Category(), className, information->Data() };
+            uint16_t lengths[5] = {
+                static_cast<uint16_t>(strlen(fileName)), static_cast<uint16_t>(strlen(information->Module())),
+                static_cast<uint16_t>(strlen(information->Category())), static_cast<uint16_t>(strlen(className)),
+                information->Length()
+            };
+
+            uint32_t size = TraceNetwork::MessageHeaderSize + lengths[0] + lengths[1] + lengths[2] + lengths[3];
+
+            if (size >= _slotSize) {
+                // Not even the names fit, nothing sensible to send.
+                return;
+            }
+
+            // Whatever does not fit of the message itself, is cut off.
+            lengths[4] = static_cast<uint16_t>(std::min(static_cast<uint32_t>(lengths[4]), _slotSize - size));
+            size += lengths[4];
+
+            _adminLock.Lock();
+
+            if (_count == _capacity) {
+                // Make room by dropping the oldest message.
+                _queued -= _lengths[_head];
+                _head = (_head + 1) % _capacity;
+                _count--;
+                _dropped++;
+            }
+
+            uint16_t slot = (_head + _count) % _capacity;
+            uint8_t* buffer = &_slots[slot * _slotSize];
+
+            ::memcpy(buffer, &timestamp, sizeof(timestamp));
+            buffer += sizeof(timestamp);
+            ::memcpy(buffer, &lineNumber, sizeof(lineNumber));
+            buffer += sizeof(lineNumber);
+            ::memcpy(buffer, lengths, sizeof(lengths));
+            buffer += sizeof(lengths);
+
+            for (uint8_t index = 0; index < 5; index++) {
+                ::memcpy(buffer, strings[index], lengths[index]);
+                buffer += lengths[index];
+            }
+
+            _lengths[slot] = static_cast<uint16_t>(size);
+            _queued += size;
+            _count++;
+
+            _adminLock.Unlock();
+
+            _signal.SetEvent();
+        }
+
+    private:
+        uint32_t Worker() override
+        {
+            _signal.Lock(Core::infinite);
+
+            if (Core::Thread::IsRunning() == true) {
+                _adminLock.Lock();
+                bool partial = ((_count > 0) && (_queued < _slotSize));
+                _adminLock.Unlock();
+
+                if (partial == true) {
+                    SleepMs(LingerTime);
+                }
+
+                while ((Core::Thread::IsRunning() == true) && (Send() == true)) {
+                }
+            }
+
+            return (0);
+        }
+
+        // Sends one datagram filled with the oldest queued messages. Returns false if there was nothing to send.
+        bool Send()
+        {
+            uint16_t count = 0;
+            uint32_t offset = TraceNetwork::HeaderSize;
+            uint32_t dropped;
+
+            _adminLock.Lock();
+
+            while ((_count > 0) && ((offset + _lengths[_head]) <= _datagramSize)) {
+                ::memcpy(&_datagram[offset], &_slots[_head * _slotSize], _lengths[_head]);
+                offset += _lengths[_head];
+                _queued -= _lengths[_head];
+                _head = (_head + 1) % _capacity;
+                _count--;
+                count++;
+            }
+
+            dropped = _dropped;
+
+            _adminLock.Unlock();
+
+            if (count > 0) {
+                uint8_t* header = _datagram.data();
+
+                ::memcpy(header, TraceNetwork::Magic, sizeof(TraceNetwork::Magic));
+                header += sizeof(TraceNetwork::Magic);
+                ::memcpy(header, &_sequence, sizeof(_sequence));
+                header += sizeof(_sequence);
+                ::memcpy(header, &dropped, sizeof(dropped));
+                header += sizeof(dropped);
+                ::memcpy(header, &count, sizeof(count));
+
+                _sequence++;
+
+                if (::sendto(_socket, _datagram.data(), offset, MSG_DONTWAIT, reinterpret_cast<const struct sockaddr*>(&_remote), _remoteLength) < 0) {
+                    TRACE_L1("Could not send trace datagram (%d)", errno);
+                }
+            }
+
+            return (count > 0);
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        Core::Event _signal;
+        int _socket;
+        struct sockaddr_storage _remote;
+        socklen_t _remoteLength;
+        const uint16_t _datagramSize;
+        const uint32_t _slotSize;
+        const uint16_t _capacity;
+        std::vector<uint8_t> _slots;
+        std::vector<uint16_t> _lengths;
+        uint16_t _head;
+        uint16_t _count;
+        uint32_t _queued;
+        uint32_t _dropped;
+        uint32_t _sequence;
+        std::vector<uint8_t> _datagram;
+    };
+#endif
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -19,6 +19,8 @@
  
 #include "TraceControl.h"
 #include "TraceOutput.h"
+#include "BinaryOutput.h"
+#include "NetworkOutput.h"
 
 namespace WPEFramework {
 
@@ -74,10 +76,35 @@ namespace Plugin {
             _outputs.push_back(new Plugin::TraceOutput(true));
         }
         if (_config.Remote.IsSet() == true) {
-            Core::NodeId logNode(_config.Remote.Binding.Value().c_str(), _config.Remote.Port.Value());
+#ifndef __WINDOWS__
+            if ((_config.Remote.Batched.IsSet() == true) && (_config.Remote.Batched.Value() == true)) {
+                // Binding is the destination of the datagrams here.
+                _network = new Plugin::NetworkOutput(_config.Remote.Binding.Value(), _config.Remote.Port.Value(),
+                    _config.Remote.Queue.Value(), _config.Remote.Datagram.Value());
+            } else
+#endif
+            {
+                Core::NodeId logNode(_config.Remote.Binding.Value().c_str(), _config.Remote.Port.Value());
+
+                _outputs.push_back(new Trace::TraceMedia(logNode));
+            }
+        }
+#ifndef __WINDOWS__
+        if (_config.Binary.IsSet() == true) {
+            string fileName(_config.Binary.Path.Value());
+
+            // A relative path is taken relative to the volatile path of this plugin.
+            if ((fileName.empty() == false) && (fileName[0] != '/')) {
+                fileName = service->VolatilePath() + fileName;
+            }
 
-            _outputs.push_back(new Trace::TraceMedia(logNode));
+            if (_config.Binary.Size.Value() < Plugin::BinaryOutput::MinimumSize) {
+                SYSLOG(Logging::Startup, (_T("Binary trace file size %u is too small, using %u"), _config.Binary.Size.Value(), Plugin::BinaryOutput::MinimumSize));
+            }
+
+            _binary = new Plugin::BinaryOutput(fileName, _config.Binary.Size.Value());
         }
+#endif
 
         _service->Register(&_observer);
 
@@ -102,6 +129,18 @@ namespace Plugin {
 
             _outputs.pop_front();
         }
+
+#ifndef __WINDOWS__
+        if (_network != nullptr) {
+            delete _network;
+            _network = nullptr;
+        }
+
+        if (_binary != nullptr) {
+            delete _binary;
+            _binary = nullptr;
+        }
+#endif
     }
 
     /* virtual */ string TraceControl::Information() const
@@ -218,6 +257,17 @@ namespace Plugin {
             (*index)->Output(information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
             index++;
         }
+
+#ifndef __WINDOWS__
+        if (_network != nullptr) {
+            _network->Output(information.Timestamp(), information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
+        }
+
+        if (_binary != nullptr) {
+            _binary->Output(information.Timestamp(), information.FileName(), information.LineNumber(), information.Module(),
+                information.Category(), information.ClassName(), information.Information(), information.Length());
+        }
+#endif
     }
 }
 }
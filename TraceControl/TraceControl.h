@@ -20,12 +20,17 @@
 #pragma once
 
 #include "Module.h"
+#include "TraceNetworkFormat.h"
+#include "TraceMerge.h"
 #include <interfaces/json/JsonData_TraceControl.h>
 
 namespace WPEFramework {
 
 namespace Plugin {
 
+    class BinaryOutput;
+    class NetworkOutput;
+
     class TraceControl : public PluginHost::IPlugin, public PluginHost::IWeb, public PluginHost::JSONRPC {
 
     public:
@@ -551,6 +556,7 @@ namespace Plugin {
             Observer(TraceControl& parent)
                 : Thread(Core::Thread::DefaultStackSize(), _T("TraceWorker"))
                 , _buffers()
+                , _pending()
                 , _traceControl(Trace::TraceUnit::Instance())
                 , _parent(parent)
                 , _refcount(0)
@@ -560,6 +566,7 @@ namespace Plugin {
             {
                 ASSERT(_refcount == 0);
                 ASSERT(_buffers.size() == 0);
+                ASSERT(_pending.IsEmpty() == true);
                 _traceControl.Relinquish();
                 Wait(Thread::BLOCKED | Thread::STOPPED | Thread::STOPPING, Core::infinite);
             }
@@ -571,7 +578,10 @@ namespace Plugin {
             }
             void Start() 
             {
-                _buffers.insert(std::pair<const uint32_t, Source*>(0, new Source(_parent.TracePath(), nullptr)));
+                Source* source = new Source(_parent.TracePath(), nullptr);
+
+                _buffers.insert(std::pair<const uint32_t, Source*>(0, source));
+                _pending.Add(source);
                 Thread::Run();
             }
             void Stop()
@@ -584,6 +594,8 @@ namespace Plugin {
 
                 _adminLock.Lock();
 
+                _pending.Clear();
+
                 while (_buffers.size() != 0) {
                     delete _buffers.begin()->second;
 
@@ -599,7 +611,10 @@ namespace Plugin {
                 ASSERT(_buffers.find(connection->Id()) == _buffers.end());
 
                 // By definition, get the buffer file from WPEFramework (local source)
-                _buffers.insert(std::pair<const uint32_t, Source*>(connection->Id(), new Source(_parent.TracePath(), connection)));
+                Source* source = new Source(_parent.TracePath(), connection);
+
+                _buffers.insert(std::pair<const uint32_t, Source*>(connection->Id(), source));
+                _pending.Add(source);
 
                 _adminLock.Unlock();
             }
@@ -610,6 +625,8 @@ namespace Plugin {
                 std::map<const uint32_t, Source*>::iterator index(_buffers.find(connection->Id()));
 
                 if (index != _buffers.end()) {
+                    _pending.Remove(index->second);
+
                     delete (index->second);
                     _buffers.erase(index);
                 }
@@ -665,62 +682,50 @@ namespace Plugin {
 
                 return (Core::ERROR_NONE);
             }
+            // Load the next entry of an idle source, true if it has one now.
+            static bool Load(Source* source)
+            {
+                Source::state state(source->Load());
+
+                if (state == Source::FAILURE) {
+                    // Oops this requires recovery, so let's flush
+                    source->Flush();
+                }
+
+                return (state == Source::LOADED);
+            }
+
             virtual uint32_t Worker()
             {
-                
                 while ((IsRunning() == true) && (_traceControl.Wait(Core::infinite) == Core::ERROR_NONE)) {
                     // Before we start we reset the flag, if new info is coming in, we will get a retrigger flag.
+                    // A producer that is still completing an entry retriggers once it is committed, so there
+                    // is no need to spin on a partial entry, it will be picked up on the next round.
                     _traceControl.Acknowledge();
 
-                    Source* selected;
-
-                    uint64_t timeStamp;
+                    _adminLock.Lock();
 
-                    do {
-                        selected = nullptr;
+                    // k-way merge: output the oldest entry. The idle sources are read again before every
+                    // entry, a source that was empty a moment ago may hold an older entry by now.
+                    _pending.Refill(Load);
 
-                        _adminLock.Lock();
-
-                        timeStamp = static_cast<uint64_t>(~0);
-
-                        std::map<const uint32_t, Source*>::iterator index(_buffers.begin());
-
-                        while (index != _buffers.end()) {
-
-                            Source::state state(index->second->Load());
-
-                            if (state == Source::LOADED) {
-                                if (index->second->Timestamp() < timeStamp) {
-                                    timeStamp = index->second->Timestamp();
-
-                                    if (state == Source::LOADED) {
-                                        selected = index->second;
-                                    }
-                                }
-                            } else if (state == Source::FAILURE) {
-                                // Oops this requires recovery, so let's flush
-                                index->second->Flush();
-                            }
-
-                            index++;
-                        }
+                    while ((IsRunning() == true) && (_pending.IsEmpty() == false)) {
+                        Source* selected = _pending.Pop();
 
-                        if (selected != nullptr) {
+                        // Oke, output this entry
+                        _parent.Dispatch(*selected);
 
-                            // Oke, output this entry
-                            _parent.Dispatch(*selected);
-
-                            // Ready to load a new one..
-                            selected->Clear();
-                        } else if (timeStamp != static_cast<uint64_t>(~0)) {
-                            // Looks like we are waiting for a message to be completed.
-                            // Give up our slice, so the producer, can produce.
-                            ::SleepMs(0);
-                        }
+                        // Ready to load a new one..
+                        selected->Clear();
 
+                        // Let (de)activations of sources in between entries.
                         _adminLock.Unlock();
+                        _adminLock.Lock();
 
-                    } while ((IsRunning() == true) && (timeStamp != static_cast<uint64_t>(~0)));
+                        _pending.Refill(Load);
+                    }
+
+                    _adminLock.Unlock();
                 }
 
                 return (Core::infinite);
@@ -729,6 +734,7 @@ namespace Plugin {
         private:
             Core::CriticalSection _adminLock;
             std::map<const uint32_t, Source*> _buffers;
+            TraceMerge<Source> _pending;
             Trace::TraceUnit& _traceControl;
             TraceControl& _parent;
             mutable uint32_t _refcount;
@@ -778,17 +784,29 @@ namespace Plugin {
                 : Core::JSON::Container()
                 , Port(2200)
                 , Binding("0.0.0.0")
+                , Batched(false)
+                , Queue(256)
+                , Datagram(TraceNetwork::DefaultDatagramSize)
             {
                 Add(_T("port"), &Port);
                 Add(_T("binding"), &Binding);
+                Add(_T("batched"), &Batched);
+                Add(_T("queue"), &Queue);
+                Add(_T("datagram"), &Datagram);
             }
             NetworkNode(const NetworkNode& copy)
                 : Core::JSON::Container()
                 , Port(copy.Port)
                 , Binding(copy.Binding)
+                , Batched(copy.Batched)
+                , Queue(copy.Queue)
+                , Datagram(copy.Datagram)
             {
                 Add(_T("port"), &Port);
                 Add(_T("binding"), &Binding);
+                Add(_T("batched"), &Batched);
+                Add(_T("queue"), &Queue);
+                Add(_T("datagram"), &Datagram);
             }
             ~NetworkNode()
             {
@@ -798,6 +816,9 @@ namespace Plugin {
             {
                 Port = RHS.Port;
                 Binding = RHS.Binding;
+                Batched = RHS.Batched;
+                Queue = RHS.Queue;
+                Datagram = RHS.Datagram;
 
                 return (*this);
             }
@@ -805,6 +826,43 @@ namespace Plugin {
         public:
             Core::JSON::DecUInt16 Port;
             Core::JSON::String Binding;
+            Core::JSON::Boolean Batched;
+            Core::JSON::DecUInt16 Queue;
+            Core::JSON::DecUInt16 Datagram; // payload per datagram, at most 65507
+        };
+        class BinaryNode : public Core::JSON::Container {
+        public:
+            BinaryNode()
+                : Core::JSON::Container()
+                , Path(_T("trace.bin"))
+                , Size(1024 * 1024)
+            {
+                Add(_T("path"), &Path);
+                Add(_T("size"), &Size);
+            }
+            BinaryNode(const BinaryNode& copy)
+                : Core::JSON::Container()
+                , Path(copy.Path)
+                , Size(copy.Size)
+            {
+                Add(_T("path"), &Path);
+                Add(_T("size"), &Size);
+            }
+            ~BinaryNode()
+            {
+            }
+
+            BinaryNode& operator=(const BinaryNode& RHS)
+            {
+                Path = RHS.Path;
+                Size = RHS.Size;
+
+                return (*this);
+            }
+
+        public:
+            Core::JSON::String Path;
+            Core::JSON::DecUInt32 Size;
         };
         class Config : public Core::JSON::Container {
         private:
@@ -817,10 +875,12 @@ namespace Plugin {
                 , Console(false)
                 , SysLog(true)
                 , Remote()
+                , Binary()
             {
                 Add(_T("console"), &Console);
                 Add(_T("syslog"), &SysLog);
                 Add(_T("remote"), &Remote);
+                Add(_T("binary"), &Binary);
             }
             ~Config()
             {
@@ -830,6 +890,7 @@ namespace Plugin {
             Core::JSON::Boolean Console;
             Core::JSON::Boolean SysLog;
             NetworkNode Remote;
+            BinaryNode Binary;
         };
         class Data : public Core::JSON::Container {
         public:
@@ -925,6 +986,8 @@ namespace Plugin {
             : _skipURL(0)
             , _service(nullptr)
             , _outputs()
+            , _binary(nullptr)
+            , _network(nullptr)
             , _tracePath()
             , _observer(*this)
         {
@@ -996,6 +1059,8 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Config _config;
         std::list<Trace::ITraceMedia*> _outputs;
+        BinaryOutput* _binary;
+        NetworkOutput* _network; // batched remote output, gets the timestamps of the entries
         string _tracePath;
         Observer _observer;
     };
@@ -0,0 +1,54 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Layout of the binary trace files written by BinaryOutput and read by the TraceDecoder tool.
+// Kept free of framework dependencies so the decoder can be built on the host.
+//
+// A file starts with a Header, followed by records. Each record starts with a one byte type.
+// A zero type marks the end of the valid data (the file is pre-sized and zero filled).
+// All integers are little endian, as written by the box.
+//
+//   STRING: type(1) id(2) length(2) characters(length)
+//   ENTRY:  type(1) timestamp(8) line(4) file(2) module(2) category(2) class(2) length(2) data(length)
+//
+// Strings (file, module, category and class names) are defined once per file by a STRING
+// record and referred to by id from the ENTRY records that follow.
+
+namespace WPEFramework {
+namespace TraceFile {
+
+    static const char Magic[8] = { 'W', 'P', 'E', 'T', 'R', 'A', 'C', 'E' };
+    static const uint32_t Version = 1;
+
+    enum RecordType : uint8_t {
+        END = 0,
+        STRING = 1,
+        ENTRY = 2
+    };
+
+    static const uint32_t HeaderSize = sizeof(Magic) + sizeof(uint32_t);
+    static const uint32_t StringHeaderSize = 1 + 2 + 2;
+    static const uint32_t EntryHeaderSize = 1 + 8 + 4 + (4 * 2) + 2;
+
+} // namespace TraceFile
+} // namespace WPEFramework
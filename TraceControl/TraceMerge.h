@@ -0,0 +1,140 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+// K-way merge of trace sources on their timestamps, as done by the Observer worker. Kept free
+// of framework dependencies so it can be benchmarked on the host (see test/TraceMergeBenchmark).
+//
+// Sources with an entry loaded are kept in a heap, the others in an idle list. Before every entry
+// the worker refills: each idle source is read again, and pushed once it has an entry. Then the
+// source with the oldest entry is popped, which makes it idle again until its next entry is loaded.
+// Only idle sources are looked at, so an entry costs O(log N) for N busy sources plus one cheap
+// read attempt per idle one, instead of comparing all of them. Reading idle sources before every
+// entry, not only when the heap runs empty, keeps a busy source from starving the others: their
+// cyclic buffers would overflow and their entries come out behind newer ones.
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // SOURCE needs a uint64_t Timestamp() const of the loaded entry.
+    // Sources are Add()ed once and stay known until Remove()d.
+    template <typename SOURCE>
+    class TraceMerge {
+    private:
+        TraceMerge(const TraceMerge&) = delete;
+        TraceMerge& operator=(const TraceMerge&) = delete;
+
+        // Orders the heap so the oldest entry is on top.
+        struct Earliest {
+            inline bool operator()(const SOURCE* lhs, const SOURCE* rhs) const
+            {
+                return (lhs->Timestamp() > rhs->Timestamp());
+            }
+        };
+
+    public:
+        TraceMerge()
+            : _pending()
+            , _idle()
+        {
+        }
+        ~TraceMerge()
+        {
+        }
+
+    public:
+        inline bool IsEmpty() const
+        {
+            return (_pending.empty());
+        }
+        inline uint32_t Count() const
+        {
+            return (static_cast<uint32_t>(_pending.size()));
+        }
+        void Add(SOURCE* source)
+        {
+            _idle.push_back(source);
+        }
+        // LOADER is called as bool(SOURCE*) for every idle source, and returns true if the source
+        // has an entry loaded now.
+        template <typename LOADER>
+        void Refill(LOADER loader)
+        {
+            uint32_t index = 0;
+
+            while (index < _idle.size()) {
+                if (loader(_idle[index]) == true) {
+                    _pending.push_back(_idle[index]);
+                    std::push_heap(_pending.begin(), _pending.end(), Earliest());
+
+                    _idle[index] = _idle.back();
+                    _idle.pop_back();
+                } else {
+                    index++;
+                }
+            }
+        }
+        // The source with the oldest entry, it is idle again after this.
+        SOURCE* Pop()
+        {
+            SOURCE* result = nullptr;
+
+            if (_pending.empty() == false) {
+                std::pop_heap(_pending.begin(), _pending.end(), Earliest());
+                result = _pending.back();
+                _pending.pop_back();
+                _idle.push_back(result);
+            }
+
+            return (result);
+        }
+        void Remove(const SOURCE* source)
+        {
+            typename std::vector<SOURCE*>::iterator entry(std::find(_pending.begin(), _pending.end(), source));
+
+            if (entry != _pending.end()) {
+                _pending.erase(entry);
+                std::make_heap(_pending.begin(), _pending.end(), Earliest());
+            } else {
+                entry = std::find(_idle.begin(), _idle.end(), source);
+
+                if (entry != _idle.end()) {
+                    _idle.erase(entry);
+                }
+            }
+        }
+        void Clear()
+        {
+            _pending.clear();
+            _idle.clear();
+        }
+
+    private:
+        std::vector<SOURCE*> _pending;
+        std::vector<SOURCE*> _idle;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
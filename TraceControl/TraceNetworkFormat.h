@@ -0,0 +1,51 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Layout of the datagrams sent by NetworkOutput. Kept free of framework dependencies so
+// receivers can be built on the host. All integers are little endian, as sent by the box.
+//
+//   DATAGRAM: magic(4) sequence(4) dropped(4) count(2) followed by count MESSAGEs
+//   MESSAGE:  timestamp(8) line(4) file(2) module(2) category(2) class(2) data(2) followed by
+//             the characters of file, module, category, class and data, lengths as announced,
+//             no terminators
+//
+// The sequence number increases by one for every datagram sent, so a receiver can detect
+// lost and reordered datagrams. Dropped is the running total of messages the sender had to
+// discard because its queue overflowed.
+
+namespace WPEFramework {
+namespace TraceNetwork {
+
+    static const char Magic[4] = { 'W', 'P', 'E', 'N' };
+
+    static const uint16_t HeaderSize = sizeof(Magic) + 4 + 4 + 2;
+    static const uint16_t MessageHeaderSize = 8 + 4 + (5 * 2);
+
+    // Payload of a single UDP datagram on a 1500 byte ethernet MTU.
+    static const uint16_t DefaultDatagramSize = 1500 - 20 /* IPv4 */ - 8 /* UDP */;
+
+    // Largest payload of a UDP datagram over IPv4, larger ones are never sent.
+    static const uint16_t MaxDatagramSize = 65535 - 20 /* IPv4 */ - 8 /* UDP */;
+
+} // namespace TraceNetwork
+} // namespace WPEFramework
@@ -0,0 +1,202 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Prints the binary trace files written by the TraceControl plugin ("binary" output) as text.
+// Usage: TraceDecoder <file> [<file> ...]
+// Pass "trace.bin.1" before "trace.bin" to get the entries in chronological order.
+
+#include "TraceFileFormat.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+using namespace WPEFramework;
+
+namespace {
+
+class Reader {
+public:
+    Reader(const std::vector<uint8_t>& data)
+        : _data(data)
+        , _offset(0)
+    {
+    }
+
+    bool Available(const size_t size) const
+    {
+        return ((_offset + size) <= _data.size());
+    }
+    template <typename TYPE>
+    TYPE Read()
+    {
+        TYPE value;
+        ::memcpy(&value, &_data[_offset], sizeof(TYPE));
+        _offset += sizeof(TYPE);
+        return (value);
+    }
+    std::string ReadString(const uint16_t length)
+    {
+        std::string value(reinterpret_cast<const char*>(&_data[_offset]), length);
+        _offset += length;
+        return (value);
+    }
+    void Skip(const size_t size)
+    {
+        _offset += size;
+    }
+
+private:
+    const std::vector<uint8_t>& _data;
+    size_t _offset;
+};
+
+const std::string& Lookup(const std::vector<std::string>& strings, const uint16_t id)
+{
+    static const std::string unknown("<unknown>");
+    return (id < strings.size() ? strings[id] : unknown);
+}
+
+void PrintTimestamp(const uint64_t timestamp)
+{
+    // Timestamps are Core::Time ticks, microseconds since the epoch.
+    time_t seconds = static_cast<time_t>(timestamp / 1000000);
+    struct tm moment;
+    char buffer[32];
+
+    ::gmtime_r(&seconds, &moment);
+    ::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &moment);
+    ::printf("%s.%06u", buffer, static_cast<unsigned>(timestamp % 1000000));
+}
+
+bool Decode(const char fileName[])
+{
+    FILE* file = ::fopen(fileName, "rb");
+
+    if (file == nullptr) {
+        ::fprintf(stderr, "%s: could not open\n", fileName);
+        return (false);
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t block[64 * 1024];
+    size_t loaded;
+
+    while ((loaded = ::fread(block, 1, sizeof(block), file)) > 0) {
+        data.insert(data.end(), block, block + loaded);
+    }
+    ::fclose(file);
+
+    Reader reader(data);
+
+    if ((reader.Available(TraceFile::HeaderSize) == false) || (::memcmp(data.data(), TraceFile::Magic, sizeof(TraceFile::Magic)) != 0)) {
+        ::fprintf(stderr, "%s: not a trace file\n", fileName);
+        return (false);
+    }
+
+    reader.Skip(sizeof(TraceFile::Magic));
+    uint32_t version = reader.Read<uint32_t>();
+
+    if (version != TraceFile::Version) {
+        ::fprintf(stderr, "%s: unsupported version %u\n", fileName, version);
+        return (false);
+    }
+
+    std::vector<std::string> strings;
+    bool result = true;
+
+    while (reader.Available(1) == true) {
+        uint8_t type = reader.Read<uint8_t>();
+
+        if (type == TraceFile::END) {
+            break;
+        } else if (type == TraceFile::STRING) {
+            if (reader.Available(TraceFile::StringHeaderSize - 1) == false) {
+                result = false;
+                break;
+            }
+            uint16_t id = reader.Read<uint16_t>();
+            uint16_t length = reader.Read<uint16_t>();
+
+            if (reader.Available(length) == false) {
+                result = false;
+                break;
+            }
+            if (id >= strings.size()) {
+                strings.resize(id + 1);
+            }
+            strings[id] = reader.ReadString(length);
+        } else if (type == TraceFile::ENTRY) {
+            if (reader.Available(TraceFile::EntryHeaderSize - 1) == false) {
+                result = false;
+                break;
+            }
+            uint64_t timestamp = reader.Read<uint64_t>();
+            uint32_t line = reader.Read<uint32_t>();
+            uint16_t fileId = reader.Read<uint16_t>();
+            uint16_t moduleId = reader.Read<uint16_t>();
+            uint16_t categoryId = reader.Read<uint16_t>();
+            uint16_t classId = reader.Read<uint16_t>();
+            uint16_t length = reader.Read<uint16_t>();
+
+            if (reader.Available(length) == false) {
+                result = false;
+                break;
+            }
+            std::string information(reader.ReadString(length));
+
+            PrintTimestamp(timestamp);
+            ::printf(" [%s:%s] %s:%u %s: %s\n",
+                Lookup(strings, moduleId).c_str(), Lookup(strings, categoryId).c_str(),
+                Lookup(strings, fileId).c_str(), line, Lookup(strings, classId).c_str(), information.c_str());
+        } else {
+            result = false;
+            break;
+        }
+    }
+
+    if (result == false) {
+        ::fprintf(stderr, "%s: corrupt record, decoding stopped\n", fileName);
+    }
+
+    return (result);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int result = 0;
+
+    if (argc < 2) {
+        ::fprintf(stderr, "Usage: %s <file> [<file> ...]\n", argv[0]);
+        return (1);
+    }
+
+    for (int index = 1; index < argc; index++) {
+        if (Decode(argv[index]) == false) {
+            result = 1;
+        }
+    }
+
+    return (result);
+}
@@ -0,0 +1,416 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Throughput of the k-way merge of the Observer worker against the linear scan it replaced.
+// Every source holds a run of increasing timestamps with random gaps, like a process tracing
+// into its cyclic buffer; both merges must output all entries in timestamp order.
+//
+// A second run merges while producer threads are still writing: one writes in bursts, the
+// others now and then, into bounded buffers that drop their oldest entry when full. It is
+// merged once refilling idle sources only when nothing is queued (as the worker first did) and
+// once refilling them before every entry, and reports entries dropped and entries that came out
+// behind a newer one.
+//
+// Usage: TraceMergeBenchmark [-s <sources,...>] [-e <entries per source>]
+//   -s  comma separated source counts (default 2,8,32,128)
+//   -e  entries per source (default 50000)
+// Exits with 1 if an entry is lost or comes out of order in the pre-filled run, or if entries
+// are not accounted for in the live run.
+
+#include "TraceMerge.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework;
+
+namespace {
+
+class Source {
+public:
+    Source(const uint32_t entries, uint32_t& seed)
+        : _timestamps(entries)
+        , _index(0)
+    {
+        uint64_t timestamp = 0;
+
+        for (uint32_t entry = 0; entry < entries; entry++) {
+            seed = (seed * 1103515245) + 12345;
+            timestamp += (seed >> 16) % 1000;
+            _timestamps[entry] = timestamp;
+        }
+    }
+
+public:
+    inline uint64_t Timestamp() const
+    {
+        return (_timestamps[_index]);
+    }
+    inline bool Load()
+    {
+        return (_index < _timestamps.size());
+    }
+    inline void Next()
+    {
+        _index++;
+    }
+    inline void Reset()
+    {
+        _index = 0;
+    }
+
+private:
+    std::vector<uint64_t> _timestamps;
+    size_t _index;
+};
+
+double WallTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0));
+}
+
+// What the worker did before: look at every source for each entry.
+uint64_t ScanMerge(std::vector<Source*>& sources, bool& ordered)
+{
+    uint64_t count = 0;
+    uint64_t last = 0;
+
+    while (true) {
+        Source* selected = nullptr;
+
+        for (Source* source : sources) {
+            if ((source->Load() == true) && ((selected == nullptr) || (source->Timestamp() < selected->Timestamp()))) {
+                selected = source;
+            }
+        }
+
+        if (selected == nullptr) {
+            break;
+        }
+
+        ordered = ordered && (selected->Timestamp() >= last);
+        last = selected->Timestamp();
+        count++;
+        selected->Next();
+    }
+
+    return (count);
+}
+
+bool Load(Source* source)
+{
+    return (source->Load());
+}
+
+uint64_t HeapMerge(std::vector<Source*>& sources, bool& ordered)
+{
+    Plugin::TraceMerge<Source> merge;
+    uint64_t count = 0;
+    uint64_t last = 0;
+
+    for (Source* source : sources) {
+        merge.Add(source);
+    }
+
+    merge.Refill(Load);
+
+    while (merge.IsEmpty() == false) {
+        Source* selected = merge.Pop();
+
+        ordered = ordered && (selected->Timestamp() >= last);
+        last = selected->Timestamp();
+        count++;
+        selected->Next();
+
+        merge.Refill(Load);
+    }
+
+    return (count);
+}
+
+// A cyclic buffer written by a producer thread. Timestamps come from one clock for all sources
+// and are taken under the lock of the source, so every source holds them in increasing order.
+// Like Core::CyclicBuffer, reading an empty one does not take the lock.
+class LiveSource {
+public:
+    static const uint32_t Capacity = 256;
+
+    LiveSource()
+        : _lock()
+        , _entries()
+        , _used(0)
+        , _loaded(false)
+        , _timestamp(0)
+        , _dropped(0)
+    {
+    }
+
+public:
+    void Write(std::atomic<uint64_t>& clock)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        if (_entries.size() == Capacity) {
+            _entries.pop_front();
+            _dropped++;
+        }
+        _entries.push_back(clock.fetch_add(1));
+        _used.store(static_cast<uint32_t>(_entries.size()), std::memory_order_release);
+    }
+    bool Load()
+    {
+        if ((_loaded == false) && (_used.load(std::memory_order_acquire) != 0)) {
+            std::lock_guard<std::mutex> guard(_lock);
+
+            if (_entries.empty() == false) {
+                _timestamp = _entries.front();
+                _entries.pop_front();
+                _used.store(static_cast<uint32_t>(_entries.size()), std::memory_order_release);
+                _loaded = true;
+            }
+        }
+        return (_loaded);
+    }
+    inline uint64_t Timestamp() const
+    {
+        return (_timestamp);
+    }
+    inline void Clear()
+    {
+        _loaded = false;
+    }
+    uint64_t Dropped()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return (_dropped);
+    }
+
+private:
+    std::mutex _lock;
+    std::deque<uint64_t> _entries;
+    std::atomic<uint32_t> _used;
+    bool _loaded;
+    uint64_t _timestamp;
+    uint64_t _dropped;
+};
+
+bool LoadLive(LiveSource* source)
+{
+    return (source->Load());
+}
+
+struct LiveResult {
+    uint64_t written;
+    uint64_t merged;
+    uint64_t dropped;
+    uint64_t late;
+    double time;
+};
+
+// Merges while the producers run. perEntry selects refilling all idle sources before every entry,
+// otherwise only the source just dispatched is read again until nothing is queued.
+LiveResult LiveMerge(const uint32_t count, const uint32_t entries, const bool perEntry)
+{
+    std::vector<LiveSource*> sources;
+    for (uint32_t index = 0; index < count; index++) {
+        sources.push_back(new LiveSource());
+    }
+
+    std::atomic<uint64_t> clock(1);
+    std::atomic<uint32_t> running(count);
+    std::vector<std::thread> producers;
+    uint64_t written = 0;
+
+    for (uint32_t index = 0; index < count; index++) {
+        // The first source is the busy one, the others write a tenth as much with longer pauses
+        const uint32_t total = (index == 0 ? entries : std::max(entries / 10, 1u));
+        written += total;
+
+        producers.push_back(std::thread([&, index, total]() {
+            for (uint32_t entry = 0; entry < total; entry++) {
+                sources[index]->Write(clock);
+                if ((entry % 16) == 15) {
+                    if (index == 0) {
+                        std::this_thread::yield();
+                    } else {
+                        usleep(100);
+                    }
+                }
+            }
+            running--;
+        }));
+    }
+
+    Plugin::TraceMerge<LiveSource> merge;
+    for (LiveSource* source : sources) {
+        merge.Add(source);
+    }
+
+    LiveResult result = { written, 0, 0, 0, 0 };
+    uint64_t last = 0;
+    double start = WallTime();
+
+    while (true) {
+        bool finished = (running.load() == 0);
+
+        merge.Refill(LoadLive);
+
+        if (merge.IsEmpty() == true) {
+            if (finished == true) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        while (merge.IsEmpty() == false) {
+            LiveSource* selected = merge.Pop();
+
+            if (selected->Timestamp() < last) {
+                result.late++;
+            } else {
+                last = selected->Timestamp();
+            }
+            result.merged++;
+            selected->Clear();
+
+            if (perEntry == true) {
+                merge.Refill(LoadLive);
+            } else {
+                merge.Refill([selected](LiveSource* source) { return ((source == selected) && (source->Load() == true)); });
+            }
+        }
+    }
+
+    result.time = WallTime() - start;
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    for (LiveSource* source : sources) {
+        result.dropped += source->Dropped();
+        delete source;
+    }
+
+    return (result);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string sourceList = "2,8,32,128";
+    uint32_t entries = 50000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:e:")) != -1) {
+        switch (opt) {
+        case 's':
+            sourceList = optarg;
+            break;
+        case 'e':
+            entries = static_cast<uint32_t>(atoi(optarg));
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-s <sources,...>] [-e <entries per source>]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    int result = 0;
+
+    std::vector<uint32_t> counts;
+
+    for (const char* p = sourceList.c_str(); *p != '\0';) {
+        char* end = nullptr;
+        unsigned long count = strtoul(p, &end, 10);
+
+        if ((end == p) || (count == 0) || ((*end != ',') && (*end != '\0'))) {
+            fprintf(stderr, "Invalid source list '%s'\n", sourceList.c_str());
+            return (1);
+        }
+        counts.push_back(static_cast<uint32_t>(count));
+        p = (*end == ',' ? end + 1 : end);
+    }
+
+    for (uint32_t count : counts) {
+        uint32_t seed = 1;
+        std::vector<Source*> sources;
+        for (uint32_t index = 0; index < count; index++) {
+            sources.push_back(new Source(entries, seed));
+        }
+
+        const uint64_t total = static_cast<uint64_t>(count) * entries;
+        bool ordered = true;
+
+        double start = WallTime();
+        uint64_t scanned = ScanMerge(sources, ordered);
+        double scanTime = WallTime() - start;
+
+        for (Source* source : sources) {
+            source->Reset();
+        }
+
+        start = WallTime();
+        uint64_t merged = HeapMerge(sources, ordered);
+        double heapTime = WallTime() - start;
+
+        bool ok = ordered && (scanned == total) && (merged == total);
+
+        printf("%4u sources  scan %9.2f ms (%6.1f M/s)  heap %9.2f ms (%6.1f M/s)  %s\n", count,
+            scanTime, total / scanTime / 1000.0, heapTime, total / heapTime / 1000.0, ok ? "ordered" : "FAILED");
+
+        if (ok == false) {
+            result = 1;
+        }
+
+        for (Source* source : sources) {
+            delete source;
+        }
+    }
+
+    for (uint32_t count : counts) {
+        for (int mode = 0; mode < 2; mode++) {
+            LiveResult live = LiveMerge(count, entries, (mode == 1));
+            bool ok = ((live.merged + live.dropped) == live.written);
+
+            printf("%4u sources  live, refill %-9s %9.2f ms  %8llu merged  %6llu dropped  %6llu late  %s\n", count,
+                (mode == 1 ? "per entry" : "when idle"), live.time, static_cast<unsigned long long>(live.merged),
+                static_cast<unsigned long long>(live.dropped), static_cast<unsigned long long>(live.late), ok ? "" : "FAILED");
+
+            if (ok == false) {
+                result = 1;
+            }
+        }
+    }
+
+    return (result);
+}
@@ -0,0 +1,221 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Receives the datagrams sent by the batched remote output of TraceControl and accounts for
+// every message: received, dropped by the sender (queue overflow) or lost on the way (missing
+// datagrams). Reports datagrams and messages that arrive out of order.
+//
+// Usage: TraceReceiver <port> [<expected messages>] [-v]
+// Stops after two seconds without traffic, or as soon as the expected number of messages is
+// accounted for. Exits with 1 if anything arrived out of order or, when nothing was lost on
+// the way, the count does not add up to the expected number.
+
+#include "TraceNetworkFormat.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+using namespace WPEFramework;
+
+namespace {
+
+const int IdleTimeout = 2000;
+
+struct Statistics {
+    Statistics()
+        : datagrams(0)
+        , messages(0)
+        , dropped(0)
+        , lost(0)
+        , reordered(0)
+        , unordered(0)
+        , malformed(0)
+    {
+    }
+
+    uint64_t datagrams;
+    uint64_t messages;
+    uint32_t dropped;
+    uint64_t lost;
+    uint64_t reordered;
+    uint64_t unordered;
+    uint64_t malformed;
+};
+
+bool Parse(const uint8_t data[], const size_t size, const bool verbose, uint64_t& lastTimestamp, Statistics& stats)
+{
+    uint16_t count;
+    size_t offset = TraceNetwork::HeaderSize;
+
+    ::memcpy(&count, &data[TraceNetwork::HeaderSize - sizeof(count)], sizeof(count));
+
+    for (uint16_t message = 0; message < count; message++) {
+        if ((offset + TraceNetwork::MessageHeaderSize) > size) {
+            return (false);
+        }
+
+        uint64_t timestamp;
+        uint32_t line;
+        uint16_t lengths[5];
+
+        ::memcpy(&timestamp, &data[offset], sizeof(timestamp));
+        ::memcpy(&line, &data[offset + 8], sizeof(line));
+        ::memcpy(lengths, &data[offset + 12], sizeof(lengths));
+        offset += TraceNetwork::MessageHeaderSize;
+
+        std::string fields[5];
+        for (uint8_t index = 0; index < 5; index++) {
+            if ((offset + lengths[index]) > size) {
+                return (false);
+            }
+            fields[index].assign(reinterpret_cast<const char*>(&data[offset]), lengths[index]);
+            offset += lengths[index];
+        }
+
+        if (timestamp < lastTimestamp) {
+            stats.unordered++;
+        } else {
+            lastTimestamp = timestamp;
+        }
+
+        if (verbose == true) {
+            ::printf("%llu [%s:%s] %s:%u %s: %s\n", static_cast<unsigned long long>(timestamp),
+                fields[1].c_str(), fields[2].c_str(), fields[0].c_str(), line, fields[3].c_str(), fields[4].c_str());
+        }
+
+        stats.messages++;
+    }
+
+    return (offset == size);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        ::fprintf(stderr, "Usage: %s <port> [<expected messages>] [-v]\n", argv[0]);
+        return (1);
+    }
+
+    uint16_t port = static_cast<uint16_t>(::atoi(argv[1]));
+    uint64_t expected = 0;
+    bool verbose = false;
+
+    for (int index = 2; index < argc; index++) {
+        if (::strcmp(argv[index], "-v") == 0) {
+            verbose = true;
+        } else {
+            expected = ::strtoull(argv[index], nullptr, 10);
+        }
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local;
+
+    ::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    int bufferSize = 4 * 1024 * 1024;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    if ((fd < 0) || (::bind(fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0)) {
+        ::perror("bind");
+        return (1);
+    }
+
+    Statistics stats;
+    bool first = true;
+    uint32_t nextSequence = 0;
+    uint64_t lastTimestamp = 0;
+    uint8_t buffer[64 * 1024];
+
+    while ((expected == 0) || ((stats.messages + stats.dropped) < expected)) {
+        struct pollfd entry = { fd, POLLIN, 0 };
+
+        if (::poll(&entry, 1, IdleTimeout) <= 0) {
+            break;
+        }
+
+        ssize_t size = ::recv(fd, buffer, sizeof(buffer), 0);
+
+        if ((size < TraceNetwork::HeaderSize) || (::memcmp(buffer, TraceNetwork::Magic, sizeof(TraceNetwork::Magic)) != 0)) {
+            stats.malformed++;
+            continue;
+        }
+
+        uint32_t sequence;
+        uint32_t dropped;
+
+        ::memcpy(&sequence, &buffer[4], sizeof(sequence));
+        ::memcpy(&dropped, &buffer[8], sizeof(dropped));
+
+        if (first == true) {
+            first = false;
+        } else if (static_cast<int32_t>(sequence - nextSequence) > 0) {
+            stats.lost += (sequence - nextSequence);
+        } else if (sequence != nextSequence) {
+            stats.reordered++;
+        }
+
+        if (static_cast<int32_t>(sequence - nextSequence) >= 0) {
+            nextSequence = sequence + 1;
+        }
+        if (dropped > stats.dropped) {
+            stats.dropped = dropped;
+        }
+
+        stats.datagrams++;
+
+        if (Parse(buffer, static_cast<size_t>(size), verbose, lastTimestamp, stats) == false) {
+            stats.malformed++;
+        }
+    }
+
+    ::close(fd);
+
+    ::printf("datagrams: %llu, lost datagrams: %llu, reordered datagrams: %llu, malformed: %llu\n",
+        static_cast<unsigned long long>(stats.datagrams), static_cast<unsigned long long>(stats.lost),
+        static_cast<unsigned long long>(stats.reordered), static_cast<unsigned long long>(stats.malformed));
+    ::printf("messages: %llu, dropped by sender: %u, out of order: %llu, avg per datagram: %.1f\n",
+        static_cast<unsigned long long>(stats.messages), stats.dropped, static_cast<unsigned long long>(stats.unordered),
+        (stats.datagrams > 0 ? static_cast<double>(stats.messages) / stats.datagrams : 0.0));
+
+    bool result = ((stats.reordered == 0) && (stats.unordered == 0) && (stats.malformed == 0));
+
+    if ((expected != 0) && (stats.lost == 0) && ((stats.messages + stats.dropped) != expected)) {
+        ::printf("expected %llu messages, accounted for %llu\n", static_cast<unsigned long long>(expected),
+            static_cast<unsigned long long>(stats.messages + stats.dropped));
+        result = false;
+    }
+
+    ::printf("%s\n", (result == true ? "PASS" : "FAIL"));
+
+    return (result == true ? 0 : 1);
+}
@@ -31,6 +31,7 @@
 #endif
 
 #include "utils.h"
+#include "executor.h"
 
 #include "frontpanel.h"
 
@@ -58,6 +59,8 @@
 #define PARAM_ERROR "error"
 
 #define DEVICE_INFO_SCRIPT "sh /lib/rdk/getDeviceDetails.sh read"
+#define SCRIPT_TIMEOUT_MS 10000
+#define DEVICE_PROPERTIES_CACHE_TTL_SEC 3600
 #define VERSION_FILE_NAME "/version.txt"
 #define CUSTOM_DATA_FILE "/lib/rdk/wh_api_5.conf"
 
@@ -244,26 +247,15 @@ namespace WPEFramework
          */
         void Warehouse::getDeviceInfo(JsonObject &params)
         {
-            char buf[256];
+            Utils::Exec::Result result = Utils::Exec::run({ "/bin/sh", "/lib/rdk/getDeviceDetails.sh", "read" }, SCRIPT_TIMEOUT_MS);
+            std::string& res = result.output;
 
-            FILE *p = popen(DEVICE_INFO_SCRIPT, "r");
-
-            if(!p)
-            {
-                LOGWARN("failed to run %s:%s", DEVICE_INFO_SCRIPT, strerror(errno));
-                return;
-            }
-
-            std::string res;
-            while(fgets(buf, sizeof(buf), p) != NULL)
-                res += buf;
-
-            int errCode = pclose(p);
-
-            if (0 != errCode)
+            if (0 != result.status)
             {
+                std::string error = result.timedOut ? "timed out" : ("exit status " + std::to_string(result.status));
+                LOGWARN("failed to run %s: %s", DEVICE_INFO_SCRIPT, error.c_str());
                 params[PARAM_SUCCESS] = false;
-                params[PARAM_ERROR] = (const char *)strerror(errno);
+                params[PARAM_ERROR] = error;
             }
 
             LOGINFO("'%s' returned: %s", DEVICE_INFO_SCRIPT, res.c_str());
@@ -552,16 +544,18 @@ namespace WPEFramework
                 // if script's variable in path is empty, then skip it
                 if (path.find('$') != std::string::npos)
                 {
+                    // name of the first variable: what follows '$' or '${' up to the next '$', '{', '}', '/' or '\\'
                     std::string variable;
-                    std::string script = "echo '" + path + "' | sed -r \"s/([^$]*)([$\\{]*)([^$\\{\\}\\/]*)(.*)/\\3/\"";
-                    variable = Utils::cRunScript(script.c_str());
+                    size_t begin = path.find_first_not_of("${", path.find('$'));
+                    if (begin != std::string::npos)
+                        variable = path.substr(begin, path.find_first_of("${}/\\", begin) - begin);
                     Utils::String::trim(variable);
 
                     std::string value;
                     if (variable.length() > 0)
                     {
-                        script = ". /etc/device.properties; echo \"$" + variable + "\"";
-                        value = Utils::cRunScript(script.c_str());
+                        std::string script = ". /etc/device.properties; echo \"$" + variable + "\"";
+                        value = Utils::Exec::cached(Utils::Exec::shell(script), DEVICE_PROPERTIES_CACHE_TTL_SEC, SCRIPT_TIMEOUT_MS);
                         Utils::String::trim(value);
                     }
 
@@ -618,7 +612,7 @@ namespace WPEFramework
                     }
 
                     script += " 2>/dev/null | head -n 10";
-                    std::string result = Utils::cRunScript(script.c_str());
+                    std::string result = Utils::Exec::run(Utils::Exec::shell(script), SCRIPT_TIMEOUT_MS).output;
                     Utils::String::trim(result);
 
                     totalPathsCounter++;
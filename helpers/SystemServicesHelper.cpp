@@ -26,6 +26,7 @@
 
 #include "utils.h"
 #include "SystemServicesHelper.h"
+#include "executor.h"
 
 /* Helper Functions */
 using namespace std;
@@ -165,24 +166,11 @@ namespace WPEFramework {
         string getModel()
         {
             const char * pipeName = "PATH=${PATH}:/sbin:/usr/sbin /lib/rdk/getDeviceDetails.sh read";
-            FILE* pipe = popen(pipeName, "r");
-            LOGWARN("%s: opened pipe for command '%s', with result %s : %s\n",
-                    __FUNCTION__ , pipeName, pipe ? "sucess" : "failure", strerror(errno));
-            if (!pipe) {
-                LOGERR("%s: SERVICEMANAGER_FILE_ERROR: Can't open pipe for command '%s' for read mode: %s\n"
-                        , __FUNCTION__, pipeName, strerror(errno));
-                return "ERROR";
-            }
-
-            char buffer[128] = {'\0'};
-            string result;
 
-            while (!feof(pipe)) {
-                if (fgets(buffer, 128, pipe) != NULL) {
-                    result += buffer;
-                }
-            }
-            pclose(pipe);
+            string result = Utils::Exec::cached(Utils::Exec::shell(pipeName),
+                    IDENTITY_SCRIPT_CACHE_TTL_SEC, IDENTITY_SCRIPT_TIMEOUT_MS);
+            LOGWARN("%s: ran command '%s', with result %s\n",
+                    __FUNCTION__ , pipeName, result.empty() ? "failure" : "sucess");
 
             string tri = caseInsensitive(result);
             string ret = tri.c_str();
@@ -58,6 +58,14 @@
 #define PREVIOUS_REBOOT_INFO2_ONE_CALL_FILE     "/tmp/previousRebootInfoOneCall"
 #define MILESTONES_LOG_FILE                     "/opt/logs/rdk_milestones.log"
 #define RECEIVER_STANDBY_PREFS                  "/tmp/retainConnection"
+
+/* Output of device identity scripts (MACs, model, partner/account id, PDRI version) is reused for
+ * this long instead of running the script again; a script still running after the timeout is killed. */
+#define IDENTITY_SCRIPT_CACHE_TTL_SEC           600
+#define IDENTITY_SCRIPT_TIMEOUT_MS              10000
+/* An identity missing its model or eSTB MAC is collected again after this delay, doubled after every
+ * further incomplete attempt up to IDENTITY_SCRIPT_CACHE_TTL_SEC. */
+#define IDENTITY_RETRY_MIN_SEC                  5
 #define TZ_REGEX                                "^[0-9a-zA-Z/-+_]*$"
 #define PREVIOUS_KEYPRESS_INFO_FILE             "/opt/persistent/previouskeypress.info"
 #define XCONF_OVERRIDE_FILE						"/opt/swupdate.conf"
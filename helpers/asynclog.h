@@ -0,0 +1,349 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/**
+ *  Backend of the LOGINFO/LOGWARN/LOGERR macros in utils.h.
+ *
+ *  A message is formatted on the calling thread into a slot of a ring owned by that thread and
+ *  published with a single release store; one drain thread per process collects the slots and
+ *  writes them to stderr in batches. The caller never takes a lock, never flushes and, except
+ *  for the first message after the drain thread went to sleep, never issues a syscall. When its
+ *  ring is full, or the message does not fit in a slot, the message is written synchronously
+ *  instead, so nothing is lost.
+ *
+ *  Errors always take the synchronous path, after flushing what is queued, so the last messages
+ *  before a crash or an abort() reach stderr.
+ *
+ *  Every plugin compiles this header into its own library. The drain is still shared: it is a
+ *  function-local static of an inline function with default visibility, which the toolchain makes
+ *  unique across the libraries of the process (STB_GNU_UNIQUE); the dynamic linker then keeps the
+ *  library that created it loaded. It is never destroyed, so a message logged during unload or
+ *  exit never reaches a dead drain. The types shared that way live in a versioned namespace, bump
+ *  it when their layout changes.
+ *
+ *  Each thread that logs gets one ring of SLOTS * sizeof(Slot), about 8 KB, on its first info or
+ *  warning message, whatever the number of libraries it logs from. It is freed after the thread
+ *  has exited; Thunder's worker threads live as long as the process, so count on 8 KB per thread.
+ *
+ *  Everything is header-only since most plugins include utils.h without building utils.cpp.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <syscall.h>
+#include <unistd.h>
+
+// Messages above this level are compiled out: 0 - errors, 1 - warnings, 2 - info
+#ifndef UTILS_LOG_LEVEL
+#define UTILS_LOG_LEVEL 2
+#endif
+
+namespace Utils
+{
+namespace Log
+{
+    enum Level
+    {
+        LEVEL_ERROR = 0,
+        LEVEL_WARN = 1,
+        LEVEL_INFO = 2
+    };
+
+    // Runtime threshold on top of UTILS_LOG_LEVEL, lowered with setLevel()
+    inline std::atomic<int>& threshold()
+    {
+        static std::atomic<int> value(UTILS_LOG_LEVEL);
+        return value;
+    }
+
+    inline void setLevel(Level level) { threshold().store(level, std::memory_order_relaxed); }
+
+    inline bool enabled(Level level) { return level <= threshold().load(std::memory_order_relaxed); }
+
+    inline int threadId()
+    {
+        static thread_local int tid = (int)syscall(SYS_gettid);
+        return tid;
+    }
+
+inline namespace v2
+{
+    // Single producer (the owning thread), single consumer (the drain thread). Slots fit a typical
+    // message with its location prefix; longer ones are written synchronously.
+    struct Ring
+    {
+        static const uint32_t SLOTS = 32;
+        static const uint32_t SLOT_SIZE = 252;
+
+        struct Slot
+        {
+            uint32_t length;
+            char text[SLOT_SIZE];
+        };
+
+        explicit Ring(int owner) : head(0), cachedTail(0), owner(owner), tail(0), users(1) {}
+
+        Slot slots[SLOTS];
+
+        // Producer and consumer indexes live on separate cache lines; the producer only re-reads
+        // tail when its cached copy says the ring is full
+        std::atomic<uint32_t> head;
+        uint32_t cachedTail;
+        int owner; // thread id
+        char padding[64];
+        std::atomic<uint32_t> tail;
+        std::atomic<uint32_t> users; // libraries of the owner using the ring, 0 once the thread exited
+    };
+
+    class Drain
+    {
+    public:
+        Drain() : _pending(false)
+        {
+            _thread = std::thread(&Drain::run, this);
+            _thread.detach();
+            std::atexit(&Drain::atExit);
+        }
+
+        // The ring of the calling thread. A thread logging from several libraries has one instance
+        // of its thread_local Producer per library, they share the ring.
+        Ring* attach()
+        {
+            int owner = threadId();
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (Ring* ring : _rings)
+            {
+                // users is only changed by the owner, i.e. the calling thread
+                if (ring->owner == owner && ring->users.load(std::memory_order_relaxed) > 0)
+                {
+                    ring->users.fetch_add(1, std::memory_order_relaxed);
+                    return ring;
+                }
+            }
+            Ring* ring = new Ring(owner);
+            _rings.push_back(ring);
+            return ring;
+        }
+
+        void wake()
+        {
+            // Only the first message after a drain takes the lock and notifies. Setting _pending under
+            // the lock means the drain thread can't miss it between checking and going to sleep.
+            if (!_pending.load())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _pending.store(true);
+                }
+                _signal.notify_one();
+            }
+        }
+
+        void flush()
+        {
+            std::lock_guard<std::mutex> lock(_flushLock);
+            size_t used = 0;
+
+            // Index based: attach() may grow _rings while a ring is being drained
+            for (size_t index = 0; ; )
+            {
+                Ring* ring = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (index >= _rings.size())
+                        break;
+                    ring = _rings[index];
+                }
+
+                // Read users first: once it is 0, everything the thread wrote is already visible
+                bool retired = 0 == ring->users.load(std::memory_order_acquire);
+                uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+                uint32_t head = ring->head.load(std::memory_order_acquire);
+
+                while (tail != head)
+                {
+                    const Ring::Slot& slot = ring->slots[tail % Ring::SLOTS];
+                    if (used + slot.length > sizeof(_batch))
+                    {
+                        output(_batch, used);
+                        used = 0;
+                    }
+                    memcpy(_batch + used, slot.text, slot.length);
+                    used += slot.length;
+                    ring->tail.store(++tail, std::memory_order_release);
+                }
+
+                if (retired)
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _rings.erase(_rings.begin() + index);
+                    delete ring;
+                }
+                else
+                {
+                    ++index;
+                }
+            }
+
+            if (used > 0)
+                output(_batch, used);
+        }
+
+    private:
+        Drain(const Drain&) = delete;
+        Drain& operator=(const Drain&) = delete;
+        ~Drain() = delete;
+
+        static void atExit();
+
+        static void output(const char* data, size_t size)
+        {
+            while (size > 0)
+            {
+                ssize_t written = ::write(STDERR_FILENO, data, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    break;
+                }
+                data += written;
+                size -= written;
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;)
+            {
+                // Sleeps for as long as nothing is logged
+                _signal.wait(lock, [this] { return _pending.load(); });
+                _pending.store(false);
+                lock.unlock();
+
+                // Pairs with the fence in write(): either this flush sees the new head of a ring, or
+                // its producer sees _pending cleared and wakes us up again
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                flush();
+                lock.lock();
+            }
+        }
+
+        std::mutex _mutex; // guards _rings
+        std::mutex _flushLock;
+        std::condition_variable _signal;
+        std::vector<Ring*> _rings;
+        std::thread _thread;
+        std::atomic<bool> _pending;
+        char _batch[16 * 1024];
+    };
+
+    __attribute__((visibility("default"))) inline Drain& drain()
+    {
+        static Drain* instance = new Drain();
+        return *instance;
+    }
+
+    inline void Drain::atExit()
+    {
+        drain().flush();
+    }
+
+    struct Producer
+    {
+        Producer() : ring(nullptr) {}
+        ~Producer()
+        {
+            if (ring)
+                ring->users.fetch_sub(1, std::memory_order_release);
+        }
+        Ring* ring;
+    };
+}
+
+    inline void writeSync(const char* format, va_list args)
+    {
+        vfprintf(stderr, format, args);
+        fflush(stderr);
+    }
+
+    inline void write(Level level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    inline void write(Level level, const char* format, ...)
+    {
+        static thread_local Producer producer;
+        va_list args;
+
+#ifndef UTILS_SYNC_LOGGING
+        Drain& instance = drain();
+        if (level == LEVEL_ERROR)
+        {
+            // Keep the error after the messages queued by any thread
+            instance.flush();
+        }
+        else
+        {
+            if (!producer.ring)
+                producer.ring = instance.attach();
+
+            Ring& ring = *producer.ring;
+            uint32_t head = ring.head.load(std::memory_order_relaxed);
+            if (head - ring.cachedTail >= Ring::SLOTS)
+                ring.cachedTail = ring.tail.load(std::memory_order_acquire);
+            if (head - ring.cachedTail < Ring::SLOTS)
+            {
+                Ring::Slot& slot = ring.slots[head % Ring::SLOTS];
+                va_start(args, format);
+                int length = vsnprintf(slot.text, Ring::SLOT_SIZE, format, args);
+                va_end(args);
+                if (length >= 0 && (uint32_t)length < Ring::SLOT_SIZE)
+                {
+                    slot.length = length;
+                    ring.head.store(head + 1, std::memory_order_release);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    instance.wake();
+                    return;
+                }
+            }
+
+            // Keep this message after the ones already queued by this thread
+            instance.flush();
+        }
+#else
+        (void)level;
+#endif
+
+        va_start(args, format);
+        writeSync(format, args);
+        va_end(args);
+    }
+}
+}
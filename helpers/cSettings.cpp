@@ -20,6 +20,10 @@
 
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "cSettings.h"
 #include "SystemServicesHelper.h"
 
@@ -28,8 +32,10 @@
  * @return  : nil.
  */
 cSettings::cSettings(std::string file)
+    : filename(file)
+    , dirty(false)
+    , stopFlusher(false)
 {
-    filename = file;
     readFromFile();
 }
 
@@ -39,11 +45,19 @@ cSettings::cSettings(std::string file)
  */
 cSettings::~cSettings()
 {
-    ;
+    {
+        std::lock_guard<std::mutex> lock(dataLock);
+        stopFlusher = true;
+    }
+    flusherSignal.notify_one();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    flush();
 }
 
 /***
- * @brief    : Initialise the jsonobject from a given conf file.
+ * @brief    : Initialise the key-value map from a given conf file.
  * @return  : <bool> False if file couldn't be accessed, else True.
  */
 bool cSettings::readFromFile()
@@ -55,11 +69,12 @@ bool cSettings::readFromFile()
     }
     fstream ifile(filename,ios::in);
     if (ifile) {
+        std::lock_guard<std::mutex> lock(dataLock);
         while (!ifile.eof()) {
             std::getline(ifile,content);
             size_t pos = content.find_last_of("=");
             if (std::string::npos != pos) {
-                data[(content.substr(0, pos).c_str())] = content.substr(pos+1,std::string::npos);
+                data[content.substr(0, pos)] = content.substr(pos+1,std::string::npos);
             }
             retStatus = true;
         }
@@ -70,34 +85,127 @@ bool cSettings::readFromFile()
 }
 
 /***
- * @brief    : Update new inserts into the json object onto file.
- * @return  : <bool> False if timer thread couldn't be started.
+ * @brief        : Take a snapshot of the values, write it onto a temporary file and rename it
+ *                 over the settings file, so a crash or power loss never leaves a partial file.
+ *                 fileLock is held from the snapshot to the rename: a snapshot taken earlier by
+ *                 another thread can't be written over a newer one, and a flush() that finds
+ *                 nothing dirty returns only once the write that cleared it is done.
+ * @param1[in]  : <bool> do nothing if there are no pending changes
+ * @return     : <bool> False if the file doesn't exist or couldn't be written.
  */
-bool cSettings::writeToFile()
+bool cSettings::writeSnapshot(bool onlyIfDirty)
 {
-    bool status = false;
-
-    if (Utils::fileExists(filename.c_str())) {
-        ofstream ofile;
-        ofile.open(filename.c_str(),ios::out);
-        if (ofile) {
-            JsonObject::Iterator iterator = data.Variants();
-            while (iterator.Next()) {
-                if (!data[iterator.Label()].String().empty()) {
-                    ofile << iterator.Label() << "=" << data[iterator.Label()].String() << endl;
-                } else {
-                    continue;
-                }
+    std::lock_guard<std::mutex> lock(fileLock);
+
+    std::unordered_map<std::string, JsonValue> snapshot;
+    {
+        std::lock_guard<std::mutex> dataGuard(dataLock);
+        if (onlyIfDirty && !dirty) {
+            return true;
+        }
+        snapshot = data;
+        dirty = false;
+    }
+
+    struct stat fileStat;
+    if (0 != stat(filename.c_str(), &fileStat)) {
+        return false;
+    }
+
+    std::string tempname = filename + ".tmp";
+    FILE *fp = fopen(tempname.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+
+    bool status = true;
+    for (auto it = snapshot.begin(); it != snapshot.end(); ++it) {
+        std::string value = it->second.String();
+        if (!value.empty()) {
+            if (fprintf(fp, "%s=%s\n", it->first.c_str(), value.c_str()) < 0) {
+                status = false;
+                break;
             }
-            status = true;
-            ofile.close();
-        } else {
-            status = false;
         }
     }
+
+    if (status && (0 != fflush(fp) || 0 != fchmod(fileno(fp), fileStat.st_mode & 07777) || 0 != fsync(fileno(fp)))) {
+        status = false;
+    }
+    if (0 != fclose(fp)) {
+        status = false;
+    }
+
+    if (status && 0 != rename(tempname.c_str(), filename.c_str())) {
+        status = false;
+    }
+    if (!status) {
+        unlink(tempname.c_str());
+    }
     return status;
 }
 
+/***
+ * @brief    : Update the file with all values now.
+ * @return  : <bool> False if the file doesn't exist or couldn't be written.
+ */
+bool cSettings::writeToFile()
+{
+    return writeSnapshot(false);
+}
+
+/***
+ * @brief    : Write pending changes now.
+ * @return  : <bool> False if the file couldn't be written.
+ */
+bool cSettings::flush()
+{
+    return writeSnapshot(true);
+}
+
+/***
+ * @brief    : Flusher thread. Writes the file once per CSETTINGS_FLUSH_DELAY_MS after the
+ *             first pending change, so bursts of updates cost a single write.
+ * @return  : nil.
+ */
+void cSettings::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(dataLock);
+    while (!stopFlusher) {
+        flusherSignal.wait(lock, [this] { return dirty || stopFlusher; });
+        if (stopFlusher) {
+            break;
+        }
+        flusherSignal.wait_for(lock, std::chrono::milliseconds(CSETTINGS_FLUSH_DELAY_MS), [this] { return stopFlusher; });
+        if (stopFlusher) {
+            break;
+        }
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+/***
+ * @brief    : Mark the values as modified and start the flusher thread on first use.
+ *             Must be called with dataLock held.
+ * @return  : <bool> False if the file doesn't exist, as writeToFile() would.
+ */
+bool cSettings::scheduleWrite()
+{
+    if (!Utils::fileExists(filename.c_str())) {
+        return false;
+    }
+    if (!dirty) {
+        dirty = true;
+        flusherSignal.notify_one();
+    }
+    if (!flusher.joinable() && !stopFlusher) {
+        flusher = std::thread(&cSettings::flushLoop, this);
+    }
+    return true;
+}
+
 /***
  * @brief        : Get value of given key.
  * @param1[in]  : <string> key
@@ -105,7 +213,9 @@ bool cSettings::writeToFile()
  */
 JsonValue cSettings::getValue(std::string key)
 {
-    return data.Get(key.c_str());
+    std::lock_guard<std::mutex> lock(dataLock);
+    auto it = data.find(key);
+    return (it != data.end()) ? it->second : JsonValue();
 }
 
 /***
@@ -116,8 +226,9 @@ JsonValue cSettings::getValue(std::string key)
  */
 bool cSettings::setValue(std::string key,std::string value)
 {
-    data[key.c_str()] = value;
-    return writeToFile();
+    std::lock_guard<std::mutex> lock(dataLock);
+    data[key] = value;
+    return scheduleWrite();
 }
 
 /***
@@ -128,8 +239,9 @@ bool cSettings::setValue(std::string key,std::string value)
  */
 bool cSettings::setValue(std::string key,int value)
 {
-    data[key.c_str()] = value;
-    return writeToFile();
+    std::lock_guard<std::mutex> lock(dataLock);
+    data[key] = value;
+    return scheduleWrite();
 }
 
 /***
@@ -140,8 +252,9 @@ bool cSettings::setValue(std::string key,int value)
  */
 bool cSettings::setValue(std::string key,bool value)
 {
-    data[key.c_str()] = value;
-    return writeToFile();
+    std::lock_guard<std::mutex> lock(dataLock);
+    data[key] = value;
+    return scheduleWrite();
 }
 
 /***
@@ -151,17 +264,9 @@ bool cSettings::setValue(std::string key,bool value)
  */
 bool cSettings::contains(std::string key)
 {
-    bool resp = false;
-    if (data.HasLabel(key.c_str())) {
-        if (data[key.c_str()].String().empty()) {
-            resp = false;
-        } else {
-            resp = true;
-        }
-    } else {
-        resp = false;
-    }
-    return resp;
+    std::lock_guard<std::mutex> lock(dataLock);
+    auto it = data.find(key);
+    return (it != data.end()) && !it->second.String().empty();
 }
 
 /***
@@ -171,24 +276,7 @@ bool cSettings::contains(std::string key)
  */
 bool cSettings::remove(std::string key)
 {
-    bool status = false;
-    /*
-     * Noticed that there is an error with the Remove function.
-     * work around is to assign a null value to the key and handle it
-     * accordingly.
-     */
-    data[key.c_str()] = "";
-    data.Remove(key.c_str());
-    if (!contains(key)) {
-        if (writeToFile()) {
-            status = true;
-        } else {
-            status = false;
-        }
-    }
-    else {
-        status = false;
-    }
-    return status;
+    std::lock_guard<std::mutex> lock(dataLock);
+    data.erase(key);
+    return scheduleWrite();
 }
-
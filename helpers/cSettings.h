@@ -19,13 +19,31 @@
 
 #include <string>
 #include <stdlib.h>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <plugins/plugins.h>
 
 using namespace std;
 
+/* Writes are coalesced: the file is rewritten once, this long after the first change */
+#define CSETTINGS_FLUSH_DELAY_MS 1000
+
 class cSettings {
     std::string filename;
-    JsonObject data;
+    std::unordered_map<std::string, JsonValue> data;
+    std::mutex dataLock;     // guards data, dirty and stopFlusher
+    std::mutex fileLock;     // serializes writes of the file, taken before dataLock
+    std::condition_variable flusherSignal;
+    std::thread flusher;
+    bool dirty;
+    bool stopFlusher;
+
+    bool scheduleWrite();
+    void flushLoop();
+    bool writeSnapshot(bool onlyIfDirty);
+
     public:
     /***
      * @brief    : Constructor.
@@ -34,7 +52,7 @@ class cSettings {
     cSettings(std::string file);
 
     /***
-     * @brief    : Destructor.
+     * @brief    : Destructor. Writes pending changes.
      * @return   : nil.
      */
     ~cSettings();
@@ -47,7 +65,7 @@ class cSettings {
     JsonValue getValue(std::string key);
 
     /***
-     * @brief        : Set value of given key.
+     * @brief        : Set value of given key. The file is updated asynchronously.
      * @param1[in]   : <string> key
      * @param2[in]   : <string> value
      * @return       : <bool> True if setvalue successfull, else False
@@ -55,7 +73,7 @@ class cSettings {
     bool setValue(std::string key,std::string value);
 
     /***
-     * @brief        : Set value of given key.
+     * @brief        : Set value of given key. The file is updated asynchronously.
      * @param1[in]   : <string> key
      * @param2[in]   : <int> value
      * @return       : <bool> True if setvalue successfull, else False
@@ -63,7 +81,7 @@ class cSettings {
     bool setValue(std::string key,int value);
 
     /***
-     * @brief        : Set value of given key.
+     * @brief        : Set value of given key. The file is updated asynchronously.
      * @param1[in]   : <string> key
      * @param2[in]   : <bool> value
      * @return       : <bool> True if setvalue successfull, else False
@@ -78,18 +96,24 @@ class cSettings {
     bool contains(std::string key);
 
     /***
-     * @brief        : Remove a particular key-value pair.
+     * @brief        : Remove a particular key-value pair. The file is updated asynchronously.
      * @param1[in]   : <string> key
      * @return       : <bool> True if key is key-value pair removed, else False
      */
     bool remove(std::string key);
 
     /***
-     * @brief    : Update new inserts into the json object onto file.
-     * @return   : <bool> False if timer thread couldn't be started.
+     * @brief    : Write all values onto file now, through a temporary file renamed over it.
+     * @return   : <bool> False if the file doesn't exist or couldn't be written.
      */
     bool writeToFile();
 
+    /***
+     * @brief    : Write pending changes now instead of after CSETTINGS_FLUSH_DELAY_MS.
+     * @return   : <bool> False if the file couldn't be written.
+     */
+    bool flush();
+
     /***
      * @brief    : Initialise the jsonobject from a given conf file.
      * @return   : <bool> False if file couldn't be accessed, else True.
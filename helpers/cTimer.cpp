@@ -24,9 +24,10 @@
  * @return   : nil.
  */
 cTimer::cTimer()
+    : handle(0)
 {
-    clear = false;
     interval = 0;
+    callBack_function = NULL;
 }
 
 /***
@@ -35,38 +36,31 @@ cTimer::cTimer()
  */
 cTimer::~cTimer()
 {
-    this->clear = true;
+    stop();
 }
 
 /***
- * @brief : start timer thread.
- * @return   : <bool> False if timer thread couldn't be started.
+ * @brief : start the timer on the shared timer wheel, restarting it if it is already running.
+ * @return   : <bool> False if the timer couldn't be started.
  */
 bool cTimer::start()
 {
-    if (interval <= 0 && callBack_function == NULL) {
+    if (interval <= 0 || callBack_function == NULL) {
         return false;
     }
-    this->clear = false;
-    std::thread timerThread([=]() {
-            while (true) {
-            if (this->clear) return;
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
-            if (this->clear) return;
-            this->callBack_function();
-            }
-            });
-    timerThread.detach();
-    return true;
+    stop();
+    Utils::TimerWheel::Handle newHandle = Utils::TimerWheel::schedule(interval, interval, callBack_function);
+    Utils::TimerWheel::cancel(handle.exchange(newHandle));
+    return (0 != newHandle);
 }
 
 /***
- * @brief : stop timer thread.
+ * @brief : stop the timer.
  * @return   : nil
  */
 void cTimer::stop()
 {
-    this->clear = true;
+    Utils::TimerWheel::cancel(handle.exchange(0));
 }
 
 /***
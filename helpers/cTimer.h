@@ -19,12 +19,14 @@
 
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include "timerwheel.h"
 
 using namespace std;
 
 class cTimer{
     private:
-        bool clear;
+        std::atomic<Utils::TimerWheel::Handle> handle;
         int interval;
         void (*callBack_function)();
     public:
@@ -41,13 +43,13 @@ class cTimer{
         ~cTimer();
 
         /***
-         * @brief    : start timer thread.
-         * @return   : <bool> False if timer thread couldn't be started.
+         * @brief    : start the timer, restarting it if it is already running.
+         * @return   : <bool> False if the timer couldn't be started.
          */
         bool start();
 
         /***
-         * @brief   : stop timer thread.
+         * @brief   : stop the timer.
          * @return   : nil
          */
         void stop();
@@ -0,0 +1,282 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "executor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "utils.h"
+
+extern char **environ;
+
+using namespace WPEFramework;
+
+namespace
+{
+    struct Child
+    {
+        pid_t pid;
+        int fd;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct CacheEntry
+    {
+        std::string output;
+        Clock::time_point expires;
+    };
+
+    std::mutex cacheMutex;
+    std::map<std::string, CacheEntry> cache;
+
+    std::string cacheKey(const Utils::Exec::Command& command)
+    {
+        std::string key;
+        for (const auto& arg : command)
+        {
+            key += arg;
+            key += '\0';
+        }
+        return key;
+    }
+
+    bool spawn(const Utils::Exec::Command& command, Child& child)
+    {
+        if (command.empty())
+            return false;
+
+        int fds[2];
+        if (0 != pipe2(fds, O_CLOEXEC))
+        {
+            LOGERR("pipe2 failed: %s", strerror(errno));
+            return false;
+        }
+
+        std::vector<char*> argv;
+        for (const auto& arg : command)
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+        // Threads of the host may block or ignore signals; the command starts with the defaults
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t mask;
+        sigemptyset(&mask);
+        posix_spawnattr_setsigmask(&attr, &mask);
+        sigset_t defaults;
+        sigfillset(&defaults);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+        int err = posix_spawn(&child.pid, argv[0], &actions, &attr, argv.data(), environ);
+
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+
+        if (0 != err)
+        {
+            LOGERR("failed to start '%s': %s", argv[0], strerror(err));
+            close(fds[0]);
+            return false;
+        }
+
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        child.fd = fds[0];
+        return true;
+    }
+
+    int remainingMs(const Clock::time_point& deadline)
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        return left > 0 ? (int)left : 0;
+    }
+}
+
+Utils::Exec::Command Utils::Exec::shell(const std::string& script)
+{
+    return Command { "/bin/sh", "-c", script };
+}
+
+Utils::Exec::Result Utils::Exec::run(const Command& command, unsigned int timeoutMs)
+{
+    return runAll(std::vector<Command>(1, command), timeoutMs)[0];
+}
+
+std::vector<Utils::Exec::Result> Utils::Exec::runAll(const std::vector<Command>& commands, unsigned int timeoutMs)
+{
+    std::vector<Result> results(commands.size());
+    std::vector<Child> children(commands.size(), Child { -1, -1 });
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        if (!spawn(commands[i], children[i]))
+            children[i].pid = -1;
+    }
+
+    // Collect stdout of all commands until every pipe is closed or the time is up
+    char buffer[4096];
+    for (;;)
+    {
+        std::vector<struct pollfd> fds;
+        std::vector<size_t> owners;
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            if (children[i].fd >= 0)
+            {
+                fds.push_back(pollfd { children[i].fd, POLLIN, 0 });
+                owners.push_back(i);
+            }
+        }
+        if (fds.empty())
+            break;
+
+        int wait = timeoutMs ? remainingMs(deadline) : -1;
+        if (timeoutMs && 0 == wait)
+            break;
+
+        int ready = poll(fds.data(), fds.size(), wait);
+        if (ready < 0 && EINTR != errno)
+        {
+            LOGERR("poll failed: %s", strerror(errno));
+            break;
+        }
+
+        for (size_t n = 0; ready > 0 && n < fds.size(); n++)
+        {
+            if (0 == fds[n].revents)
+                continue;
+
+            Child& child = children[owners[n]];
+            ssize_t size;
+            while ((size = read(child.fd, buffer, sizeof(buffer))) > 0)
+                results[owners[n]].output.append(buffer, size);
+
+            if (0 == size || (size < 0 && EAGAIN != errno && EINTR != errno))
+            {
+                close(child.fd);
+                child.fd = -1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        Child& child = children[i];
+        if (child.fd >= 0)
+        {
+            close(child.fd);
+            child.fd = -1;
+        }
+        if (child.pid < 0)
+            continue;
+
+        // The pipe may close before the command exits, so the timeout applies to the exit as well
+        int status = 0;
+        pid_t done = 0;
+        while (0 == (done = waitpid(child.pid, &status, timeoutMs ? WNOHANG : 0)))
+        {
+            if (0 == remainingMs(deadline))
+            {
+                LOGWARN("'%s' timed out after %u ms", commands[i][0].c_str(), timeoutMs);
+                kill(child.pid, SIGKILL);
+                results[i].timedOut = true;
+                done = waitpid(child.pid, &status, 0);
+                break;
+            }
+            usleep(1000);
+        }
+
+        if (done == child.pid && WIFEXITED(status) && !results[i].timedOut)
+            results[i].status = WEXITSTATUS(status);
+    }
+
+    return results;
+}
+
+std::string Utils::Exec::cached(const Command& command, unsigned int ttlSeconds, unsigned int timeoutMs)
+{
+    return cachedAll(std::vector<Command>(1, command), ttlSeconds, timeoutMs)[0];
+}
+
+std::vector<std::string> Utils::Exec::cachedAll(const std::vector<Command>& commands, unsigned int ttlSeconds, unsigned int timeoutMs)
+{
+    std::vector<std::string> outputs(commands.size());
+    std::vector<Command> missing;
+    std::vector<size_t> missingIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            auto it = cache.find(cacheKey(commands[i]));
+            if (it != cache.end() && it->second.expires > now)
+            {
+                outputs[i] = it->second.output;
+            }
+            else
+            {
+                missing.push_back(commands[i]);
+                missingIndex.push_back(i);
+            }
+        }
+    }
+
+    if (missing.empty())
+        return outputs;
+
+    std::vector<Result> results = runAll(missing, timeoutMs);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    Clock::time_point expires = Clock::now() + std::chrono::seconds(ttlSeconds);
+    for (size_t n = 0; n < missing.size(); n++)
+    {
+        outputs[missingIndex[n]] = results[n].output;
+        if (0 == results[n].status && !results[n].output.empty())
+            cache[cacheKey(missing[n])] = CacheEntry { results[n].output, expires };
+    }
+
+    return outputs;
+}
+
+void Utils::Exec::clearCache()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+}
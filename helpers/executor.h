@@ -0,0 +1,93 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * In-process replacement for popen()/Utils::cRunScript().
+     *
+     * Commands are started with posix_spawn() from an argv, without an intermediate shell, and
+     * their stdout is collected through a pipe. Several commands run concurrently and are waited
+     * for together, a timeout kills whatever is still running, and the output of identity
+     * scripts (MAC addresses, partner id, ...) can be memoized for a while.
+     */
+    namespace Exec
+    {
+        typedef std::vector<std::string> Command;
+
+        struct Result
+        {
+            Result() : status(-1), timedOut(false) {}
+
+            int status;        // exit code, -1 if the command could not be started or was killed
+            bool timedOut;
+            std::string output; // stdout
+        };
+
+        /***
+         * @brief	: Wraps a shell script for the cases that really need one (pipes, sourcing, redirections)
+         * @param1[in]	: script to be passed to /bin/sh -c
+         * @return		: command
+         */
+        Command shell(const std::string& script);
+
+        /***
+         * @brief	: Runs a command and waits for it
+         * @param1[in]	: argv, argv[0] must be an absolute path
+         * @param2[in]	: timeoutMs time after which the command is killed, 0 for no limit
+         * @return		: result of the command
+         */
+        Result run(const Command& command, unsigned int timeoutMs = 0);
+
+        /***
+         * @brief	: Runs all commands at the same time and waits for all of them
+         * @param1[in]	: commands
+         * @param2[in]	: timeoutMs shared by all commands, 0 for no limit
+         * @return		: results, in the order of the commands
+         */
+        std::vector<Result> runAll(const std::vector<Command>& commands, unsigned int timeoutMs = 0);
+
+        /***
+         * @brief	: Returns the stdout of a command, running it only if no earlier output is younger than ttlSeconds.
+         *            Only a successful run with non-empty output is remembered, so values that are not
+         *            available yet are queried again on the next call.
+         * @param1[in]	: command
+         * @param2[in]	: ttlSeconds how long the output stays valid
+         * @param3[in]	: timeoutMs for the command when it has to run
+         * @return		: stdout of the command, empty on failure
+         */
+        std::string cached(const Command& command, unsigned int ttlSeconds, unsigned int timeoutMs = 0);
+
+        /***
+         * @brief	: cached() for several commands; the ones not in the cache run concurrently
+         * @return		: stdout of the commands, in the order of the commands
+         */
+        std::vector<std::string> cachedAll(const std::vector<Command>& commands, unsigned int ttlSeconds, unsigned int timeoutMs = 0);
+
+        /***
+         * @brief	: Forgets all memoized output, e.g. after the device has been re-activated
+         */
+        void clearCache();
+    }
+}
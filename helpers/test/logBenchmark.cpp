@@ -0,0 +1,160 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+// Measures what a LOGINFO/LOGINFOMETHOD call costs the calling thread with the asynchronous backend
+// of utils.h, against the synchronous fprintf/fflush the macros used to expand to.
+//
+// Usage: logBenchmark [-n <calls per thread>] [-t <threads>] [-b <burst>] 2>/dev/null
+//   -n  number of calls per thread and mode (default 20000)
+//   -t  number of logging threads (default 4)
+//   -b  calls per burst; threads pause 1 ms between bursts, like JSON-RPC handlers (default 16)
+// Results go to stdout, messages to stderr, so redirect stderr to the device under test.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MODULE_NAME
+#define MODULE_NAME LogBenchmark
+#endif
+
+#include <plugins/plugins.h>
+#include <tracing/tracing.h>
+
+#include "utils.h"
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+#define LOGINFO_SYNC(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
+#define LOGINFOMETHOD_SYNC() { std::string json; parameters.ToString(json); LOGINFO_SYNC( "params=%s", json.c_str() );  }
+
+enum Mode { SYNC, ASYNC, DISABLED, METHOD_SYNC, METHOD_ASYNC, METHOD_DISABLED };
+
+static const char *modeNames[] = { "sync", "async", "disabled", "method-sync", "method-async", "method-disabled" };
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Cpu time of the calling thread only, so work done by the drain thread is not counted even when
+// it preempts the caller on a single core
+static double threadTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Returns the cpu nanoseconds the calling thread spent inside the logging calls
+static double worker(Mode mode, unsigned int calls, unsigned int burst)
+{
+    JsonObject parameters;
+    parameters["callsign"] = "org.rdk.System";
+    parameters["param"] = "getDeviceInfo";
+    parameters["value"] = 42;
+
+    double spent = 0;
+    for (unsigned int i = 0; i < calls; )
+    {
+        double start = threadTime();
+        for (unsigned int b = 0; b < burst && i < calls; b++, i++)
+        {
+            switch (mode)
+            {
+                case SYNC: LOGINFO_SYNC("call %u of %u, value %d", i, calls, 42); break;
+                case ASYNC:
+                case DISABLED: LOGINFO("call %u of %u, value %d", i, calls, 42); break;
+                case METHOD_SYNC: LOGINFOMETHOD_SYNC(); break;
+                case METHOD_ASYNC:
+                case METHOD_DISABLED: LOGINFOMETHOD(); break;
+            }
+        }
+        spent += threadTime() - start;
+        usleep(1000);
+    }
+    return spent;
+}
+
+static void run(Mode mode, unsigned int calls, unsigned int threads, unsigned int burst)
+{
+    bool disabled = (mode == DISABLED || mode == METHOD_DISABLED);
+    Utils::Log::setLevel(disabled ? Utils::Log::LEVEL_WARN : Utils::Log::LEVEL_INFO);
+
+    std::vector<std::thread> pool;
+    std::vector<double> spent(threads, 0);
+
+    for (unsigned int t = 0; t < threads; t++)
+        pool.push_back(std::thread([&, t] { spent[t] = worker(mode, calls, burst); }));
+    for (auto &thread : pool)
+        thread.join();
+
+    double flushStart = now();
+    Utils::Log::drain().flush();
+    double flush = now() - flushStart;
+
+    double total = 0;
+    for (double s : spent)
+        total += s;
+
+    printf("%-16s %8.0f ns/call cpu  (%u threads x %u calls, final flush %.2f ms)\n",
+        modeNames[mode], total / (threads * (double)calls), threads, calls, flush / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int calls = 20000;
+    unsigned int threads = 4;
+    unsigned int burst = 16;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': calls = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 'b': burst = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n <calls>] [-t <threads>] [-b <burst>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (0 == calls)
+        calls = 1;
+    if (0 == threads)
+        threads = 1;
+    if (0 == burst)
+        burst = 1;
+
+    for (int mode = SYNC; mode <= METHOD_DISABLED; mode++)
+        run((Mode)mode, calls, threads, burst);
+
+    return 0;
+}
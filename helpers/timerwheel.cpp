@@ -0,0 +1,374 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "timerwheel.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const unsigned int TICK_MS = 10;
+    const unsigned int LEVELS = 4;
+    const unsigned int SLOT_BITS = 6;
+    const unsigned int SLOTS = 1 << SLOT_BITS;
+    const uint32_t NIL = 0xffffffff;
+    const uint64_t NEVER = UINT64_MAX;
+
+    struct Entry
+    {
+        std::function<void()> callback;
+        uint64_t expires;    // tick
+        uint64_t period;     // ticks, 0 for single shot
+        uint32_t generation; // incremented when the entry is released, invalidates old handles
+        uint32_t slot;       // level * SLOTS + index, NIL when not linked
+        uint32_t prev;
+        uint32_t next;
+        bool running;
+        bool cancelled;
+    };
+
+    class Wheel
+    {
+    public:
+        Wheel()
+            : _start(Clock::now())
+            , _current(0)
+            , _wakeTick(NEVER)
+            , _processing(false)
+            , _stop(false)
+        {
+            for (unsigned int i = 0; i < LEVELS * SLOTS; i++)
+                _heads[i] = NIL;
+            for (unsigned int level = 0; level < LEVELS; level++)
+                _occupied[level] = 0;
+            alive().store(true);
+        }
+
+        ~Wheel()
+        {
+            alive().store(false);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _signal.notify_one();
+            if (_thread.joinable())
+                _thread.join();
+        }
+
+        // A static cTimer or TpTimer of the plugin may be stopped after the wheel has been destroyed at
+        // library unload; schedule() and cancel() check this so they do nothing instead of locking a
+        // destroyed mutex
+        static std::atomic<bool>& alive()
+        {
+            static std::atomic<bool> value(false);
+            return value;
+        }
+
+        Utils::TimerWheel::Handle schedule(unsigned int delayMs, unsigned int periodMs, std::function<void()>&& callback)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stop)
+                return 0;
+
+            if (!_thread.joinable())
+                _thread = std::thread(&Wheel::run, this);
+
+            // Nothing is due before the next event, so the wheel can catch up with the clock first:
+            // timers are then placed relative to now instead of the last processed tick
+            uint64_t now = nowTick();
+            if (!_processing && now > _current)
+                _current = std::min(now, nextTick());
+
+            uint32_t index;
+            if (!_free.empty())
+            {
+                index = _free.back();
+                _free.pop_back();
+            }
+            else
+            {
+                index = _entries.size();
+                _entries.push_back(Entry());
+                _entries.back().generation = 1;
+            }
+
+            Entry& entry = _entries[index];
+            entry.callback = std::move(callback);
+            entry.expires = expiryTick(delayMs);
+            entry.period = (periodMs + TICK_MS - 1) / TICK_MS;
+            if (periodMs > 0 && 0 == entry.period)
+                entry.period = 1;
+            entry.running = false;
+            entry.cancelled = false;
+            link(index);
+
+            // Only wake the thread if it sleeps past the new timer
+            if (!_processing && entry.expires < _wakeTick)
+                _signal.notify_one();
+
+            return ((uint64_t)entry.generation << 32) | (index + 1);
+        }
+
+        bool cancel(Utils::TimerWheel::Handle handle, bool wait)
+        {
+            uint32_t index = (uint32_t)(handle & 0xffffffff) - 1;
+            uint32_t generation = (uint32_t)(handle >> 32);
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (0 == handle || index >= _entries.size() || _entries[index].generation != generation)
+                return false;
+
+            Entry& entry = _entries[index];
+            if (entry.running)
+            {
+                // Released by the timer thread once the call returns
+                entry.cancelled = true;
+                if (wait && std::this_thread::get_id() != _thread.get_id())
+                    _done.wait(lock, [&] { return entry.generation != generation || !entry.running; });
+                return true;
+            }
+
+            unlink(index);
+            release(index);
+            return true;
+        }
+
+    private:
+        Wheel(const Wheel&) = delete;
+        Wheel& operator=(const Wheel&) = delete;
+
+        uint64_t nowTick() const
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _start).count() / TICK_MS;
+        }
+
+        uint64_t expiryTick(unsigned int delayMs) const
+        {
+            uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - _start).count() + delayMs * 1000ull;
+            return (us + TICK_MS * 1000 - 1) / (TICK_MS * 1000);
+        }
+
+        void link(uint32_t index)
+        {
+            Entry& entry = _entries[index];
+            uint64_t expires = std::max(entry.expires, _current);
+            uint64_t delta = expires - _current;
+
+            unsigned int level = 0;
+            while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1))))
+                level++;
+
+            // Beyond the range of the wheel: park in the farthest slot, it is placed again when that slot cascades
+            if (delta >= (1ull << (SLOT_BITS * LEVELS)))
+                expires = _current + (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+            unsigned int slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+            uint32_t& head = _heads[level * SLOTS + slot];
+
+            entry.slot = level * SLOTS + slot;
+            entry.prev = NIL;
+            entry.next = head;
+            if (NIL != head)
+                _entries[head].prev = index;
+            head = index;
+            _occupied[level] |= 1ull << slot;
+        }
+
+        void unlink(uint32_t index)
+        {
+            Entry& entry = _entries[index];
+            if (NIL == entry.slot)
+                return;
+
+            if (NIL != entry.prev)
+                _entries[entry.prev].next = entry.next;
+            else
+                _heads[entry.slot] = entry.next;
+            if (NIL != entry.next)
+                _entries[entry.next].prev = entry.prev;
+
+            if (NIL == _heads[entry.slot])
+                _occupied[entry.slot / SLOTS] &= ~(1ull << (entry.slot % SLOTS));
+            entry.slot = NIL;
+        }
+
+        void release(uint32_t index)
+        {
+            Entry& entry = _entries[index];
+            entry.callback = nullptr;
+            entry.generation++;
+            _free.push_back(index);
+        }
+
+        // First tick, starting at _current, that fires a timer or cascades a slot of an upper level
+        uint64_t nextTick() const
+        {
+            uint64_t best = NEVER;
+            for (unsigned int level = 0; level < LEVELS; level++)
+            {
+                if (0 == _occupied[level])
+                    continue;
+
+                unsigned int shift = SLOT_BITS * level;
+                uint64_t block = _current >> shift;
+                unsigned int position = block & (SLOTS - 1);
+                uint64_t rotated = position ? (_occupied[level] >> position) | (_occupied[level] << (SLOTS - position)) : _occupied[level];
+
+                // The slot of the current position is due now only at the start of its block,
+                // later on it holds timers for the next rotation
+                bool blockStart = 0 == (_current & ((1ull << shift) - 1));
+                unsigned int distance;
+                if (blockStart && (rotated & 1))
+                    distance = 0;
+                else if (rotated & ~1ull)
+                    distance = __builtin_ctzll(rotated & ~1ull);
+                else
+                    distance = SLOTS;
+
+                best = std::min(best, (block + distance) << shift);
+            }
+            return best;
+        }
+
+        void cascade(unsigned int level, unsigned int slot)
+        {
+            // Detach the list first: an entry may land in the same slot again
+            uint32_t index = _heads[level * SLOTS + slot];
+            _heads[level * SLOTS + slot] = NIL;
+            _occupied[level] &= ~(1ull << slot);
+
+            while (NIL != index)
+            {
+                uint32_t next = _entries[index].next;
+                link(index);
+                index = next;
+            }
+        }
+
+        void process(std::unique_lock<std::mutex>& lock)
+        {
+            uint64_t tick = _current;
+
+            for (unsigned int level = LEVELS - 1; level > 0; level--)
+            {
+                unsigned int shift = SLOT_BITS * level;
+                if (0 == (tick & ((1ull << shift) - 1)))
+                    cascade(level, (tick >> shift) & (SLOTS - 1));
+            }
+
+            uint32_t& head = _heads[tick & (SLOTS - 1)];
+            while (NIL != head)
+            {
+                uint32_t index = head;
+                unlink(index);
+
+                Entry& entry = _entries[index];
+                entry.running = true;
+                lock.unlock();
+                entry.callback();
+                lock.lock();
+                entry.running = false;
+
+                if (entry.cancelled || 0 == entry.period)
+                {
+                    release(index);
+                }
+                else
+                {
+                    entry.expires = std::max(nowTick(), tick) + entry.period;
+                    link(index);
+                }
+                _done.notify_all();
+            }
+
+            _current = tick + 1;
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stop)
+            {
+                uint64_t now = nowTick();
+                uint64_t next = nextTick();
+
+                if (next <= now)
+                {
+                    _current = next;
+                    _processing = true;
+                    process(lock);
+                    _processing = false;
+                    continue;
+                }
+
+                _current = std::max(_current, now);
+                _wakeTick = next;
+                if (NEVER == next)
+                    _signal.wait(lock);
+                else
+                    _signal.wait_until(lock, _start + std::chrono::milliseconds(next * TICK_MS));
+                _wakeTick = NEVER;
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _signal; // wakes the timer thread
+        std::condition_variable _done;   // a callback returned
+        std::deque<Entry> _entries;      // deque: entries stay in place while a callback runs unlocked
+        std::vector<uint32_t> _free;
+        uint32_t _heads[LEVELS * SLOTS];
+        uint64_t _occupied[LEVELS];      // one bit per non-empty slot
+        Clock::time_point _start;
+        uint64_t _current;               // next tick to process
+        uint64_t _wakeTick;              // tick the thread sleeps until
+        bool _processing;
+        bool _stop;
+        std::thread _thread;
+    };
+
+    Wheel& wheel()
+    {
+        static Wheel instance;
+        return instance;
+    }
+}
+
+Utils::TimerWheel::Handle Utils::TimerWheel::schedule(unsigned int delayMs, unsigned int periodMs, std::function<void()> callback)
+{
+    Wheel& instance = wheel();
+    if (!Wheel::alive().load() || !callback)
+        return 0;
+    return instance.schedule(delayMs, periodMs, std::move(callback));
+}
+
+bool Utils::TimerWheel::cancel(Handle handle, bool wait)
+{
+    if (0 == handle || !Wheel::alive().load())
+        return false;
+    return wheel().cancel(handle, wait);
+}
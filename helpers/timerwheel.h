@@ -0,0 +1,66 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+namespace Utils
+{
+    /**
+     * Timer service for cTimer and TpTimer, one per library.
+     *
+     * Plugins compile the helpers into their own .so, and the wheel is private to that copy, so
+     * each plugin library that uses timers gets its own timer thread; a library with no timers has
+     * none. Sharing one wheel across libraries would leave the others calling into unmapped code
+     * once the plugin that created it is unloaded.
+     *
+     * All timers of a library share one thread and a hierarchical timing wheel: four levels of
+     * 64 slots, 10 ms per slot on the lowest level. Scheduling and cancellation are O(1), expiry
+     * times are rounded up to the next 10 ms tick so timers due close together fire in the same
+     * wakeup, and the thread only wakes up for ticks that have work, never while no timer is set.
+     *
+     * Callbacks run on the timer thread, one at a time, without any lock held.
+     */
+    namespace TimerWheel
+    {
+        typedef uint64_t Handle; // 0 is never a valid handle
+
+        /***
+         * @brief	: Schedules a callback
+         * @param1[in]	: delayMs time until the first call
+         * @param2[in]	: periodMs time between the calls after the first one, 0 for a single shot timer.
+         *                The period starts at the tick in which the previous call returned.
+         * @param3[in]	: callback
+         * @return		: handle of the timer, 0 on failure
+         */
+        Handle schedule(unsigned int delayMs, unsigned int periodMs, std::function<void()> callback);
+
+        /***
+         * @brief	: Cancels a timer. The callback is not called anymore once this returns, except for a
+         *            call that is already running. Safe to call from the callback itself.
+         * @param1[in]	: handle returned by schedule(), 0 is ignored
+         * @param2[in]	: wait for a running call to return, e.g. before the owner of the callback is destroyed.
+         *                Must not be used while holding a lock that the callback takes.
+         * @return		: true if the timer was still pending or running
+         */
+        bool cancel(Handle handle, bool wait = false);
+    }
+}
@@ -25,8 +25,8 @@ namespace WPEFramework
     namespace Plugin
     {    
         TpTimer::TpTimer() :
-                baseTimer(64 * 1024, "ThunderPluginBaseTimer")
-                , m_timerJob(this)
+                m_handle(0)
+        , m_generation(0)
         , m_isActive(false)
         , m_isSingleShot(false)
         , m_intervalInMs(-1)
@@ -34,25 +34,41 @@ namespace WPEFramework
 
         TpTimer::~TpTimer()
         {
-            stop();
+            Utils::TimerWheel::Handle handle;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                handle = m_handle;
+                m_handle = 0;
+                m_generation++;
+                m_isActive = false;
+            }
+            // The callback may be running on the timer thread right now
+            Utils::TimerWheel::cancel(handle, true);
         }
 
         bool TpTimer::isActive()
         {
+            std::lock_guard<std::mutex> lock(m_lock);
             return m_isActive;
         }
 
         void TpTimer::stop()
         {
-            baseTimer.Revoke(m_timerJob);
+            std::lock_guard<std::mutex> lock(m_lock);
+            Utils::TimerWheel::cancel(m_handle);
+            m_handle = 0;
+            m_generation++;
             m_isActive = false;
         }
         
         void TpTimer::start()
         {
-            baseTimer.Revoke(m_timerJob);
-            baseTimer.Schedule(Core::Time::Now().Add(m_intervalInMs), m_timerJob);
-            m_isActive = true;
+            std::lock_guard<std::mutex> lock(m_lock);
+            Utils::TimerWheel::cancel(m_handle);
+            unsigned int generation = ++m_generation;
+            unsigned int interval = m_intervalInMs > 0 ? m_intervalInMs : 0;
+            m_handle = Utils::TimerWheel::schedule(interval, m_isSingleShot ? 0 : interval, [this, generation]() { Timed(generation); });
+            m_isActive = (0 != m_handle);
         }
 
         void TpTimer::start(int msec)
@@ -63,11 +79,13 @@ namespace WPEFramework
         
         void TpTimer::setSingleShot(bool val)
         {
+            std::lock_guard<std::mutex> lock(m_lock);
             m_isSingleShot = val;
         }
         
         void TpTimer::setInterval(int msec)
         {
+            std::lock_guard<std::mutex> lock(m_lock);
             m_intervalInMs = msec;
         }
         
@@ -76,27 +94,22 @@ namespace WPEFramework
             onTimeoutCallback = callback;
         }
 
-        void TpTimer::Timed()
+        void TpTimer::Timed(unsigned int generation)
         {
-            if(onTimeoutCallback != nullptr) {
-                onTimeoutCallback();
-            }
-            
-            if (m_isActive) {
-                if(m_isSingleShot) {
-                    stop();
-                } else{
-                start();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (generation != m_generation) {
+                    return;
+                }
+                // The callback may start the timer again
+                if (m_isSingleShot) {
+                    m_isActive = false;
                 }
             }
-        }
-        
-        uint64_t TpTimerJob::Timed(const uint64_t scheduledTime)
-        {
-            if(m_tptimer) {
-                m_tptimer->Timed();
+
+            if(onTimeoutCallback != nullptr) {
+                onTimeoutCallback();
             }
-            return 0;
         }
     }
 }
@@ -20,39 +20,15 @@
 #ifndef TTIMER_H
 #define TTIMER_H
 
-//#include <core/Timer.h>
 #include <plugins/plugins.h>
+#include <mutex>
+#include "timerwheel.h"
 
 namespace WPEFramework
 {
 
     namespace Plugin
     {
-        class TpTimer;
-        
-        class TpTimerJob
-        {
-        private:
-            TpTimerJob() = delete;
-            TpTimerJob& operator=(const TpTimerJob& RHS) = delete;
-
-        public:
-            TpTimerJob(WPEFramework::Plugin::TpTimer* tpt) : m_tptimer(tpt) { }
-            TpTimerJob(const TpTimerJob& copy) : m_tptimer(copy.m_tptimer) { }
-            ~TpTimerJob() {}
-
-            inline bool operator==(const TpTimerJob& RHS) const
-            {
-                return(m_tptimer == RHS.m_tptimer);
-            }
-
-        public:
-            uint64_t Timed(const uint64_t scheduledTime);
-
-        private:
-            WPEFramework::Plugin::TpTimer* m_tptimer;
-        };
-
         class TpTimer
         {
         public:
@@ -70,17 +46,16 @@ namespace WPEFramework
             
         private:
             
-            void Timed();
+            void Timed(unsigned int generation);
             
-            WPEFramework::Core::TimerType<TpTimerJob> baseTimer;
-            TpTimerJob m_timerJob;
+            std::mutex m_lock;
+            Utils::TimerWheel::Handle m_handle;
+            unsigned int m_generation; // bumped by start()/stop(), so a stale expiry is ignored
             bool m_isActive;
             bool m_isSingleShot;
             int m_intervalInMs;
             
             std::function< void() > onTimeoutCallback;
-            
-            friend class TpTimerJob;
         };
     }
     
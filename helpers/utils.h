@@ -23,6 +23,7 @@
 #include <algorithm>
 #include "tracing/Logging.h"
 #include <syscall.h>
+#include "asynclog.h"
 
 // IARM
 #include "rdk/iarmbus/libIARM.h"
@@ -33,12 +34,25 @@
 #define UNUSED(expr)(void)(expr)
 #define C_STR(x) (x).c_str()
 
-#define LOGINFO(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGWARN(fmt, ...) do { fprintf(stderr, "[%d] WARN [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGERR(fmt, ...) do { fprintf(stderr, "[%d] ERROR [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-
-#define LOGINFOMETHOD() { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() );  }
-#define LOGTRACEMETHODFIN() do { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() );  } while (0)
+// Formatted on the caller's thread and written to stderr by the drain thread, errors are written right away, see asynclog.h.
+// Build with -DUTILS_LOG_LEVEL=0|1 to compile out info/warning messages, -DUTILS_SYNC_LOGGING to write synchronously.
+#define UTILS_LOG(level, tag, fmt, ...) do { if (::Utils::Log::enabled(level)) ::Utils::Log::write(level, "[%d] " tag " [%s:%d] %s: " fmt "\n", ::Utils::Log::threadId(), Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); } while (0)
+
+#if UTILS_LOG_LEVEL >= 2
+#define LOGINFO(fmt, ...) UTILS_LOG(::Utils::Log::LEVEL_INFO, "INFO", fmt, ##__VA_ARGS__)
+#else
+#define LOGINFO(fmt, ...) do { } while (0)
+#endif
+#if UTILS_LOG_LEVEL >= 1
+#define LOGWARN(fmt, ...) UTILS_LOG(::Utils::Log::LEVEL_WARN, "WARN", fmt, ##__VA_ARGS__)
+#else
+#define LOGWARN(fmt, ...) do { } while (0)
+#endif
+#define LOGERR(fmt, ...) UTILS_LOG(::Utils::Log::LEVEL_ERROR, "ERROR", fmt, ##__VA_ARGS__)
+
+// The request/response is only serialized when info messages are enabled
+#define LOGINFOMETHOD() { if (::Utils::Log::enabled(::Utils::Log::LEVEL_INFO)) { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() ); } }
+#define LOGTRACEMETHODFIN() do { if (::Utils::Log::enabled(::Utils::Log::LEVEL_INFO)) { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() ); } } while (0)
 
 #define LOG_DEVICE_EXCEPTION0() LOGWARN("Exception caught: code=%d message=%s", err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION1(param1) LOGWARN("Exception caught" #param1 "=%s code=%d message=%s", param1.c_str(), err.getCode(), err.what());